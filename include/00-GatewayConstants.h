@@ -90,7 +90,7 @@ constexpr int CONNECTED_STATE_BRIGHTNESS_PERCENT = 25;
 /**
  * @brief Current version of the BLE communication protocol.
  */
-constexpr const char* BLE_PROTOCOL_VERSION = "1.1";
+constexpr const char* BLE_PROTOCOL_VERSION = "1.2";
 
 /**
  * @brief Current version of the DGT3000 BLE Gateway application.
@@ -130,6 +130,18 @@ constexpr const char* BLE_EVENT_CHAR_UUID = "73822f6e-edcd-44bb-974b-93ee97cb000
  */
 constexpr const char* BLE_STATUS_CHAR_UUID = "73822f6e-edcd-44bb-974b-93ee97cb0004";
 
+/**
+ * @brief BLE GATT Characteristic UUID for sending binary commands to the gateway.
+ * Opt-in alternative to the JSON command characteristic (see BinaryProtocol).
+ */
+constexpr const char* BLE_BINARY_COMMAND_CHAR_UUID = "73822f6e-edcd-44bb-974b-93ee97cb0005";
+
+/**
+ * @brief BLE GATT Characteristic UUID for receiving binary responses and events.
+ * While a client is subscribed to it, events are sent here instead of on the JSON event characteristic.
+ */
+constexpr const char* BLE_BINARY_EVENT_CHAR_UUID = "73822f6e-edcd-44bb-974b-93ee97cb0006";
+
 // =============================================================================
 // DEVICE AND APPLICATION CONFIGURATION
 // =============================================================================
@@ -150,21 +162,148 @@ constexpr size_t APP_MAX_COMMAND_ID_LENGTH = 32;
  */
 constexpr size_t APP_MAX_ERROR_MESSAGE_LENGTH = 128;
 
+/**
+ * @brief Static-memory build: the FreeRTOS objects (task, queue, mutexes) and the
+ * long-lived gateway objects are created in static storage instead of the heap.
+ * Set with -DGATEWAY_STATIC_ALLOCATION=1 (see the *_static PlatformIO environment).
+ */
+#ifndef GATEWAY_STATIC_ALLOCATION
+#define GATEWAY_STATIC_ALLOCATION 0
+#endif
+
 // =============================================================================
 // QUEUE CONFIGURATION
 // =============================================================================
 
 /**
- * @brief Size of the command queue (BLE -> I2C task).
- * Commands from a BLE client are queued to be processed by the I2C task.
+ * @brief Size of the command response queue (I2C task -> BLE).
+ * Responses to client commands are queued to be sent as BLE notifications.
+ */
+constexpr uint32_t QUEUE_RESPONSE_SIZE = 10;
+
+/**
+ * @brief Size of the clock control command lane (BLE -> I2C task).
+ * Holds time-critical commands (stop, run, setTime...) that the I2C task
+ * always drains before any cosmetic command.
+ */
+constexpr uint32_t QUEUE_CONTROL_COMMAND_SIZE = 6;
+
+/**
+ * @brief Size of the cosmetic display command lane (BLE -> I2C task).
+ * Holds display commands (displayText, endDisplay) that are processed only
+ * when the control lane is empty.
+ */
+constexpr uint32_t QUEUE_DISPLAY_COMMAND_SIZE = 10;
+
+/**
+ * @brief Size of the alert event lane (I2C task -> BLE).
+ * Error and flag fall events. When the lane is full they are held by the I2C
+ * task (see QUEUE_HELD_EVENT_SLOTS) instead of being dropped.
+ */
+constexpr uint32_t QUEUE_ALERT_EVENT_SIZE = 4;
+
+/**
+ * @brief Size of the button event lane (I2C task -> BLE).
+ * Button and gesture events: a press with a long hold gives a buttonEvent, a
+ * longPress, repeats and a release, so the lane holds the bursts of several
+ * presses. When it is full they are held by the I2C task instead of being dropped.
+ */
+constexpr uint32_t QUEUE_BUTTON_EVENT_SIZE = 16;
+
+/**
+ * @brief Number of alert and button events the I2C task holds while their lane
+ * is full, pushed again in order as soon as the main loop makes room. An alert
+ * or button event is only dropped when these are full too, i.e. when no client
+ * has read events for a long time (e.g. while none is connected).
+ */
+constexpr uint32_t QUEUE_HELD_EVENT_SLOTS = 8;
+
+/**
+ * @brief Size of the result event lane (I2C task -> BLE).
+ * Time control, job result and animation end events. A new event is dropped
+ * when the lane is full.
+ */
+constexpr uint32_t QUEUE_RESULT_EVENT_SIZE = 10;
+
+/**
+ * @brief Number of event types of which only the latest event is kept
+ * (connectionStatus, systemStatus, clockSync, timeAnomaly).
+ */
+constexpr uint32_t QUEUE_LATEST_EVENT_SLOTS = 4;
+
+/**
+ * @brief Weight of the alert lane when several event lanes hold events.
+ * With the default weights, out of every 16 notifications 8 go to alerts,
+ * 4 to buttons, 2 to results, 1 to time and 1 to status; an idle lane gives
+ * its share to the others.
+ */
+constexpr uint8_t EVENT_LANE_WEIGHT_ALERT = 8;
+
+/**
+ * @brief Weight of the button lane when several event lanes hold events.
+ */
+constexpr uint8_t EVENT_LANE_WEIGHT_BUTTON = 4;
+
+/**
+ * @brief Weight of the result lane when several event lanes hold events.
+ */
+constexpr uint8_t EVENT_LANE_WEIGHT_RESULT = 2;
+
+/**
+ * @brief Weight of the time lane (clockSync, timeAnomaly) when several event lanes hold events.
+ */
+constexpr uint8_t EVENT_LANE_WEIGHT_TIME = 1;
+
+/**
+ * @brief Weight of the status lane (connectionStatus) when several event lanes hold events.
+ */
+constexpr uint8_t EVENT_LANE_WEIGHT_STATUS = 1;
+
+/**
+ * @brief Precision of the queue residency histograms: each power of two of
+ * microseconds is split into 2^LATENCY_HISTOGRAM_SUB_BUCKET_BITS buckets, so a
+ * percentile is within 25% of the exact value.
+ */
+constexpr uint8_t LATENCY_HISTOGRAM_SUB_BUCKET_BITS = 2;
+
+/**
+ * @brief Alignment of the indexes of the inter-core rings, in bytes (one cache line),
+ * so that the producer and the consumer never write to the same line.
  */
-constexpr uint32_t QUEUE_COMMAND_SIZE = 10;
+constexpr size_t SPSC_RING_ALIGNMENT = 32;
 
 /**
- * @brief Size of the event queue (I2C task -> BLE).
- * Events from the I2C task are queued to be sent as BLE notifications.
+ * @brief Default time-to-live of clock control commands (stop, run, setTime) in milliseconds.
+ * Set to 0 so that clock control is never silently discarded.
  */
-constexpr uint32_t QUEUE_EVENT_SIZE = 20;
+constexpr uint32_t COMMAND_DEFAULT_TTL_CONTROL_MS = 0;
+
+/**
+ * @brief Default time-to-live of display commands (displayText, endDisplay) in milliseconds.
+ * Display updates older than this are obsolete and are not replayed after a stall.
+ */
+constexpr uint32_t COMMAND_DEFAULT_TTL_DISPLAY_MS = 1500;
+
+/**
+ * @brief Default time-to-live of query commands (getTime, getStatus, getQueueStats) in milliseconds.
+ * Matches the typical client response timeout.
+ */
+constexpr uint32_t COMMAND_DEFAULT_TTL_QUERY_MS = 5000;
+
+/**
+ * @brief Shortest retry delay suggested to a client by a BUSY response, in milliseconds.
+ */
+constexpr uint32_t BUSY_RETRY_AFTER_MIN_MS = 20;
+
+/**
+ * @brief Longest retry delay suggested to a client by a BUSY response, in milliseconds.
+ */
+constexpr uint32_t BUSY_RETRY_AFTER_MAX_MS = 1000;
+
+/**
+ * @brief Size of the JSON arena of a BUSY response, built in the BLE callback, in bytes.
+ */
+constexpr size_t BUSY_RESPONSE_ARENA_SIZE = 256;
 
 /**
  * @brief Default timeout for queue operations in milliseconds.
@@ -190,6 +329,27 @@ constexpr size_t JSON_EVENT_BUFFER_SIZE = 256;
  */
 constexpr size_t JSON_STATUS_BUFFER_SIZE = 512;
 
+// =============================================================================
+// RESPONSE CACHE CONFIGURATION
+// =============================================================================
+
+/**
+ * @brief Number of command responses kept for retransmit deduplication.
+ */
+constexpr size_t RESPONSE_CACHE_SIZE = 8;
+
+/**
+ * @brief Maximum size of a cached serialized response in bytes.
+ * Larger responses are not cached.
+ */
+constexpr size_t RESPONSE_CACHE_ENTRY_SIZE = 384;
+
+/**
+ * @brief Window in milliseconds during which a repeated command ID is
+ * answered from the cache instead of being executed again.
+ */
+constexpr uint32_t RESPONSE_CACHE_WINDOW_MS = 10000;
+
 // =============================================================================
 // I2C TASK CONFIGURATION
 // =============================================================================
@@ -224,4 +384,330 @@ constexpr uint32_t I2C_TASK_RECOVERY_DELAY_MS = 1000;
  */
 constexpr uint8_t I2C_TASK_MAX_RECOVERY_ATTEMPTS = 0;
 
+/**
+ * @brief Size of the queue of BLE connection notifications handed to the I2C task.
+ */
+constexpr uint8_t I2C_TASK_DRIVER_QUEUE_SIZE = 4;
+
+/**
+ * @brief Maximum time the restart waits for the I2C task to power the clock off, in milliseconds.
+ */
+constexpr uint32_t I2C_TASK_RELEASE_TIMEOUT_MS = 2000;
+
+// =============================================================================
+// DISPLAY CONFIGURATION
+// =============================================================================
+
+/**
+ * @brief Default minimum interval between two display frames sent to the clock, in milliseconds.
+ * Display updates received in between are collapsed into the next frame.
+ */
+constexpr uint32_t DISPLAY_FLUSH_INTERVAL_MS = 50;
+
+/**
+ * @brief Maximum display flush interval accepted by "configureDisplay", in milliseconds.
+ */
+constexpr uint32_t DISPLAY_FLUSH_INTERVAL_MAX_MS = 1000;
+
+/**
+ * @brief Maximum length of a text scrolled with "displayScroll".
+ */
+constexpr size_t DISPLAY_SCROLL_TEXT_MAX = 64;
+
+/**
+ * @brief Minimum time between two animation frames in milliseconds.
+ */
+constexpr uint16_t DISPLAY_ANIMATION_MIN_STEP_MS = 100;
+
+/**
+ * @brief Maximum number of entries (frames and loop markers) of an animation timeline.
+ */
+constexpr size_t DISPLAY_TIMELINE_MAX_ENTRIES = 48;
+
+/**
+ * @brief Maximum nesting of loops in an animation timeline.
+ */
+constexpr size_t DISPLAY_TIMELINE_MAX_LOOP_DEPTH = 4;
+
+// =============================================================================
+// SCHEDULED COMMAND CONFIGURATION
+// =============================================================================
+
+/**
+ * @brief Maximum number of commands waiting for their "at" timestamp.
+ */
+constexpr size_t SCHEDULER_MAX_PENDING_COMMANDS = 8;
+
+/**
+ * @brief Maximum delay between the reception of a scheduled command and its "at" timestamp, in milliseconds.
+ */
+constexpr uint32_t SCHEDULER_MAX_DELAY_MS = 3600000;
+
+/**
+ * @brief Time before the due time of a scheduled command at which the I2C task
+ * stops sleeping and busy-waits on esp_timer, in microseconds.
+ * Must be larger than the FreeRTOS tick period (1 ms).
+ */
+constexpr int64_t SCHEDULER_SPIN_THRESHOLD_US = 2000;
+
+/**
+ * @brief Time before the spin of a scheduled command within which the I2C task
+ * starts no other I2C work (commands, jobs, display writes, lever moves, recovery),
+ * in microseconds. It covers one acknowledged clock command without retries:
+ * two listen address switches (2 x 10 ms) and the ACK timeout (50 ms).
+ */
+constexpr int64_t SCHEDULER_BUS_GUARD_US = 70000;
+
+/**
+ * @brief Maximum number of periodic jobs registered with the "schedule" command.
+ */
+constexpr size_t SCHEDULER_MAX_JOBS = 4;
+
+/**
+ * @brief Minimum period of a periodic job in milliseconds.
+ */
+constexpr uint32_t SCHEDULER_MIN_PERIOD_MS = 250;
+
+/**
+ * @brief Number of slots of the periodic job timer wheel.
+ */
+constexpr size_t SCHEDULER_WHEEL_SLOTS = 16;
+
+/**
+ * @brief Duration of one timer wheel tick in milliseconds (one I2C task loop).
+ */
+constexpr uint32_t SCHEDULER_WHEEL_TICK_MS = I2C_TASK_UPDATE_INTERVAL_MS;
+
+/**
+ * @brief Maximum size of the encoded (MessagePack) command of a periodic job in bytes.
+ */
+constexpr size_t SCHEDULER_JOB_MAX_ENCODED_SIZE = 160;
+
+// =============================================================================
+// OBJECT POOL CONFIGURATION
+// =============================================================================
+
+/**
+ * @brief Number of pooled raw commands: both command lanes full, every scheduled
+ * command pending, one being processed and one being received.
+ */
+constexpr size_t POOL_RAW_COMMAND_SIZE = QUEUE_CONTROL_COMMAND_SIZE + QUEUE_DISPLAY_COMMAND_SIZE +
+                                         SCHEDULER_MAX_PENDING_COMMANDS + 2;
+
+/**
+ * @brief Number of pooled events: every event lane full, the held events, one being built and one being sent.
+ * A lane can therefore never run out of events because another one is full.
+ */
+constexpr size_t POOL_EVENT_SIZE = QUEUE_ALERT_EVENT_SIZE + QUEUE_BUTTON_EVENT_SIZE + QUEUE_RESULT_EVENT_SIZE +
+                                   QUEUE_LATEST_EVENT_SLOTS + QUEUE_HELD_EVENT_SLOTS + 2;
+
+/**
+ * @brief Number of pooled command responses: the response queue full, one being built and one being sent.
+ */
+constexpr size_t POOL_RESPONSE_SIZE = QUEUE_RESPONSE_SIZE + 2;
+
+/**
+ * @brief Size of the JSON arena of each pooled event in bytes.
+ * Larger event data (e.g. a job result) takes the remainder from the heap.
+ */
+constexpr size_t POOL_EVENT_ARENA_SIZE = 384;
+
+/**
+ * @brief Size of the JSON arena of each pooled command response in bytes.
+ * Larger results (e.g. getQueueStats) take the remainder from the heap.
+ */
+constexpr size_t POOL_RESPONSE_ARENA_SIZE = 768;
+
+/**
+ * @brief Size of the JSON arena of the documents reused for every message
+ * (parsed command parameters, response result, outgoing notification), in bytes.
+ */
+constexpr size_t JSON_WORK_ARENA_SIZE = 2048;
+
+/**
+ * @brief Size of the buffer into which notifications are serialized, in bytes.
+ */
+constexpr size_t BLE_NOTIFICATION_BUFFER_SIZE = 1024;
+
+// =============================================================================
+// BLE LINK CONFIGURATION
+// =============================================================================
+
+/**
+ * @brief Largest ATT MTU accepted by the gateway (the largest allowed by the specification).
+ * The client starts the MTU exchange; the gateway answers with this value.
+ */
+constexpr uint16_t BLE_PREFERRED_MTU = 517;
+
+/**
+ * @brief ATT MTU of a connection until the client exchanges a larger one.
+ */
+constexpr uint16_t BLE_DEFAULT_MTU = 23;
+
+/**
+ * @brief Bytes of each notification taken by the ATT header (opcode and attribute handle).
+ */
+constexpr uint16_t BLE_NOTIFY_HEADER_SIZE = 3;
+
+/**
+ * @brief Largest value of a GATT attribute (ESP_GATT_MAX_ATTR_LEN). Bounds the status characteristic.
+ */
+constexpr size_t BLE_MAX_ATTRIBUTE_LENGTH = 512;
+
+// =============================================================================
+// COMMAND MACRO CONFIGURATION
+// =============================================================================
+
+/**
+ * @brief Maximum number of macros stored at the same time.
+ */
+constexpr size_t MACRO_MAX_COUNT = 16;
+
+/**
+ * @brief Maximum number of commands in one macro.
+ */
+constexpr size_t MACRO_MAX_STEPS = 8;
+
+/**
+ * @brief Maximum size of an encoded (MessagePack) macro in bytes.
+ */
+constexpr size_t MACRO_MAX_ENCODED_SIZE = 384;
+
+/**
+ * @brief NVS namespace used for persistent macros.
+ */
+constexpr const char* MACRO_NVS_NAMESPACE = "macros";
+
+// =============================================================================
+// TIME CONTROL CONFIGURATION
+// =============================================================================
+
+/**
+ * @brief Maximum number of periods of a time control (e.g. 40 moves in 90 min, then 30 min).
+ */
+constexpr size_t TIME_CONTROL_MAX_PERIODS = 3;
+
+/**
+ * @brief Maximum time of one side in seconds (9:59:59, the limit of the DGT3000 display).
+ */
+constexpr uint32_t TIME_CONTROL_MAX_SECONDS = 35999;
+
+/**
+ * @brief Maximum increment or delay per move in seconds.
+ */
+constexpr uint16_t TIME_CONTROL_MAX_INCREMENT_SECONDS = 600;
+
+// =============================================================================
+// MOVE LOG CONFIGURATION
+// =============================================================================
+
+/**
+ * @brief Number of moves (plies) kept in the move log; older moves are overwritten.
+ */
+constexpr size_t MOVE_LOG_CAPACITY = 256;
+
+/**
+ * @brief Size of one move record in the binary format of "getMoveLog" in bytes.
+ */
+constexpr size_t MOVE_LOG_BINARY_RECORD_SIZE = 11;
+
+/**
+ * @brief Maximum number of moves returned by one "getMoveLog" in binary format.
+ */
+constexpr size_t MOVE_LOG_BINARY_CHUNK_RECORDS = 16;
+
+/**
+ * @brief Maximum number of moves returned by one "getMoveLog" in PGN format.
+ */
+constexpr size_t MOVE_LOG_PGN_CHUNK_RECORDS = 8;
+
+// =============================================================================
+// CLOCK MODEL CONFIGURATION
+// =============================================================================
+
+/**
+ * @brief Minimum clock time between two measurements of the clock drift in milliseconds.
+ * Shorter spans are dominated by the arrival jitter of the time messages.
+ */
+constexpr uint32_t CLOCK_MODEL_DRIFT_MIN_SPAN_MS = 10000;
+
+/**
+ * @brief Largest drift accepted as a measurement, in parts per million.
+ */
+constexpr int32_t CLOCK_MODEL_MAX_DRIFT_PPM = 2000;
+
+/**
+ * @brief Minimum interval between two periodic "clockSync" events in milliseconds.
+ */
+constexpr uint32_t CLOCK_SYNC_MIN_INTERVAL_MS = 1000;
+
+/**
+ * @brief Deviation from one second above which the gap between two time messages is irregular, in milliseconds.
+ */
+constexpr uint32_t TIME_ANALYZER_GAP_TOLERANCE_MS = 250;
+
+/**
+ * @brief Minimum clock time, in seconds, before the long-term drift is computed.
+ */
+constexpr uint32_t TIME_ANALYZER_DRIFT_MIN_SPAN_S = 60;
+
+/**
+ * @brief Minimum clock time, in seconds, before an excessive drift is reported.
+ */
+constexpr uint32_t TIME_ANALYZER_DRIFT_ALERT_SPAN_S = 600;
+
+/**
+ * @brief Long-term drift above which a "timeAnomaly" event is sent, in parts per million.
+ */
+constexpr int32_t TIME_ANALYZER_DRIFT_ALERT_PPM = 200;
+
+/**
+ * @brief Minimum interval between two "timeAnomaly" events in milliseconds. Aggregates count all anomalies.
+ */
+constexpr uint32_t TIME_ANALYZER_EVENT_MIN_INTERVAL_MS = 1000;
+
+// =============================================================================
+// BUTTON GESTURE CONFIGURATION
+// =============================================================================
+
+/**
+ * @brief Number of buttons with gesture detection (the main 5 buttons).
+ */
+constexpr uint8_t BUTTON_GESTURE_BUTTON_COUNT = 5;
+
+/**
+ * @brief Number of detected gestures buffered between two I2C task loops.
+ */
+constexpr uint8_t BUTTON_GESTURE_QUEUE_SIZE = 16;
+
+/**
+ * @brief Default hold time before a long press in milliseconds.
+ */
+constexpr uint16_t BUTTON_LONG_PRESS_DEFAULT_MS = 1000;
+
+/**
+ * @brief Default hold time before the first repeat in milliseconds.
+ */
+constexpr uint16_t BUTTON_REPEAT_DELAY_DEFAULT_MS = 800;
+
+/**
+ * @brief Default interval between two repeats in milliseconds.
+ */
+constexpr uint16_t BUTTON_REPEAT_INTERVAL_DEFAULT_MS = 400;
+
+/**
+ * @brief Default maximum time between the two presses of a double press in milliseconds.
+ */
+constexpr uint16_t BUTTON_DOUBLE_PRESS_DEFAULT_MS = 300;
+
+/**
+ * @brief Largest gesture threshold accepted by "configureButtons" in milliseconds.
+ */
+constexpr uint16_t BUTTON_GESTURE_MAX_MS = 10000;
+
+/**
+ * @brief Smallest repeat interval accepted by "configureButtons" in milliseconds.
+ */
+constexpr uint16_t BUTTON_REPEAT_INTERVAL_MIN_MS = 50;
+
 #endif // BLE_GATEWAY_CONSTANTS_H
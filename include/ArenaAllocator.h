@@ -0,0 +1,90 @@
+/*
+ * Arena Allocator for DGT3000 Gateway
+ *
+ * This header defines the fixed-buffer allocator given to the JSON documents
+ * of the message path, so that building and clearing them does not touch
+ * the heap.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ARENA_ALLOCATOR_H
+#define ARENA_ALLOCATOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * @class ArenaAllocator
+ * @brief ArduinoJson allocator serving blocks from a fixed buffer.
+ *
+ * Blocks are taken in order from the buffer; the whole buffer becomes free
+ * again when the last live block is released, which is what a cleared or
+ * destroyed JsonDocument does. The last block grows and shrinks in place, as
+ * ArduinoJson does when it builds a string. When the buffer is full the block
+ * comes from the heap instead, and the fallback is counted.
+ *
+ * An arena serves one document, used by one task at a time.
+ */
+class ArenaAllocator : public ArduinoJson::Allocator {
+public:
+    /**
+     * @param buffer Storage of the arena, aligned on BLOCK_ALIGNMENT.
+     * @param size Size of the storage in bytes.
+     */
+    ArenaAllocator(uint8_t* buffer, size_t size);
+
+    // A copy would share the buffer of another arena.
+    ArenaAllocator(const ArenaAllocator&) = delete;
+    ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+    void* allocate(size_t size) override;
+    void deallocate(void* ptr) override;
+    void* reallocate(void* ptr, size_t newSize) override;
+
+    size_t getUsed() const { return _used; }
+    size_t getPeakUsed() const { return _peakUsed; }
+    size_t getCapacity() const { return _capacity; }
+    uint32_t getHeapFallbackCount() const { return _heapFallbacks; }
+
+    static constexpr size_t BLOCK_ALIGNMENT = 8;
+
+private:
+    struct BlockHeader {
+        uint32_t size;  ///< Usable size of the block, rounded to BLOCK_ALIGNMENT.
+        uint32_t unused;
+    };
+
+    uint8_t* _buffer;
+    size_t _capacity;
+    size_t _used;
+    size_t _peakUsed;
+    uint16_t _liveBlocks;
+    uint32_t _heapFallbacks;
+
+    bool contains(const void* ptr) const;
+    bool isLastBlock(const BlockHeader* header) const;
+    static BlockHeader* headerOf(void* ptr) { return static_cast<BlockHeader*>(ptr) - 1; }
+    static size_t roundUp(size_t size) { return (size + BLOCK_ALIGNMENT - 1) & ~(BLOCK_ALIGNMENT - 1); }
+};
+
+/**
+ * @class StaticArenaAllocator
+ * @brief ArenaAllocator with its storage inline.
+ * @tparam Size Size of the storage in bytes.
+ */
+template <size_t Size>
+class StaticArenaAllocator : public ArenaAllocator {
+public:
+    StaticArenaAllocator() : ArenaAllocator(_storage, Size) {}
+
+private:
+    alignas(ArenaAllocator::BLOCK_ALIGNMENT) uint8_t _storage[Size];
+};
+
+#endif // ARENA_ALLOCATOR_H
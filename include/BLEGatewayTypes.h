@@ -47,6 +47,13 @@ enum class SystemErrorCode : uint16_t {
     
     // Command Execution Errors
     COMMAND_TIMEOUT = 1200,         ///< A command sent to the DGT clock did not receive an ACK in time.
+    COMMAND_EXPIRED = 1201,         ///< A command reached its deadline before it could be executed.
+    MACRO_NOT_DEFINED = 1202,       ///< The invoked macro handle is not defined.
+    MACRO_STORE_FULL = 1203,        ///< No room left to store a new macro.
+    SCHEDULE_FULL = 1204,           ///< Too many commands are waiting for their "at" timestamp.
+
+    // Admission Errors
+    BUSY = 1300,                    ///< The command lane is full; the client should retry after "retryAfterMs".
 
     // General Errors
     UNKNOWN_ERROR = 2000            ///< An unknown or unhandled error occurred.
@@ -75,6 +82,50 @@ enum class ConnectionState : uint8_t {
     ERROR
 };
 
+/**
+ * @enum CommandLane
+ * @brief Defines the priority lanes used to queue commands for the I2C task.
+ * The control lane is always drained before the display lane.
+ */
+enum class CommandLane : uint8_t {
+    CONTROL = 0,    ///< Clock control commands (stop, run, setTime...). Highest priority.
+    DISPLAY         ///< Cosmetic display commands (displayText, endDisplay).
+};
+
+/**
+ * @enum CommandFormat
+ * @brief Defines the protocol a command was received with. Its response is sent back with the same protocol.
+ */
+enum class CommandFormat : uint8_t {
+    JSON = 0,   ///< JSON string on the command characteristic.
+    BINARY      ///< Binary frame on the binary command characteristic (see BinaryProtocol).
+};
+
+/**
+ * @enum EventLane
+ * @brief Defines the lanes used to queue events for the BLE side, one per class
+ * of event. Each lane has its own capacity and drop policy, and the lanes are
+ * served by weight.
+ */
+enum class EventLane : uint8_t {
+    ALERT = 0,  ///< Errors and flag falls. Never dropped for other events.
+    BUTTON,     ///< Button presses and gestures. Never dropped for other events.
+    RESULT,     ///< Time control, job results and animation ends. New events are dropped when full.
+    TIME,       ///< Clock sync and time anomalies. Only the latest event of each type is kept.
+    STATUS,     ///< Connection and system status. Only the latest event of each type is kept.
+    COUNT
+};
+
+/**
+ * @enum EventDropPolicy
+ * @brief What happens to an event when its lane has no room.
+ */
+enum class EventDropPolicy : uint8_t {
+    NEVER = 0,    ///< The lane is sized for bursts; when full, the event is held by the producer and pushed later.
+    DROP_NEWEST,  ///< The new event is dropped.
+    KEEP_LATEST   ///< The new event replaces the pending event of the same type.
+};
+
 // =============================================================================
 // CORE DATA STRUCTURES
 // =============================================================================
@@ -82,13 +133,16 @@ enum class ConnectionState : uint8_t {
 /**
  * @struct RawBLECommand
  * @brief Holds raw JSON data received from a BLE client.
+ * For a binary command, jsonData holds the binary frame instead.
  */
 struct RawBLECommand {
     char jsonData[JSON_COMMAND_BUFFER_SIZE];
     uint32_t timestamp;
     size_t length;
+    CommandLane lane;
+    CommandFormat format;
     
-    RawBLECommand() : timestamp(0), length(0) {
+    RawBLECommand() : timestamp(0), length(0), lane(CommandLane::CONTROL), format(CommandFormat::JSON) {
         jsonData[0] = '\0';
     }
 };
@@ -103,7 +157,14 @@ struct DGTEvent {
         BUTTON_EVENT,
         CONNECTION_STATUS,
         ERROR_EVENT,
-        SYSTEM_STATUS
+        SYSTEM_STATUS,
+        JOB_RESULT,
+        ANIMATION_END,
+        TIME_CONTROL,
+        FLAG_FALL,
+        CLOCK_SYNC,
+        BUTTON_GESTURE,
+        TIME_ANOMALY
     };
     
     Type type;
@@ -113,6 +174,10 @@ struct DGTEvent {
     
     DGTEvent(Type eventType = TIME_UPDATE) : type(eventType), timestamp(millis()), priority(5) {}
     
+    // Pooled events build their data in the arena of their pool slot.
+    DGTEvent(Type eventType, ArduinoJson::Allocator* allocator)
+        : type(eventType), timestamp(millis()), data(allocator), priority(5) {}
+    
     DGTEvent(const DGTEvent& other) {
         type = other.type;
         timestamp = other.timestamp;
@@ -150,6 +215,8 @@ struct SystemStatus {
     uint8_t cpuUsageCore1;
     int16_t temperature;
     uint32_t lastActivityTime;
+    uint32_t responseCacheHits;
+    uint32_t responseCacheMisses;
     
     SystemStatus() {
         systemState = SystemState::UNINITIALIZED;
@@ -166,6 +233,8 @@ struct SystemStatus {
         cpuUsageCore1 = 0;
         temperature = 0;
         lastActivityTime = 0;
+        responseCacheHits = 0;
+        responseCacheMisses = 0;
     }
     
     void updateUptime() { uptime = millis(); }
@@ -199,8 +268,22 @@ struct CommandResponse {
     char errorMessage[APP_MAX_ERROR_MESSAGE_LENGTH];
     uint32_t timestamp;
     uint32_t executionTime;
+    CommandFormat format;
+    
+    CommandResponse(const char* requestId = "")
+        : success(false), errorCode(SystemErrorCode::SUCCESS), timestamp(0), executionTime(0), format(CommandFormat::JSON) {
+        init(requestId);
+    }
+    
+    // Pooled responses build their result in the arena of their pool slot.
+    CommandResponse(const char* requestId, ArduinoJson::Allocator* allocator)
+        : success(false), result(allocator), errorCode(SystemErrorCode::SUCCESS), timestamp(0), executionTime(0),
+          format(CommandFormat::JSON) {
+        init(requestId);
+    }
     
-    CommandResponse(const char* requestId = "") : success(false), errorCode(SystemErrorCode::SUCCESS), timestamp(0), executionTime(0) {
+private:
+    void init(const char* requestId) {
         if (requestId) {
             strncpy(id, requestId, APP_MAX_COMMAND_ID_LENGTH - 1);
             id[APP_MAX_COMMAND_ID_LENGTH - 1] = '\0';
@@ -236,31 +319,24 @@ struct I2CTaskStats {
     uint32_t commandsReceived;
     uint32_t commandsExecuted;
     uint32_t commandsFailed;
+    uint32_t commandsExpired;
+    uint32_t commandsScheduled;
+    uint32_t scheduleLastJitterUs; ///< Delay between the due time and the execution of the last scheduled command.
+    uint32_t scheduleMaxJitterUs;
+    uint32_t timeControlMoves;
+    uint32_t timeControlLastLatencyUs; ///< Time from reading the lever event to the clock being set.
+    uint32_t timeControlMaxLatencyUs;
     uint32_t eventsGenerated;
     uint32_t dgtErrors;
     uint32_t recoveryAttempts;
     uint32_t lastUpdateTime;
     
-    I2CTaskStats() : uptime(0), commandsReceived(0), commandsExecuted(0), commandsFailed(0),
+    I2CTaskStats() : uptime(0), commandsReceived(0), commandsExecuted(0), commandsFailed(0), commandsExpired(0),
+                     commandsScheduled(0), scheduleLastJitterUs(0), scheduleMaxJitterUs(0),
+                     timeControlMoves(0), timeControlLastLatencyUs(0), timeControlMaxLatencyUs(0),
                      eventsGenerated(0), dgtErrors(0), recoveryAttempts(0), lastUpdateTime(0) {}
 };
 
-/**
- * @struct QueueHandles
- * @brief Container for FreeRTOS queue handles.
- */
-struct QueueHandles {
-    QueueHandle_t rawCommandQueue;
-    QueueHandle_t eventQueue;
-    QueueHandle_t responseQueue;
-    
-    QueueHandles() : rawCommandQueue(nullptr), eventQueue(nullptr), responseQueue(nullptr) {}
-    
-    bool isInitialized() const {
-        return (rawCommandQueue != nullptr && eventQueue != nullptr && responseQueue != nullptr);
-    }
-};
-
 /**
  * @struct QueueStats
  * @brief Holds statistics related to queue usage and performance.
@@ -304,4 +380,48 @@ const char* getConnectionStateString(ConnectionState state);
  */
 const char* getEventTypeString(DGTEvent::Type type);
 
+/**
+ * @brief Converts a CommandLane enum to a human-readable string.
+ */
+const char* getCommandLaneString(CommandLane lane);
+
+/**
+ * @brief Converts an EventLane enum to a human-readable string.
+ */
+const char* getEventLaneString(EventLane lane);
+
+/**
+ * @brief Gets the lane an event type is queued in.
+ */
+EventLane getEventLane(DGTEvent::Type type);
+
+/**
+ * @brief Gets the drop policy of an event lane.
+ */
+EventDropPolicy getEventDropPolicy(EventLane lane);
+
+/**
+ * @brief Gets the priority lane for a command name.
+ * Unknown or missing command names are routed to the control lane so that
+ * their error response is not delayed behind display traffic.
+ */
+CommandLane getCommandLane(const char* commandName);
+
+/**
+ * @brief Gets the default time-to-live of a command, used when the client does
+ * not provide a "deadlineMs" field.
+ * @return The TTL in milliseconds, 0 if the command never expires.
+ */
+uint32_t getCommandDefaultTtlMs(const char* commandName);
+
+/**
+ * @brief Determines the priority lane of a raw JSON command without a full parse.
+ * Only the top-level "command" and "id" strings are extracted, by a scan of
+ * the text that uses no JsonDocument and no heap.
+ * @param jsonData The raw JSON command.
+ * @param idOut Optional buffer receiving the command ID (empty if missing).
+ * @param idOutSize Size of the ID buffer.
+ */
+CommandLane classifyRawCommand(const char* jsonData, char* idOut = nullptr, size_t idOutSize = 0);
+
 #endif // BLE_GATEWAY_TYPES_H
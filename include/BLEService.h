@@ -26,8 +26,13 @@
 #include "BLEGatewayTypes.h"
 #include "00-GatewayConstants.h"
 #include "QueueManager.h"
+#include "ResponseCache.h"
+#include "ArenaAllocator.h"
+#include "StaticInstance.h"
+#include "NotificationPacker.h"
 #include <logging.hpp>
 #include <memory>
+#include <atomic>
 #include "BLEServiceCallbacks.h"
 
 /**
@@ -41,7 +46,7 @@
  * - Sending notifications for events (e.g., button presses, time updates).
  * - Processing events and responses from the I2C task via queues.
  */
-class DGT3000BLEService : public esp32m::SimpleLoggable {
+class DGT3000BLEService : public esp32m::SimpleLoggable, public StaticInstance<DGT3000BLEService> {
 public:
     // BLE Components
     BLEServer* bleServer;
@@ -50,28 +55,67 @@ public:
     BLECharacteristic* eventCharacteristic;
     BLECharacteristic* statusCharacteristic;
     BLECharacteristic* protocolVersionCharacteristic;
+    BLECharacteristic* binaryCommandCharacteristic;
+    BLECharacteristic* binaryEventCharacteristic;
     BLEAdvertising* advertising;
     
     // Connection state
     bool deviceConnected;
     uint32_t connectionTime;
     bool _isAdvertising;
+    volatile uint16_t _mtu; ///< ATT MTU negotiated by the client.
     
     // Dependencies
     QueueManager* queueManager;
     SystemStatus* systemStatus;
     
-    // JSON documents for serialization
+    // JSON documents for serialization. The outgoing ones are built in fixed
+    // arenas and serialized into a fixed buffer, so notifying does not use the heap.
+    StaticArenaAllocator<JSON_WORK_ARENA_SIZE> _eventArena;
+    StaticArenaAllocator<JSON_WORK_ARENA_SIZE> _responseArena;
     JsonDocument commandBuffer;
     JsonDocument eventBuffer;
     JsonDocument _responseDoc;
+    char _notificationBuffer[BLE_NOTIFICATION_BUFFER_SIZE];
     
-    // Statistics for notifications
+    // Egress of the event characteristics: messages are packed into MTU-sized notifications.
+    NotificationPacker _jsonPacker;
+    NotificationPacker _binaryPacker;
+    
+    // Set by the subscription callback, handled by processEvents()
+    volatile bool _subscriptionPending;
+    
+    // Set while the client is subscribed to the binary event characteristic:
+    // events are then sent there, in binary, instead of as JSON.
+    volatile bool _binarySubscribed;
+    
+    // Last times notified, to only send the sides that changed
+    struct {
+        TimeSnapshot snapshot;
+        bool valid;
+    } _lastSentTime;
+    
+    // Latest times taken from the mailbox and not notified yet: kept until a
+    // send succeeds, unless a newer value replaces them first
     struct {
-        uint32_t notificationsSent;
-        uint32_t notificationsFailed;
-        uint32_t lastNotificationTime;
+        TimeSnapshot snapshot;
+        bool pending;
+    } _unsentTime;
+    
+    // Responses kept to answer client retransmits (same command ID)
+    ResponseCache responseCache;
+    
+    // Statistics for notifications. Updated by the main loop and by the BLE
+    // host task (BUSY responses, replays), hence atomic; the main loop folds
+    // them into the system status.
+    struct {
+        std::atomic<uint32_t> messagesSent;
+        std::atomic<uint32_t> notificationsFailed;
+        std::atomic<uint32_t> lastNotificationTime;
     } _notificationStats;
+    
+    // Commands refused with a BUSY response, counted by the command callback
+    std::atomic<uint32_t> _busyResponses;
 
     // Callback pointers to manage their lifecycle
     std::unique_ptr<DGT3000ServerCallbacks> _serverCallbacks;
@@ -79,6 +123,8 @@ public:
     std::unique_ptr<DGT3000EventCallbacks> _eventCallbacks;
     std::unique_ptr<DGT3000StatusCallbacks> _statusCallbacks;
     std::unique_ptr<DGT3000EventDescriptorCallbacks> _eventDescriptorCallbacks;
+    std::unique_ptr<DGT3000BinaryCommandCallbacks> _binaryCommandCallbacks;
+    std::unique_ptr<DGT3000BinaryEventDescriptorCallbacks> _binaryEventDescriptorCallbacks;
     
 public:
     /**
@@ -140,11 +186,22 @@ public:
     bool sendEvent(const DGTEvent& event);
     
     /**
-     * @brief Sends a JSON string as a BLE notification on the event characteristic.
+     * @brief Queues a JSON string for the event characteristic. It is packed with the
+     * other messages of the cycle into notifications of up to MTU - 3 bytes.
      * @param jsonData The JSON string to send.
-     * @return true if the notification was sent successfully.
+     * @param flushNow true to send it at once, without waiting for the end of the cycle.
+     * @return true if the message was queued successfully.
      */
-    bool sendNotification(const char* jsonData);
+    bool sendNotification(const char* jsonData, bool flushNow = false);
+    
+    /**
+     * @brief Queues a binary frame for the binary event characteristic, packed like sendNotification().
+     * @param frame The frame to send.
+     * @param length Length of the frame.
+     * @param flushNow true to send it at once, without waiting for the end of the cycle.
+     * @return true if the message was queued successfully.
+     */
+    bool sendBinaryNotification(const uint8_t* frame, size_t length, bool flushNow = false);
     
     /**
      * @brief Updates the general system status information.
@@ -160,8 +217,30 @@ public:
     // --- Public handlers for callbacks ---
     void handleConnect();
     void handleDisconnect();
+    void handleMtuChanged(uint16_t mtu);
     void handleEventRead(BLECharacteristic* characteristic);
     void handleClientSubscription();
+    void handleBinarySubscription(bool subscribed);
+    
+    /**
+     * @brief Checks an incoming command ID against the response cache.
+     * A cached response is notified directly, without queueing the command.
+     * @param id The command ID.
+     * @param format The protocol the command was received with; the cached
+     *        response is replayed with the same protocol.
+     * @return true if the command is a duplicate and must not be queued.
+     */
+    bool handleDuplicateCommand(const char* id, CommandFormat format = CommandFormat::JSON);
+    
+    /**
+     * @brief Refuses a command whose lane is full with a BUSY error response,
+     * carrying a retry hint and the current credits, so the client does not
+     * wait for its timeout. Called from the command callback.
+     * @param id The command ID, may be empty.
+     * @param lane The lane the command was refused from.
+     * @param format The protocol the command was received with.
+     */
+    void sendBusyResponse(const char* id, CommandLane lane, CommandFormat format = CommandFormat::JSON);
     const char* getCachedStatusJson() const { return m_cachedStatusJson.c_str(); }
     
     /**
@@ -170,6 +249,12 @@ public:
     void updateStatusCache();
 
 private:
+    /**
+     * @brief Fills the status document of the status characteristic.
+     * @param withSummary false to keep only the base keys, when the summary would not fit an attribute.
+     */
+    void fillStatus(JsonDocument& statusDoc, bool withSummary);
+
     std::string m_cachedStatusJson; ///< Cached system status JSON string for quick reads.
 
     // Internal setup methods
@@ -183,16 +268,51 @@ private:
      */
     void processNotificationQueue();
     
+    /**
+     * @brief Sends the latest clock times from the time mailbox, if they changed.
+     */
+    void processTimeMailbox();
+    
+    /**
+     * @brief Sends the connection status to a client that has just subscribed to events.
+     */
+    void sendInitialStatus();
+    
     /**
      * @brief Processes the queue of command responses coming from the I2C task.
      */
     void processResponseQueue();
 
+    /**
+     * @brief Sends a response to a binary command on the binary event characteristic.
+     */
+    void sendBinaryResponse(const CommandResponse& response);
+
+    /**
+     * @brief Serializes a notification into the notification buffer.
+     * @param doc The document to serialize.
+     * @param overflow Receives the serialization instead when it does not fit the buffer.
+     * @return The serialized JSON string.
+     */
+    const char* serializeNotification(const JsonDocument& doc, String& overflow);
+
+    /**
+     * @brief Adds the credits (free command slots of each lane) to a response or status document.
+     */
+    void addCredits(JsonDocument& doc) const;
+
     /**
      * @brief Updates internal statistics for notifications.
      * @param success Whether the notification was sent successfully.
      */
     void updateNotificationStats(bool success);
+
+    /**
+     * @brief Copies the notification statistics into the shared system status.
+     * Called from the main loop only, so that the BLE host task never writes
+     * the plain SystemStatus fields.
+     */
+    void foldNotificationStats();
 };
 
 // Global instance of the BLE service
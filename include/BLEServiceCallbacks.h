@@ -18,6 +18,7 @@
 #include <BLEServer.h>
 #include <BLECharacteristic.h>
 #include <BLEDescriptor.h>
+#include "StaticInstance.h"
 
 class DGT3000BLEService; // Forward declaration to avoid circular dependency
 
@@ -37,20 +38,31 @@ public:
  * @class DGT3000ServerCallbacks
  * @brief Handles server-level BLE events like client connection and disconnection.
  */
-class DGT3000ServerCallbacks : public BLEServerCallbacks {
+class DGT3000ServerCallbacks : public BLEServerCallbacks, public StaticInstance<DGT3000ServerCallbacks> {
 private:
     DGT3000BLEService* m_service;
 public:
     explicit DGT3000ServerCallbacks(DGT3000BLEService* service) : m_service(service) {}
     void onConnect(BLEServer* server) override;
     void onDisconnect(BLEServer* server) override;
+    void onMtuChanged(BLEServer* server, esp_ble_gatts_cb_param_t* param) override;
 };
 
 /**
  * @class DGT3000CommandCallbacks
  * @brief Handles write events on the command characteristic.
  */
-class DGT3000CommandCallbacks : public DGT3000BaseCharacteristicCallbacks {
+class DGT3000CommandCallbacks : public DGT3000BaseCharacteristicCallbacks, public StaticInstance<DGT3000CommandCallbacks> {
+public:
+    using DGT3000BaseCharacteristicCallbacks::DGT3000BaseCharacteristicCallbacks;
+    void onWrite(BLECharacteristic* characteristic) override;
+};
+
+/**
+ * @class DGT3000BinaryCommandCallbacks
+ * @brief Handles write events on the binary command characteristic.
+ */
+class DGT3000BinaryCommandCallbacks : public DGT3000BaseCharacteristicCallbacks, public StaticInstance<DGT3000BinaryCommandCallbacks> {
 public:
     using DGT3000BaseCharacteristicCallbacks::DGT3000BaseCharacteristicCallbacks;
     void onWrite(BLECharacteristic* characteristic) override;
@@ -61,7 +73,7 @@ public:
  * @brief Handles read events on the event characteristic.
  * @note Reading this characteristic is not the primary way to get events (notifications are preferred).
  */
-class DGT3000EventCallbacks : public DGT3000BaseCharacteristicCallbacks {
+class DGT3000EventCallbacks : public DGT3000BaseCharacteristicCallbacks, public StaticInstance<DGT3000EventCallbacks> {
 public:
     using DGT3000BaseCharacteristicCallbacks::DGT3000BaseCharacteristicCallbacks;
     void onRead(BLECharacteristic* characteristic) override;
@@ -71,7 +83,7 @@ public:
  * @class DGT3000StatusCallbacks
  * @brief Handles read events on the status characteristic.
  */
-class DGT3000StatusCallbacks : public DGT3000BaseCharacteristicCallbacks {
+class DGT3000StatusCallbacks : public DGT3000BaseCharacteristicCallbacks, public StaticInstance<DGT3000StatusCallbacks> {
 public:
     using DGT3000BaseCharacteristicCallbacks::DGT3000BaseCharacteristicCallbacks;
     void onRead(BLECharacteristic* characteristic) override;
@@ -82,7 +94,7 @@ public:
  * @brief Handles writes to the event characteristic's CCCD (0x2902 descriptor).
  * This is triggered when a client subscribes to or unsubscribes from notifications.
  */
-class DGT3000EventDescriptorCallbacks : public BLEDescriptorCallbacks {
+class DGT3000EventDescriptorCallbacks : public BLEDescriptorCallbacks, public StaticInstance<DGT3000EventDescriptorCallbacks> {
 private:
     DGT3000BLEService* m_service;
 
@@ -91,4 +103,18 @@ public:
     void onWrite(BLEDescriptor* pDescriptor) override;
 };
 
+/**
+ * @class DGT3000BinaryEventDescriptorCallbacks
+ * @brief Handles writes to the binary event characteristic's CCCD (0x2902 descriptor).
+ * Subscribing switches the events to the binary protocol.
+ */
+class DGT3000BinaryEventDescriptorCallbacks : public BLEDescriptorCallbacks, public StaticInstance<DGT3000BinaryEventDescriptorCallbacks> {
+private:
+    DGT3000BLEService* m_service;
+
+public:
+    explicit DGT3000BinaryEventDescriptorCallbacks(DGT3000BLEService* service) : m_service(service) {}
+    void onWrite(BLEDescriptor* pDescriptor) override;
+};
+
 #endif // BLE_SERVICE_CALLBACKS_H
@@ -0,0 +1,161 @@
+/*
+ * Binary Protocol for DGT3000 Gateway
+ *
+ * This header defines the codec of the compact binary protocol offered on
+ * its own characteristic pair, alongside the JSON protocol.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef BINARY_PROTOCOL_H
+#define BINARY_PROTOCOL_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "BLEGatewayTypes.h"
+#include "TimeMailbox.h"
+
+/**
+ * @class BinaryProtocol
+ * @brief Encodes and decodes the frames of the binary protocol.
+ *
+ * A frame starts with a 1-byte opcode followed by packed little-endian fields.
+ * Commands carry a 16-bit ID instead of a string. The frequent commands and
+ * events have a fixed layout; every other command or event goes through a
+ * generic opcode carrying its JSON object encoded as MessagePack.
+ *
+ * Binary commands are decoded into the same document as JSON commands
+ * ({"id", "command", "params"}), so both protocols share the executors.
+ * Inside the gateway the ID of a binary command is the string "#<id>".
+ */
+class BinaryProtocol {
+public:
+    /**
+     * @enum Opcode
+     * @brief First byte of every frame. Commands are below 0x80, responses and events above.
+     */
+    enum Opcode : uint8_t {
+        // Commands: [opcode][id u16] then the fields below
+        CMD_GET_TIME = 0x01,        ///< No field.
+        CMD_GET_STATUS = 0x02,      ///< No field.
+        CMD_STOP = 0x03,            ///< No field.
+        CMD_RUN = 0x04,             ///< [leftMode][rightMode]
+        CMD_SET_TIME = 0x05,        ///< [leftMode][leftH][leftM][leftS][rightMode][rightH][rightM][rightS]
+        CMD_DISPLAY_TEXT = 0x06,    ///< [beep][leftDots][rightDots][text, up to the end of the frame]
+        CMD_END_DISPLAY = 0x07,     ///< No field.
+        CMD_INVOKE = 0x08,          ///< [handle]
+        CMD_GENERIC = 0x7F,         ///< [MessagePack command object, without "id"]
+
+        // Responses: [opcode][id u16][credits][displayCredits] then the fields below
+        RSP_SUCCESS = 0xA0,         ///< [MessagePack result]
+        RSP_ERROR = 0xA1,           ///< [errorCode u16][retryAfterMs u16]
+
+        // Events: [opcode] then the fields below
+        EVT_TIME_UPDATE = 0x81,     ///< [leftH][leftM][leftS][leftMode][rightH][rightM][rightS][rightMode]
+        EVT_BUTTON = 0x82,          ///< [buttonCode][repeatCount], repeatCount 0 for a first press
+        EVT_BUTTON_GESTURE = 0x83,  ///< [buttonCode][gesture][durationMs u16]
+        EVT_CONNECTION_STATUS = 0x84, ///< [flags], bit 0 connected, bit 1 configured
+        EVT_ERROR = 0x85,           ///< [errorCode u16]
+        EVT_FLAG_FALL = 0x86,       ///< [side][source][timestampUs u64]
+        EVT_GENERIC = 0x8F          ///< [type][timestamp u32][MessagePack data]
+    };
+
+    /**
+     * @brief Reads the ID and the lane of a command frame without decoding it.
+     * Called from the BLE callback, like classifyRawCommand() for JSON.
+     * @param frame The command frame.
+     * @param length Length of the frame.
+     * @param idOut Receives the gateway ID of the command ("#<id>"), empty if the frame is too short.
+     * @param idOutSize Size of idOut.
+     * @return The lane of the command, CONTROL if it cannot be classified.
+     */
+    static CommandLane classifyCommand(const uint8_t* frame, size_t length, char* idOut, size_t idOutSize);
+
+    /**
+     * @brief Decodes a command frame into a command document.
+     * @param frame The command frame.
+     * @param length Length of the frame.
+     * @param doc Receives {"id", "command", "params"}, plus "at" and "deadlineMs" for generic commands.
+     * @param errorMessage Receives a static description of the error, if any.
+     * @return SystemErrorCode::SUCCESS or the reason of the failure. "id" is set
+     * whenever the frame is long enough to hold it.
+     */
+    static SystemErrorCode decodeCommand(const uint8_t* frame, size_t length, JsonDocument& doc, const char*& errorMessage);
+
+    /**
+     * @brief Gets the size of the frame of a command response.
+     */
+    static size_t measureResponse(const CommandResponse& response);
+
+    /**
+     * @brief Encodes a command response.
+     * @param response The response of a binary command.
+     * @param controlCredits Free slots of the control lane.
+     * @param displayCredits Free slots of the display lane.
+     * @param buffer Receives the frame.
+     * @param size Size of the buffer, at least measureResponse().
+     * @return The size of the frame, 0 if it does not fit.
+     */
+    static size_t encodeResponse(const CommandResponse& response, uint8_t controlCredits, uint8_t displayCredits,
+                                 uint8_t* buffer, size_t size);
+
+    /**
+     * @brief Encodes an error response without a CommandResponse object (BUSY refusals).
+     * @return The size of the frame, 0 if it does not fit.
+     */
+    static size_t encodeError(const char* id, SystemErrorCode errorCode, uint16_t retryAfterMs,
+                              uint8_t controlCredits, uint8_t displayCredits, uint8_t* buffer, size_t size);
+
+    /**
+     * @brief Encodes a time update with both sides.
+     * @return The size of the frame, 0 if it does not fit.
+     */
+    static size_t encodeTimeUpdate(const TimeSnapshot& snapshot, uint8_t* buffer, size_t size);
+
+    /**
+     * @brief Encodes an event, with its fixed layout if it has one.
+     * @return The size of the frame, 0 if it does not fit.
+     */
+    static size_t encodeEvent(const DGTEvent& event, uint8_t* buffer, size_t size);
+
+    /**
+     * @brief Formats the gateway ID of a binary command.
+     */
+    static void formatCommandId(uint16_t id, char* buffer, size_t size);
+
+    /**
+     * @brief Gets the 16-bit ID back from a gateway ID made by formatCommandId().
+     */
+    static uint16_t parseCommandId(const char* id);
+
+private:
+    static constexpr size_t COMMAND_HEADER_SIZE = 3;
+    static constexpr size_t RESPONSE_HEADER_SIZE = 5;
+    static constexpr uint8_t MSGPACK_MAX_DEPTH = 10; ///< Same nesting limit as ArduinoJson.
+
+    static const char* getCommandName(uint8_t opcode);
+    static size_t writeResponseHeader(uint8_t opcode, const char* id, uint8_t controlCredits, uint8_t displayCredits, uint8_t* buffer);
+    static void writeUint16(uint8_t* buffer, uint16_t value);
+    static void writeUint32(uint8_t* buffer, uint32_t value);
+    static uint16_t readUint16(const uint8_t* buffer);
+    static uint32_t readBigEndian(const uint8_t* buffer, uint8_t size);
+
+    /**
+     * @brief Reads the MessagePack string at p.
+     * @return The byte after the string, nullptr if it is not a complete string.
+     */
+    static const uint8_t* readMsgPackString(const uint8_t* p, const uint8_t* end, const uint8_t*& str, uint32_t& length);
+
+    /**
+     * @brief Skips the MessagePack value at p, nested values included.
+     * @return The byte after the value, nullptr if it is malformed or truncated.
+     */
+    static const uint8_t* skipMsgPack(const uint8_t* p, const uint8_t* end, uint8_t depth);
+};
+
+#endif // BINARY_PROTOCOL_H
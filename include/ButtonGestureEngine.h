@@ -0,0 +1,133 @@
+/*
+ * Button Gesture Engine for DGT3000 Gateway
+ *
+ * This header defines the per-button state machine turning the timestamped
+ * presses and releases of the 5 main DGT3000 buttons into gestures: press,
+ * release, long press, double press and repeat.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef BUTTON_GESTURE_ENGINE_H
+#define BUTTON_GESTURE_ENGINE_H
+
+#include <Arduino.h>
+#include "00-GatewayConstants.h"
+
+/**
+ * @class ButtonGestureEngine
+ * @brief Gesture detection for the 5 main buttons, each with its own state.
+ *
+ * State changes are timestamped when the clock message is received, so
+ * durations do not depend on when the I2C task reads them. Long presses and
+ * repeats are timers scheduled from the press time: the owner calls update()
+ * and wakes up for getTimeUntilNextTimer(), so repeats keep an exact cadence.
+ * Detected gestures are queued and read with nextGesture(). It is not
+ * thread-safe; it is owned by the I2C task.
+ */
+class ButtonGestureEngine {
+public:
+    /**
+     * @enum Gesture
+     * @brief Kind of gesture.
+     */
+    enum class Gesture : uint8_t {
+        PRESS,
+        RELEASE,
+        LONG_PRESS,
+        DOUBLE_PRESS,
+        REPEAT
+    };
+
+    /**
+     * @struct Config
+     * @brief Gesture thresholds in milliseconds. 0 disables the gesture.
+     */
+    struct Config {
+        uint16_t longPressMs;      ///< Hold time before a long press.
+        uint16_t repeatDelayMs;    ///< Hold time before the first repeat.
+        uint16_t repeatIntervalMs; ///< Time between two repeats.
+        uint16_t doublePressMs;    ///< Maximum time between the two presses of a double press.
+    };
+
+    /**
+     * @struct GestureEvent
+     * @brief A detected gesture.
+     */
+    struct GestureEvent {
+        uint8_t button;       ///< Button code (DGT_BUTTON_*).
+        Gesture gesture;
+        uint32_t timestampMs; ///< Time of the gesture (millis() time base).
+        uint32_t durationMs;  ///< Hold time for RELEASE, LONG_PRESS and REPEAT.
+        uint16_t repeatCount; ///< Number of the repeat, starting at 1.
+    };
+
+    ButtonGestureEngine();
+
+    void setConfig(const Config& config) { _config = config; }
+    const Config& getConfig() const { return _config; }
+
+    /**
+     * @brief Forgets the button states, e.g. after the clock was (re)initialized.
+     */
+    void reset();
+
+    /**
+     * @brief Handles a change of the main buttons.
+     * @param state State of the 5 main buttons after the change.
+     * @param timestampMs Time at which the change was received.
+     */
+    void onStateChange(uint8_t state, uint32_t timestampMs);
+
+    /**
+     * @brief Fires the due long-press and repeat timers.
+     * @param now Current time in milliseconds.
+     */
+    void update(uint32_t now);
+
+    /**
+     * @brief Retrieves the next detected gesture.
+     * @return false if no gesture is pending.
+     */
+    bool nextGesture(GestureEvent& event);
+
+    /**
+     * @brief Gets the time until the next timer is due, so the caller can wake up on time.
+     * @return Milliseconds until the next timer, UINT32_MAX if no button is held.
+     */
+    uint32_t getTimeUntilNextTimer(uint32_t now) const;
+
+private:
+    struct ButtonState {
+        bool pressed;
+        uint32_t pressTime;
+        uint32_t lastPressTime;  ///< Previous press, for double-press detection.
+        bool doubleCandidate;    ///< lastPressTime can start a double press.
+        bool longPressPending;
+        uint32_t nextRepeatTime;
+        uint16_t repeatCount;
+    };
+    ButtonState _buttons[BUTTON_GESTURE_BUTTON_COUNT];
+    Config _config;
+
+    GestureEvent _queue[BUTTON_GESTURE_QUEUE_SIZE];
+    uint8_t _queueHead;
+    uint8_t _queueCount;
+
+    void press(uint8_t index, uint32_t timestampMs);
+    void release(uint8_t index, uint32_t timestampMs);
+    void queueGesture(uint8_t index, Gesture gesture, uint32_t timestampMs, uint32_t durationMs, uint16_t repeatCount);
+    bool isRepeatEnabled() const { return _config.repeatDelayMs > 0 && _config.repeatIntervalMs > 0; }
+};
+
+/**
+ * @brief Converts a ButtonGestureEngine::Gesture to a human-readable string.
+ */
+const char* getGestureString(ButtonGestureEngine::Gesture gesture);
+
+#endif // BUTTON_GESTURE_ENGINE_H
@@ -0,0 +1,124 @@
+/*
+ * Clock Model for DGT3000 Gateway
+ *
+ * This header defines the gateway-side model of the DGT3000 timers: the run
+ * mode of each side, anchored on the clock's time messages and extrapolated
+ * with esp_timer and a drift estimate, used to detect the exact flag-fall
+ * instant and to serve millisecond times without I2C traffic.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef CLOCK_MODEL_H
+#define CLOCK_MODEL_H
+
+#include <Arduino.h>
+#include "DGT3000.h"
+#include "TimeControlEngine.h"
+#include "00-GatewayConstants.h"
+
+/**
+ * @class ClockModel
+ * @brief Sub-second model of both timers of the clock.
+ *
+ * The DGT3000 only reports whole seconds, and does not report its run modes.
+ * The model takes the modes and times from the commands the gateway sends
+ * (onClockSet), and re-anchors a running side each time its displayed second
+ * changes (onTimeMessage): at that instant, its remaining time is exactly the
+ * displayed value. The spacing of these changes over at least
+ * CLOCK_MODEL_DRIFT_MIN_SPAN_MS gives the drift of the clock oscillator
+ * against esp_timer, applied when extrapolating. It is not thread-safe; it is
+ * owned by the I2C task.
+ */
+class ClockModel {
+public:
+    ClockModel();
+
+    /**
+     * @brief Forgets the run modes, e.g. after the clock was (re)initialized.
+     */
+    void reset();
+
+    /**
+     * @brief Records times and modes written to the clock.
+     * @param leftMode, rightMode Run modes (DGTRunMode).
+     * @param time The times written: [L_H, L_M, L_S, R_H, R_M, R_S].
+     * @param nowUs esp_timer time of the write.
+     */
+    void onClockSet(uint8_t leftMode, uint8_t rightMode, const uint8_t time[6], int64_t nowUs);
+
+    /**
+     * @brief Records a time message from the clock.
+     * @param time The decoded times: [L_H, L_M, L_S, R_H, R_M, R_S].
+     * @param arrivalUs esp_timer time at which the message was decoded.
+     */
+    void onTimeMessage(const uint8_t time[6], int64_t arrivalUs);
+
+    /**
+     * @brief Gets the modelled remaining (or elapsed, when counting up) time of a side.
+     * @param nowUs esp_timer time.
+     * @return Time in milliseconds.
+     */
+    uint32_t getTimeMs(TimeControlEngine::Side side, int64_t nowUs) const;
+
+    /**
+     * @brief Gets the run mode of a side, DGT_MODE_STOP if unknown.
+     */
+    uint8_t getMode(TimeControlEngine::Side side) const;
+
+    /**
+     * @brief Checks whether getTimeMs() extrapolates, i.e. at least one side is running.
+     */
+    bool isInterpolating() const;
+
+    /**
+     * @brief Gets the estimated drift of the clock in parts per million.
+     * Positive when the clock runs slower than the gateway.
+     */
+    int32_t getDriftPpm() const { return _driftPpm; }
+
+    /**
+     * @brief Checks whether a side counting down has reached zero.
+     * Each flag fall is reported once, until the side is set again.
+     * @param nowUs esp_timer time.
+     * @param side Set to the side whose flag fell.
+     * @param flagUs Set to the esp_timer time at which the side reached zero.
+     * @param fromClock Set to true if the flag fall was first seen in a time message.
+     * @return true if a flag fell.
+     */
+    bool checkFlagFall(int64_t nowUs, TimeControlEngine::Side& side, int64_t& flagUs, bool& fromClock);
+
+    /**
+     * @brief Gets the time until the next flag can fall, so the caller can wake up on time.
+     * @return Microseconds until the earliest flag fall, INT64_MAX if no side counts down.
+     */
+    int64_t getTimeUntilFlagUs(int64_t nowUs) const;
+
+private:
+    struct SideState {
+        uint8_t mode;           ///< DGTRunMode.
+        uint32_t anchorMs;      ///< Time of the side at anchorUs.
+        int64_t anchorUs;
+        uint8_t lastSeconds[3]; ///< Last displayed time [H, M, S].
+        bool flagged;           ///< Flag fall already reported.
+        bool clockFlag;         ///< The clock displayed 0:00:00 while counting down.
+        int64_t clockFlagUs;
+        bool hasDriftRef;       ///< A second change was seen since the side was last set.
+        uint32_t driftRefMs;
+        int64_t driftRefUs;
+    };
+    SideState _sides[2];
+    int32_t _driftPpm;
+
+    static uint8_t index(TimeControlEngine::Side side) { return side == TimeControlEngine::Side::LEFT ? 0 : 1; }
+    static uint32_t toSeconds(const uint8_t hms[3]) { return hms[0] * 3600UL + hms[1] * 60UL + hms[2]; }
+    int64_t getFlagTimeUs(const SideState& state) const;
+    void updateDrift(SideState& state, uint32_t timeMs, int64_t arrivalUs);
+};
+
+#endif // CLOCK_MODEL_H
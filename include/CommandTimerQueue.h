@@ -0,0 +1,81 @@
+/*
+ * Command Timer Queue for DGT3000 Gateway
+ *
+ * This header defines the min-heap holding the commands scheduled with an
+ * "at" timestamp until they are due.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef COMMAND_TIMER_QUEUE_H
+#define COMMAND_TIMER_QUEUE_H
+
+#include <Arduino.h>
+#include "00-GatewayConstants.h"
+
+struct RawBLECommand;
+
+/**
+ * @class CommandTimerQueue
+ * @brief Bounded min-heap of scheduled commands, ordered by due time.
+ *
+ * Commands due at the same time come out in the order they were pushed. The
+ * queue stores the commands and says when the owner (the I2C task) must stop
+ * sleeping; the busy-wait up to the due time is left to the owner. Times are
+ * esp_timer microseconds, passed by the caller. It is not thread-safe.
+ */
+class CommandTimerQueue {
+public:
+    CommandTimerQueue();
+
+    /**
+     * @brief Adds a command.
+     * @param command Pooled raw command, owned by the queue until it is popped.
+     * @param dueTimeUs Time at which the command must run.
+     * @return false if SCHEDULER_MAX_PENDING_COMMANDS commands are already pending.
+     */
+    bool push(RawBLECommand* command, int64_t dueTimeUs);
+
+    /**
+     * @brief Removes the command due first.
+     * @param dueTimeUs Receives its due time.
+     * @return The command, nullptr if the queue is empty. The caller owns it.
+     */
+    RawBLECommand* pop(int64_t& dueTimeUs);
+
+    /**
+     * @brief Checks if the first command is close enough to its due time
+     * (SCHEDULER_SPIN_THRESHOLD_US) to be popped and waited for.
+     */
+    bool isDue(int64_t nowUs) const;
+
+    /**
+     * @brief Gets the time left until the first command is due, minus
+     * SCHEDULER_SPIN_THRESHOLD_US: the longest the owner may sleep.
+     * @return 0 if a command is already due, INT64_MAX if the queue is empty.
+     */
+    int64_t getTimeUntilSpinUs(int64_t nowUs) const;
+
+    uint8_t size() const { return _count; }
+    bool isFull() const { return _count >= SCHEDULER_MAX_PENDING_COMMANDS; }
+
+private:
+    struct Entry {
+        int64_t dueTimeUs;       ///< esp_timer time at which the command must run.
+        uint32_t sequence;       ///< Push order, keeps FIFO order for equal due times.
+        RawBLECommand* command;
+    };
+
+    Entry _entries[SCHEDULER_MAX_PENDING_COMMANDS];
+    uint8_t _count;
+    uint32_t _sequence;
+
+    static bool isBefore(const Entry& a, const Entry& b);
+};
+
+#endif // COMMAND_TIMER_QUEUE_H
@@ -0,0 +1,188 @@
+/*
+ * Display Animator for DGT3000 Gateway
+ *
+ * This header defines the engine that plays display animations (scrolling
+ * text, uploaded frame timelines) locally on the gateway, by writing timed
+ * frames into the display framebuffer.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef DISPLAY_ANIMATOR_H
+#define DISPLAY_ANIMATOR_H
+
+#include <Arduino.h>
+#include "DisplayFramebuffer.h"
+#include "00-GatewayConstants.h"
+
+/**
+ * @class DisplayAnimator
+ * @brief Produces animation frames into a DisplayFramebuffer from the I2C task loop.
+ *
+ * update() is polled from the I2C task loop and never waits: it only writes
+ * the frame that is due, so button and time events keep being handled between
+ * frames. The framebuffer rate limit applies to the frames as to any update.
+ */
+class DisplayAnimator {
+public:
+    /**
+     * @enum Mode
+     * @brief Kind of animation being played.
+     */
+    enum class Mode : uint8_t {
+        NONE = 0,
+        SCROLL,
+        TIMELINE
+    };
+
+    /**
+     * @struct TimelineEntry
+     * @brief One entry of an uploaded timeline: a frame or a loop marker.
+     */
+    struct TimelineEntry {
+        enum class Type : uint8_t {
+            FRAME,
+            LOOP_START,
+            LOOP_END
+        };
+        Type type;
+        char text[DGT3000_DISPLAY_TEXT_MAX + 1];
+        uint8_t leftDots;
+        uint8_t rightDots;
+        uint8_t beep;
+        uint16_t durationMs; ///< Time the frame stays displayed.
+        uint16_t loopCount;  ///< Number of iterations of a LOOP_START, 0 for infinite.
+    };
+
+    DisplayAnimator();
+
+    /**
+     * @brief Starts scrolling a text through the 11-character display.
+     * The text enters on one side and leaves completely on the other side.
+     * @param text The text to scroll, up to DISPLAY_SCROLL_TEXT_MAX characters.
+     * @param stepMs Time between two one-character steps.
+     * @param scrollRight true to move the text to the right, false to the left.
+     * @param repeat Number of passes, 0 to repeat until stopped.
+     * @param leftDots Dots and icons shown on the left side during the animation.
+     * @param rightDots Dots and icons shown on the right side during the animation.
+     * @param now Current time in milliseconds.
+     */
+    void startScroll(const char* text, uint16_t stepMs, bool scrollRight, uint16_t repeat,
+                     uint8_t leftDots, uint8_t rightDots, uint32_t now);
+
+    /**
+     * @brief Discards the uploaded timeline and starts receiving a new one.
+     * Stops the current animation, since its storage is reused.
+     */
+    void beginTimeline();
+
+    /**
+     * @brief Appends a frame to the timeline being uploaded.
+     * @param err Set to an error message on failure.
+     * @return false if the timeline is full.
+     */
+    bool appendFrame(const char* text, uint8_t leftDots, uint8_t rightDots, uint8_t beep,
+                     uint16_t durationMs, const char*& err);
+
+    /**
+     * @brief Opens a loop in the timeline being uploaded.
+     * @param count Number of iterations, 0 to loop until stopped.
+     * @param err Set to an error message on failure.
+     * @return false if the timeline is full or loops are nested too deeply.
+     */
+    bool appendLoopStart(uint16_t count, const char*& err);
+
+    /**
+     * @brief Closes the innermost open loop of the timeline being uploaded.
+     * @param err Set to an error message on failure.
+     * @return false if no loop is open, the loop is empty or the timeline is full.
+     */
+    bool appendLoopEnd(const char*& err);
+
+    /**
+     * @brief Starts playing the uploaded timeline.
+     * @param now Current time in milliseconds.
+     * @param err Set to an error message on failure.
+     * @return false if the timeline has no frame or an unclosed loop.
+     */
+    bool startTimeline(uint32_t now, const char*& err);
+
+    /**
+     * @brief Gets the number of entries of the uploaded timeline.
+     */
+    uint8_t getTimelineLength() const { return _timelineLength; }
+
+    /**
+     * @brief Stops the current animation. The display keeps the last frame.
+     */
+    void stop();
+
+    /**
+     * @brief Writes the due frame, if any, into the framebuffer.
+     * @param now Current time in milliseconds.
+     * @param display The framebuffer to draw into.
+     * @return true if the animation has just completed.
+     */
+    bool update(uint32_t now, DisplayFramebuffer& display);
+
+    bool isActive() const { return _mode != Mode::NONE; }
+    Mode getMode() const { return _mode; }
+
+    /**
+     * @brief Gets the time until the next frame is due, so the caller can wake up on time.
+     * @return Milliseconds until the next frame, UINT32_MAX if no animation is active.
+     */
+    uint32_t getTimeUntilNextFrame(uint32_t now) const;
+
+    /**
+     * @brief Gets the total duration of the current animation, 0 if it repeats forever.
+     */
+    uint32_t getDurationMs() const;
+
+private:
+    Mode _mode;
+    uint32_t _nextFrameTime;
+    uint32_t _durationMs;  ///< Total duration, 0 if infinite.
+    uint16_t _repeat;      ///< Number of passes, 0 for infinite.
+    uint16_t _pass;        ///< Current pass.
+    uint16_t _frame;       ///< Current frame in the pass, or current timeline entry.
+
+    // Scroll
+    char _text[DISPLAY_SCROLL_TEXT_MAX + 1];
+    uint16_t _length;
+    uint16_t _stepMs;
+    bool _scrollRight;
+    uint8_t _leftDots;
+    uint8_t _rightDots;
+
+    // Timeline
+    struct LoopState {
+        uint8_t startIndex;   ///< Entry following the LOOP_START.
+        uint16_t remaining;   ///< Iterations left, 0 for infinite.
+        bool hasFrame;        ///< Upload only: the loop contains at least one frame.
+    };
+    TimelineEntry _timeline[DISPLAY_TIMELINE_MAX_ENTRIES];
+    uint8_t _timelineLength;
+    LoopState _loops[DISPLAY_TIMELINE_MAX_LOOP_DEPTH];
+    uint8_t _loopDepth;      ///< Open loops, during upload or playback.
+    bool _timelineHasFrame;
+
+    uint16_t getScrollFrameCount() const;
+    void drawScrollFrame(DisplayFramebuffer& display) const;
+    bool updateScroll(uint32_t now, DisplayFramebuffer& display);
+    bool updateTimeline(uint32_t now, DisplayFramebuffer& display);
+    void advanceFrameTime(uint32_t now, uint16_t durationMs);
+    uint32_t computeTimelineDuration() const;
+};
+
+/**
+ * @brief Converts a DisplayAnimator::Mode to a human-readable string.
+ */
+const char* getAnimationModeString(DisplayAnimator::Mode mode);
+
+#endif // DISPLAY_ANIMATOR_H
@@ -0,0 +1,118 @@
+/*
+ * Display Framebuffer for DGT3000 Gateway
+ *
+ * This header defines the gateway-side model of the DGT3000 display
+ * (text, dots, beep, overlay), with dirty tracking against what the
+ * clock currently shows and a rate limit for flushing it over I2C.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef DISPLAY_FRAMEBUFFER_H
+#define DISPLAY_FRAMEBUFFER_H
+
+#include <Arduino.h>
+#include "DGT3000.h"
+#include "00-GatewayConstants.h"
+
+/**
+ * @struct DisplayState
+ * @brief Content of the DGT3000 display.
+ */
+struct DisplayState {
+    char text[DGT3000_DISPLAY_TEXT_MAX + 1]; ///< Always padded with spaces to 11 characters.
+    uint8_t leftDots;
+    uint8_t rightDots;
+    bool overlayActive; ///< false when the clock shows its own timers (endDisplay).
+
+    bool operator==(const DisplayState& other) const;
+    bool operator!=(const DisplayState& other) const { return !(*this == other); }
+};
+
+/**
+ * @class DisplayFramebuffer
+ * @brief Desired display state, compared to the state last written to the clock.
+ *
+ * Mutations only update the desired state. The owner (the I2C task) writes it
+ * to the clock when isFlushDue() and reports it with markFlushed(), so that a
+ * burst of updates results in a single I2C display frame. Beeps are one-shot:
+ * a pending beep forces a flush even if the content is unchanged.
+ */
+class DisplayFramebuffer {
+public:
+    DisplayFramebuffer();
+
+    /**
+     * @brief Resets both the desired and the shown state to "no overlay".
+     * Used when the clock has just been (re)initialized.
+     */
+    void reset();
+
+    /**
+     * @brief Replaces the whole text and activates the overlay.
+     * @param text Up to 11 characters; shorter text is padded with spaces.
+     */
+    void setText(const char* text);
+
+    /**
+     * @brief Replaces one character and activates the overlay.
+     * @return false if the position is out of range.
+     */
+    bool setChar(uint8_t position, char c);
+
+    /**
+     * @brief Sets the dots and icons of both sides and activates the overlay.
+     */
+    void setDots(uint8_t leftDots, uint8_t rightDots);
+
+    /**
+     * @brief Requests a beep with the next flush.
+     * @param duration Beep duration in 62.5 ms units.
+     */
+    void beep(uint8_t duration);
+
+    /**
+     * @brief Deactivates the overlay so that the clock shows its timers again.
+     */
+    void clear();
+
+    /**
+     * @brief Checks whether the desired state differs from the clock.
+     */
+    bool isDirty() const;
+
+    /**
+     * @brief Checks whether the display is dirty and the flush interval has elapsed.
+     */
+    bool isFlushDue(uint32_t now) const;
+
+    /**
+     * @brief Records that the desired state has been written to the clock.
+     */
+    void markFlushed(uint32_t now);
+
+    const DisplayState& getState() const { return _desired; }
+    uint8_t getPendingBeep() const { return _pendingBeep; }
+
+    void setFlushInterval(uint32_t intervalMs) { _flushIntervalMs = intervalMs; }
+    uint32_t getFlushInterval() const { return _flushIntervalMs; }
+
+    uint32_t getUpdateCount() const { return _updateCount; }
+    uint32_t getFlushCount() const { return _flushCount; }
+
+private:
+    DisplayState _desired;
+    DisplayState _shown;
+    uint8_t _pendingBeep;
+    uint32_t _flushIntervalMs;
+    uint32_t _lastFlushTime;
+    uint32_t _updateCount; ///< Mutations applied to the model.
+    uint32_t _flushCount;  ///< Display frames actually written to the clock.
+};
+
+#endif // DISPLAY_FRAMEBUFFER_H
@@ -19,9 +19,22 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/semphr.h>
+#include <freertos/queue.h>
 #include "BLEGatewayTypes.h"
 #include "QueueManager.h"
 #include "DGT3000.h"
+#include "MacroStore.h"
+#include "JobScheduler.h"
+#include "CommandTimerQueue.h"
+#include "DisplayFramebuffer.h"
+#include "DisplayAnimator.h"
+#include "TimeControlEngine.h"
+#include "MoveLog.h"
+#include "ClockModel.h"
+#include "ButtonGestureEngine.h"
+#include "TimeFrameAnalyzer.h"
+#include "ArenaAllocator.h"
+#include "StaticInstance.h"
 #include "00-GatewayConstants.h"
 #include <logging.hpp>
 
@@ -36,7 +49,7 @@
  * - Generating events (button presses, time updates) and sending them to the BLE service.
  * - Monitoring the connection status and handling automatic recovery.
  */
-class I2CTaskManager : public esp32m::SimpleLoggable {
+class I2CTaskManager : public esp32m::SimpleLoggable, public StaticInstance<I2CTaskManager> {
 public:
     /**
      * @brief Constructs a new I2CTaskManager.
@@ -108,15 +121,23 @@ public:
     bool isDGT3000Configured() const;
     
     /**
-     * @brief Callback for when a BLE client connects. Triggers DGT3000 initialization.
+     * @brief Callback for when a BLE client connects. Only posts a message to the
+     * I2C task, which owns the driver; returns immediately.
      */
     void onBLEConnected();
     
     /**
-     * @brief Callback for when a BLE client disconnects. Triggers DGT3000 cleanup.
+     * @brief Callback for when a BLE client disconnects. Only posts a message to the
+     * I2C task, which powers the clock off; returns immediately.
      */
     void onBLEDisconnected();
     
+    /**
+     * @brief Checks whether the I2C task has released the DGT3000 after a BLE disconnection.
+     * @return true once the clock is powered off and no longer driven.
+     */
+    bool isDGT3000Released() const { return _dgtReleased; }
+    
     /**
      * @brief Attempts to recover a lost DGT3000 connection.
      * @return true if recovery was successful, false otherwise.
@@ -168,7 +189,19 @@ private:
     I2CTaskState _taskState; ///< Current state of the I2C task.
     ConnectionState _dgtConnectionState; ///< Connection state of the DGT3000.
     bool _dgtConfigured; ///< Flag indicating if the DGT3000 is configured.
-    bool _bleConnected; ///< Flag indicating if a BLE client is connected.
+    bool _bleConnected; ///< Flag indicating if a BLE client is connected (written by the I2C task only).
+    
+    // Driver Ownership
+    /**
+     * @enum DriverMessage
+     * @brief Notifications from other tasks, handled by the I2C task that owns the driver.
+     */
+    enum class DriverMessage : uint8_t {
+        BLE_CONNECTED,
+        BLE_DISCONNECTED
+    };
+    QueueHandle_t _driverQueue;   ///< DriverMessage queue, filled by the BLE callbacks (core 1).
+    volatile bool _dgtReleased;   ///< Set by the I2C task once the clock is powered off for the restart.
     
     // Timing and Recovery
     uint32_t _lastUpdateTime; ///< Timestamp of the last task loop.
@@ -188,40 +221,106 @@ private:
     } _timeMonitoring;
     
     // Button Monitoring
-    struct {
-        uint8_t lastButtonState;
-        uint32_t lastButtonTime;
-        uint32_t buttonRepeatCount;
-        bool buttonRepeatActive;
-    } _buttonMonitoring;
+    ButtonGestureEngine _buttonGestures; ///< Repeat, long-press and double-press detection of the main buttons.
     
     // Synchronization
     SemaphoreHandle_t _stateMutex; ///< Mutex for thread-safe state access.
     bool _initializingDGT; ///< Flag to prevent concurrent initialization attempts.
     int _lastDGTUpdateResult; ///< Stores the result of the last DGT3000 operation.
 
-    // Reusable JSON documents to reduce stack allocation
+#if GATEWAY_STATIC_ALLOCATION
+    // Storage of the FreeRTOS objects, reserved with this instance instead of taken from the heap.
+    StackType_t _taskStack[I2C_TASK_STACK_SIZE];
+    StaticTask_t _taskBuffer;
+    StaticSemaphore_t _stateMutexBuffer;
+    StaticQueue_t _driverQueueBuffer;
+    uint8_t _driverQueueStorage[I2C_TASK_DRIVER_QUEUE_SIZE * sizeof(DriverMessage)];
+#endif
+
+    // Reusable JSON documents to reduce stack allocation, built in fixed arenas
+    // so that parsing a command and building its response do not use the heap.
+    StaticArenaAllocator<JSON_WORK_ARENA_SIZE> _commandParamsArena;
+    StaticArenaAllocator<JSON_WORK_ARENA_SIZE> _responseResultArena;
     JsonDocument _commandParamsDoc;
     JsonDocument _responseResultDoc;
+    CommandFormat _commandFormat; ///< Protocol of the parsed command; its responses use the same one.
+    
+    // Command Macros
+    MacroStore _macroStore; ///< Client-registered command macros.
+    JsonDocument _macroStepsDoc; ///< Decoded steps of the macro being invoked.
+    JsonDocument _macroResultDoc; ///< Result of the last macro step.
+    
+    // While a macro runs, step responses are captured instead of being sent,
+    // so that the client receives a single response per invoke.
+    struct {
+        bool active;
+        bool success;
+        SystemErrorCode errorCode;
+        char errorMessage[APP_MAX_ERROR_MESSAGE_LENGTH];
+    } _macroCapture;
+    
+    // Scheduled Commands ("at" field): raw commands, parsed again when due
+    CommandTimerQueue _scheduledCommands;
+    
+    // Display Model
+    DisplayFramebuffer _display; ///< Desired display content, flushed by the I2C task.
+    DisplayAnimator _animator; ///< Local display animations (scrolling text, timelines).
+    uint8_t _animationNextChunk; ///< Next expected playAnimation chunk, 0 when no upload is in progress.
+    
+    // Periodic Jobs ("schedule" command)
+    JobScheduler _jobScheduler; ///< Timer wheel of recurring jobs.
+    
+    // Time Control ("configureTimeControl" command)
+    TimeControlEngine _timeControl; ///< Applies increments and delays on lever moves.
+    bool _leverInverted;            ///< Swaps the lever sides (lever position inverted at clock power-on).
+    MoveLog _moveLog;               ///< Clock data of the last moves, captured at lever events.
+    ClockModel _clockModel;         ///< Sub-second model of the timers (flag fall, getTime, clockSync).
+    uint32_t _clockSyncIntervalMs;  ///< Period of the clockSync events, 0 if disabled.
+    uint32_t _lastClockSyncTime;
+    bool _timeUpdatesEnabled;       ///< false to replace timeUpdate events by clockSync events.
+    TimeFrameAnalyzer _timeAnalyzer; ///< Lost or duplicated seconds, gaps and drift of the time messages.
+    uint32_t _lastTimeAnomalyEventTime;
     
     // Task Implementation
     static void taskFunction(void* parameter);
     void runTask();
     
     // Core Task Operations
+    void processDriverMessages();
     void processCommand();
+    void processScheduledCommands();
+    void processJobs();
+    void runJob(JobScheduler::Job& job);
     void handleEvents();
     void monitorConnection();
     
     // Command Processing
+    bool parseCommand(const RawBLECommand& rawCmd, const char*& id, const char*& commandName);
+    void dispatchCommand(const char* id, const char* commandName);
     bool executeCommand(const char* id, const char* commandName, const JsonObjectConst& params);
     bool executeSetTime(const char* id, const JsonObjectConst& params);
     bool executeDisplayText(const char* id, const JsonObjectConst& params);
     bool executeEndDisplay(const char* id);
+    bool executeUpdateDisplay(const char* id, const JsonObjectConst& params);
+    bool executeConfigureDisplay(const char* id, const JsonObjectConst& params);
+    bool executeDisplayScroll(const char* id, const JsonObjectConst& params);
+    bool executePlayAnimation(const char* id, const JsonObjectConst& params);
+    bool sendDisplayResponse(const char* id, const char* successStatus, const char* errorMessage);
     bool executeStop(const char* id);
     bool executeRun(const char* id, const JsonObjectConst& params);
     bool executeGetTime(const char* id);
     bool executeGetStatus(const char* id);
+    bool executeGetQueueStats(const char* id);
+    bool executeDefineMacro(const char* id, const JsonObjectConst& params);
+    bool executeInvoke(const char* id, const JsonObjectConst& params);
+    bool executeSchedule(const char* id, const JsonObjectConst& params);
+    bool executeUnschedule(const char* id, const JsonObjectConst& params);
+    bool executeConfigureTimeControl(const char* id, const JsonObjectConst& params);
+    bool executeGetMoveLog(const char* id, const JsonObjectConst& params);
+    bool executeClearMoveLog(const char* id);
+    bool executeConfigureClockSync(const char* id, const JsonObjectConst& params);
+    bool executeConfigureButtons(const char* id, const JsonObjectConst& params);
+    uint8_t runMacroSteps(const char* id, const JsonObjectConst& overrides);
     
     // Response Handling
     void sendCommandResponse(const char* id, bool success, const JsonObjectConst& result);
@@ -229,15 +328,40 @@ private:
     
     // Event Generation
     void generateButtonEvent();
-    void handleButtonRepeat();
+    void handleButtonGestures();
+    void generateButtonGestureEvent(const ButtonGestureEngine::GestureEvent& gesture);
     void generateTimeEvent(const uint8_t time[6]);
     void generateConnectionStatusEvent(bool connected, bool configured);
     void generateErrorEvent(SystemErrorCode errorCode, const char* message);
+    void generateAnimationEndEvent(DisplayAnimator::Mode mode, const char* reason);
+    void generateTimeControlEvent(TimeControlEngine::Side movedSide, const TimeControlEngine::ClockSetting& setting);
+    void generateFlagFallEvent(TimeControlEngine::Side side, int64_t flagUs, bool fromClock);
+    void generateClockSyncEvent();
+    void generateTimeAnomalyEvent(const TimeFrameAnalyzer::Report& report);
+    
+    // Display Management
+    bool flushDisplay(bool force);
+    void serviceDisplay();
+    void stopAnimation(const char* reason);
+    
+    // Time Control
+    void handleLeverMove(uint8_t leverEvent);
+    void serviceTimeControl();
+    bool applyClockSetting(const TimeControlEngine::ClockSetting& setting);
+    void recordClockSet(uint8_t leftMode, uint8_t rightMode);
+    void checkFlagFall();
+    void serviceClockSync();
     
     // DGT3000 Management
     bool configureDGT3000();
     void handleDGT3000Error(int error);
     
+    // Scheduling Helpers
+    bool scheduleCommand(RawCommandPtr rawCmd, const char* id, uint32_t atMs);
+    uint32_t getSleepTimeMs(uint32_t elapsedMs) const;
+    bool isBusReserved() const;
+    void clearScheduledCommands();
+    
     // State Management Helpers
     void setState(I2CTaskState newState);
     void updateConnectionState();
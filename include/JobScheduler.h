@@ -0,0 +1,103 @@
+/*
+ * Periodic Job Scheduler for DGT3000 Gateway
+ *
+ * This header defines the table of recurring gateway-side jobs registered
+ * with the "schedule" command, and the timer wheel that triggers them.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef JOB_SCHEDULER_H
+#define JOB_SCHEDULER_H
+
+#include <Arduino.h>
+#include "00-GatewayConstants.h"
+#include <logging.hpp>
+
+/**
+ * @class JobScheduler
+ * @brief Hashed timer wheel of periodic jobs.
+ *
+ * Each job is linked in the wheel slot of its next run tick. Advancing the
+ * wheel only visits the slots of the elapsed ticks, whatever the number of jobs.
+ * The scheduler only stores and triggers jobs; running them is up to the owner
+ * (the I2C task). It is not thread-safe.
+ */
+class JobScheduler : public esp32m::SimpleLoggable {
+public:
+    /**
+     * @struct Job
+     * @brief A periodic job: either a macro handle or an encoded single command.
+     */
+    struct Job {
+        bool used;
+        uint8_t id;
+        int16_t macroHandle;       ///< Macro to invoke, -1 if the job runs its own command.
+        uint32_t periodTicks;
+        uint32_t remainingRuns;    ///< 0 for unlimited.
+        uint32_t nextRunTick;
+        uint32_t lastResultHash;   ///< Hash of the last reported result, for change detection.
+        bool hasResult;
+        uint16_t size;
+        uint8_t data[SCHEDULER_JOB_MAX_ENCODED_SIZE]; ///< MessagePack array with one command.
+        int8_t nextInSlot;         ///< Next job index in the same wheel slot, -1 if last.
+    };
+
+    JobScheduler();
+
+    /**
+     * @brief Registers a job.
+     * @param periodMs Period in milliseconds.
+     * @param runCount Number of runs, 0 for unlimited.
+     * @param macroHandle Macro to invoke, -1 to run the encoded command instead.
+     * @param data Encoded command (MessagePack array of one step), ignored for macros.
+     * @param size Size of the encoded command.
+     * @return The job ID, or -1 if the job table is full or the command too large.
+     */
+    int add(uint32_t periodMs, uint32_t runCount, int16_t macroHandle, const uint8_t* data, size_t size);
+
+    /**
+     * @brief Removes a job.
+     * @return true if the job existed.
+     */
+    bool remove(uint8_t jobId);
+
+    /**
+     * @brief Removes all jobs.
+     */
+    void clear();
+
+    /**
+     * @brief Advances the wheel to the current time and returns the next due job.
+     * The job is unlinked from the wheel; the caller must call reschedule() after running it.
+     * @return A due job, or nullptr if none is due.
+     */
+    Job* nextDue();
+
+    /**
+     * @brief Re-arms a job after it ran, or removes it when its run count is reached.
+     */
+    void reschedule(Job* job);
+
+    /**
+     * @brief Gets the number of registered jobs.
+     */
+    uint8_t count() const;
+
+private:
+    Job _jobs[SCHEDULER_MAX_JOBS];
+    int8_t _slots[SCHEDULER_WHEEL_SLOTS]; ///< Head job index of each slot, -1 if empty.
+    uint32_t _currentTick;                ///< Next tick to be processed.
+    uint8_t _nextJobId;
+
+    uint32_t getNowTick() const;
+    void link(int8_t index);
+    void unlink(int8_t index);
+};
+
+#endif // JOB_SCHEDULER_H
@@ -0,0 +1,69 @@
+/*
+ * Latency Histogram for DGT3000 Gateway
+ *
+ * This header defines the fixed-size histogram used to measure how long
+ * messages wait in the inter-task queues.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "00-GatewayConstants.h"
+
+/**
+ * @class LatencyHistogram
+ * @brief Log-linear histogram of durations in microseconds.
+ *
+ * Each power of two is split into a few linear buckets, so the whole 32-bit
+ * range fits in a fixed table and percentiles keep the same relative precision
+ * from microseconds to seconds. Recording is one atomic increment: one task
+ * records, any other task can read the percentiles while it does.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    /**
+     * @brief Adds a sample. Called by a single task.
+     * @param valueUs Duration in microseconds.
+     */
+    void record(uint32_t valueUs);
+
+    /**
+     * @brief Clears all samples.
+     */
+    void reset();
+
+    uint32_t getCount() const { return _count.load(std::memory_order_relaxed); }
+    uint32_t getMax() const { return _max.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets a percentile of the recorded samples.
+     * @param percent Percentile, 1 to 100.
+     * @return The upper bound of the bucket holding the percentile, capped at
+     * the largest sample; 0 if there is no sample.
+     */
+    uint32_t getPercentile(uint8_t percent) const;
+
+private:
+    static constexpr uint32_t SUB_BUCKETS = 1UL << LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS * (33 - LATENCY_HISTOGRAM_SUB_BUCKET_BITS);
+
+    std::atomic<uint32_t> _buckets[BUCKET_COUNT];
+    std::atomic<uint32_t> _count;
+    std::atomic<uint32_t> _max;
+
+    static size_t bucketOf(uint32_t valueUs);
+    static uint32_t bucketUpperBound(size_t index);
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -18,6 +18,7 @@
 #include <Adafruit_NeoPixel.h>
 #include <logging.hpp>
 #include "00-GatewayConstants.h"
+#include "StaticInstance.h"
 
 /**
  * @enum LedState
@@ -35,7 +36,7 @@ enum LedState {
  * @class LedManager
  * @brief Manages the behavior of the status LEDs (NeoPixel and/or simple LED).
  */
-class LedManager : public esp32m::SimpleLoggable {
+class LedManager : public esp32m::SimpleLoggable, public StaticInstance<LedManager> {
 public:
     /**
      * @brief Constructs a new LedManager.
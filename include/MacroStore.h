@@ -0,0 +1,99 @@
+/*
+ * Command Macro Store for DGT3000 Gateway
+ *
+ * This header defines the store of client-registered command macros:
+ * short command sequences kept pre-validated and pre-encoded on the
+ * gateway, and replayed by a 1-byte handle.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef MACRO_STORE_H
+#define MACRO_STORE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "BLEGatewayTypes.h"
+#include "00-GatewayConstants.h"
+#include <logging.hpp>
+
+/**
+ * @class MacroStore
+ * @brief Stores command macros encoded as MessagePack, optionally persisted in NVS.
+ *
+ * A macro is an array of steps, each step being a command object
+ * ({"command": ..., "params": {...}}) as accepted on the command characteristic.
+ * The store is owned and accessed by the I2C task only; it is not thread-safe.
+ */
+class MacroStore : public esp32m::SimpleLoggable {
+public:
+    MacroStore();
+
+    /**
+     * @brief Loads the persistent macros from NVS.
+     */
+    void begin();
+
+    /**
+     * @brief Validates, encodes and stores a macro, replacing any macro with the same handle.
+     * @param handle The macro handle.
+     * @param steps The array of command objects.
+     * @param persist true to also save the macro in NVS.
+     * @param errorMessage Receives a static description of the error, if any.
+     * @return SystemErrorCode::SUCCESS or the reason of the failure.
+     */
+    SystemErrorCode define(uint8_t handle, JsonArrayConst steps, bool persist, const char*& errorMessage);
+
+    /**
+     * @brief Decodes a macro into a JSON document (array of steps).
+     * @param handle The macro handle.
+     * @param doc The document receiving the steps.
+     * @return true if the macro exists and was decoded, false otherwise.
+     */
+    bool load(uint8_t handle, JsonDocument& doc);
+
+    /**
+     * @brief Checks whether a macro is defined.
+     */
+    bool exists(uint8_t handle);
+
+    /**
+     * @brief Gets the number of defined macros.
+     */
+    uint8_t count() const;
+
+    /**
+     * @brief Checks that a command object can be stored for later execution
+     * (known command, valid parameters, no macro command).
+     * @param step The command object ({"command": ..., "params": {...}}).
+     * @param errorMessage Receives a static description of the error, if any.
+     * @return true if the command is valid.
+     */
+    bool validateStep(JsonObjectConst step, const char*& errorMessage) const;
+
+private:
+    struct Macro {
+        bool used;
+        bool persistent;
+        uint8_t handle;
+        uint16_t size;
+        uint8_t data[MACRO_MAX_ENCODED_SIZE];
+    };
+
+    Macro _macros[MACRO_MAX_COUNT];
+
+    Macro* find(uint8_t handle);
+    Macro* allocate();
+
+    // NVS persistence
+    void saveToNVS(const Macro& macro);
+    void removeFromNVS(uint8_t handle);
+    void writeNVSIndex();
+};
+
+#endif // MACRO_STORE_H
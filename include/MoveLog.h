@@ -0,0 +1,83 @@
+/*
+ * Move Log for DGT3000 Gateway
+ *
+ * This header defines the in-RAM ring of per-move clock records captured
+ * at lever events, downloaded by the client with "getMoveLog".
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef MOVE_LOG_H
+#define MOVE_LOG_H
+
+#include <Arduino.h>
+#include "TimeControlEngine.h"
+#include "00-GatewayConstants.h"
+
+/**
+ * @struct MoveRecord
+ * @brief Clock data of one move (ply).
+ */
+struct MoveRecord {
+    uint32_t timestampMs;      ///< Gateway time of the lever move ending the move.
+    uint32_t durationMs;       ///< Time between the lever move starting the move and the one ending it.
+    uint16_t remainingSeconds; ///< Time left to the player after the move, bonus included.
+    TimeControlEngine::Side side;
+};
+
+/**
+ * @class MoveLog
+ * @brief Ring of the last MOVE_LOG_CAPACITY moves, indexed by ply from the start of the game.
+ *
+ * The first lever move of a game only starts the timing; each following lever
+ * move by the other side records the move it ends. A second press by the same
+ * side is ignored. The log is not thread-safe; it is owned by the I2C task.
+ */
+class MoveLog {
+public:
+    MoveLog();
+
+    /**
+     * @brief Clears the log for a new game.
+     */
+    void clear();
+
+    /**
+     * @brief Handles a lever move.
+     * @param side Side whose player pressed the lever.
+     * @param remainingSeconds Time left to that player after the move.
+     * @param now Gateway time of the lever move in milliseconds.
+     * @return true if a move was recorded.
+     */
+    bool onLever(TimeControlEngine::Side side, uint32_t remainingSeconds, uint32_t now);
+
+    /**
+     * @brief Gets a record.
+     * @param ply Index of the move from the start of the game.
+     * @return false if the move has not been played or was overwritten.
+     */
+    bool get(uint32_t ply, MoveRecord& record) const;
+
+    /**
+     * @brief Gets the number of moves recorded since the start of the game.
+     */
+    uint32_t getTotal() const { return _total; }
+
+    /**
+     * @brief Gets the index of the oldest move still in the ring.
+     */
+    uint32_t getFirstAvailable() const;
+
+private:
+    MoveRecord _records[MOVE_LOG_CAPACITY];
+    uint32_t _total;
+    TimeControlEngine::Side _lastSide; ///< Side of the last lever move, NONE before the game starts.
+    uint32_t _lastLeverTime;
+};
+
+#endif // MOVE_LOG_H
@@ -0,0 +1,142 @@
+/*
+ * Notification Packer for DGT3000 Gateway
+ *
+ * This header defines the egress stage of a notify characteristic: messages
+ * are framed and packed into notifications as large as the negotiated MTU.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef NOTIFICATION_PACKER_H
+#define NOTIFICATION_PACKER_H
+
+#include <Arduino.h>
+#include <BLECharacteristic.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
+#include "00-GatewayConstants.h"
+#include <logging.hpp>
+
+/**
+ * @class NotificationPacker
+ * @brief Packs framed messages into notifications of up to MTU - 3 bytes.
+ *
+ * The notifications of a characteristic form a byte stream: a message that
+ * does not fit the room left in the current notification starts the next one,
+ * and a message larger than a notification continues over the following ones,
+ * so nothing is truncated. Messages are queued during a processing cycle and
+ * the last partial notification is sent by flush().
+ *
+ * Both the main loop and the BLE host task (BUSY responses, replays) send
+ * messages, so the packer is protected by a mutex: a message is always
+ * written whole, never interleaved with another one.
+ *
+ * The packer is the callbacks object of its characteristic, so it learns the
+ * outcome of every notify(). When one fails, the messages it carried are
+ * counted as lost, the rest of the message being written is discarded, and
+ * the stream restarts on a message boundary: the next notification begins
+ * with '\n' (NDJSON) or has the start flag of its header set (length-prefixed).
+ */
+class NotificationPacker : public esp32m::SimpleLoggable, public BLECharacteristicCallbacks {
+public:
+    /**
+     * @enum Framing
+     * @brief How messages are delimited in the stream.
+     */
+    enum Framing : uint8_t {
+        NEWLINE_DELIMITED = 0, ///< Each message is followed by '\n' (NDJSON).
+        LENGTH_PREFIXED        ///< Each notification starts with a header byte, each message is preceded by its length (uint16, little-endian).
+    };
+
+    static constexpr uint8_t HEADER_START_FLAG = 0x80;   ///< Length-prefixed header: the payload starts with a message.
+    static constexpr uint8_t HEADER_SEQUENCE_MASK = 0x7F; ///< Length-prefixed header: notification sequence number.
+
+    NotificationPacker(const char* name, Framing framing);
+    ~NotificationPacker();
+
+    /**
+     * @brief Creates the mutex and attaches the characteristic to notify.
+     * The packer becomes the callbacks object of the characteristic.
+     * @return true on success, false otherwise.
+     */
+    bool initialize(BLECharacteristic* characteristic);
+
+    /**
+     * @brief Sets the ATT MTU of the connection. Called on connection and on MTU exchange.
+     */
+    void setMtu(uint16_t mtu);
+
+    /**
+     * @brief Queues a message, sending every notification it fills.
+     * @param message The message, without framing.
+     * @param length Length of the message.
+     * @param flushNow true to also send the last partial notification at once.
+     * @return true if the message was queued, false if the packer is busy or not initialized.
+     * A queued message that a failed notification then loses is counted by getLostMessageCount().
+     */
+    bool send(const uint8_t* message, size_t length, bool flushNow = false);
+
+    /**
+     * @brief Sends the partial notification, if any.
+     */
+    void flush();
+
+    /**
+     * @brief Drops the partial notification, e.g. when the client disconnects.
+     */
+    void reset();
+
+    /**
+     * @brief Records the outcome of the notify() in progress.
+     * Called by the BLE stack from within notify(), on the sending task.
+     */
+    void onStatus(BLECharacteristic* characteristic, Status status, uint32_t code) override;
+
+    uint16_t getPayloadSize() const { return _payloadSize.load(std::memory_order_relaxed); }
+    uint32_t getNotificationCount() const { return _notifications; }
+    uint32_t getMessageCount() const { return _messages; }
+    uint32_t getFailedNotificationCount() const { return _failedNotifications.load(std::memory_order_relaxed); }
+    uint32_t getLostMessageCount() const { return _lostMessages.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief Appends data to the stream, sending every notification it fills.
+     * @param messageStart true if data is the first part of a message.
+     * @return false if a notification failed: the rest of the message must be discarded.
+     */
+    bool write(const uint8_t* data, size_t length, size_t payloadSize, bool messageStart);
+    void beginPacket(bool messageStart);
+
+    /**
+     * @brief Notifies the packet and empties it.
+     * @return false if the notification failed; the stream then restarts on a message boundary.
+     */
+    bool notifyPacket();
+
+    const Framing _framing;
+    BLECharacteristic* _characteristic;
+    SemaphoreHandle_t _mutex;
+#if GATEWAY_STATIC_ALLOCATION
+    StaticSemaphore_t _mutexBuffer;
+#endif
+    std::atomic<uint16_t> _payloadSize;
+    uint8_t _packet[BLE_PREFERRED_MTU - BLE_NOTIFY_HEADER_SIZE];
+    size_t _packetLength;
+    uint16_t _packetMessages;  ///< Messages with bytes in the packet, lost with it if its notification fails.
+    uint8_t _sequence;         ///< Sequence number of the next length-prefixed notification.
+    bool _resync;              ///< A notification failed: the next one marks the message boundary.
+    bool _notifyFailed;        ///< Set by onStatus() during notify().
+    Status _failedStatus;
+    uint32_t _notifications;
+    uint32_t _messages;
+    std::atomic<uint32_t> _failedNotifications;
+    std::atomic<uint32_t> _lostMessages;
+};
+
+#endif // NOTIFICATION_PACKER_H
@@ -0,0 +1,191 @@
+/*
+ * Object Pool for DGT3000 Gateway
+ *
+ * This header defines the fixed-capacity pools of the messages exchanged
+ * between the BLE side and the I2C task, so that the message path does
+ * not allocate once the gateway has booted.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+#include "ArenaAllocator.h"
+
+/**
+ * @struct ObjectPoolStats
+ * @brief Usage of an object pool.
+ */
+struct ObjectPoolStats {
+    uint8_t capacity;
+    uint8_t inUse;
+    uint8_t peakInUse;
+    uint32_t exhausted;     ///< Acquisitions that failed because every object was in use.
+    uint32_t heapFallbacks; ///< Blocks the JSON arenas of the objects had to take from the heap.
+};
+
+/**
+ * @class PoolReleaser
+ * @brief Interface through which a handle gives its object back to its pool.
+ */
+template <typename T>
+class PoolReleaser {
+public:
+    virtual void release(T* object) = 0;
+
+protected:
+    ~PoolReleaser() = default;
+};
+
+/**
+ * @struct PoolDeleter
+ * @brief unique_ptr deleter returning the object to its pool.
+ */
+template <typename T>
+struct PoolDeleter {
+    PoolReleaser<T>* pool = nullptr;
+    void operator()(T* object) const { pool->release(object); }
+};
+
+/**
+ * @brief Owning handle of a pooled object. The object goes back to its pool
+ * when the handle is destroyed or reset.
+ */
+template <typename T>
+using PoolPtr = std::unique_ptr<T, PoolDeleter<T>>;
+
+/**
+ * @struct PoolSlot
+ * @brief Storage of one pooled object, with its JSON arena when ArenaSize > 0.
+ * The object is constructed with a pointer to the arena as its last argument.
+ */
+template <typename T, size_t ArenaSize>
+struct PoolSlot {
+    StaticArenaAllocator<ArenaSize> arena;
+    alignas(T) uint8_t storage[sizeof(T)];
+
+    template <typename... Args>
+    T* construct(Args&&... args) { return new (storage) T(std::forward<Args>(args)..., &arena); }
+    uint32_t getHeapFallbackCount() const { return arena.getHeapFallbackCount(); }
+};
+
+template <typename T>
+struct PoolSlot<T, 0> {
+    alignas(T) uint8_t storage[sizeof(T)];
+
+    template <typename... Args>
+    T* construct(Args&&... args) { return new (storage) T(std::forward<Args>(args)...); }
+    uint32_t getHeapFallbackCount() const { return 0; }
+};
+
+/**
+ * @class ObjectPool
+ * @brief Fixed set of objects handed out through PoolPtr handles.
+ *
+ * Free objects are tracked in 32-bit masks updated with compare-and-swap, so
+ * any task can acquire or release without a lock: a command is acquired by the
+ * BLE callback and released by the I2C task, or by the BLE callback itself
+ * when its lane is full. Objects are constructed on acquisition and destroyed
+ * on release, so each one starts from a clean state.
+ *
+ * @tparam T Pooled type.
+ * @tparam Capacity Number of objects, at most 255.
+ * @tparam ArenaSize Size of the JSON arena of each object, 0 for none.
+ */
+template <typename T, size_t Capacity, size_t ArenaSize = 0>
+class ObjectPool : public PoolReleaser<T> {
+    static_assert(Capacity > 0 && Capacity <= UINT8_MAX, "ObjectPoolStats counts objects on 8 bits");
+
+public:
+    ObjectPool()
+        : _inUse(0), _peakInUse(0), _exhausted(0) {
+        for (size_t word = 0; word < MASK_WORDS; word++) {
+            size_t objects = (Capacity - 32 * word < 32) ? Capacity - 32 * word : 32;
+            _freeMasks[word].store(UINT32_MAX >> (32 - objects), std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Takes a free object and constructs it with the given arguments.
+     * @return The handle of the object, empty if the pool is exhausted.
+     */
+    template <typename... Args>
+    PoolPtr<T> acquire(Args&&... args) {
+        size_t index = Capacity;
+        for (size_t word = 0; word < MASK_WORDS && index == Capacity; word++) {
+            uint32_t mask = _freeMasks[word].load(std::memory_order_acquire);
+            while (mask != 0) {
+                uint32_t bit = mask & (~mask + 1); // Lowest free object.
+                if (_freeMasks[word].compare_exchange_weak(mask, mask & ~bit, std::memory_order_acquire, std::memory_order_acquire)) {
+                    index = 32 * word + __builtin_ctz(bit);
+                    break;
+                }
+            }
+        }
+        if (index == Capacity) {
+            _exhausted.fetch_add(1, std::memory_order_relaxed);
+            return PoolPtr<T>(nullptr, PoolDeleter<T>{this});
+        }
+
+        uint32_t inUse = _inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint32_t peak = _peakInUse.load(std::memory_order_relaxed);
+        while (inUse > peak && !_peakInUse.compare_exchange_weak(peak, inUse, std::memory_order_relaxed)) {
+        }
+
+        T* object = _slots[index].construct(std::forward<Args>(args)...);
+        return PoolPtr<T>(object, PoolDeleter<T>{this});
+    }
+
+    /**
+     * @brief Destroys the object and makes it available again. Called by PoolDeleter.
+     */
+    void release(T* object) override {
+        size_t index = (reinterpret_cast<uint8_t*>(object) - reinterpret_cast<uint8_t*>(_slots)) / sizeof(Slot);
+        object->~T();
+        _inUse.fetch_sub(1, std::memory_order_relaxed);
+        _freeMasks[index / 32].fetch_or(1UL << (index % 32), std::memory_order_release);
+    }
+
+    /**
+     * @brief Wraps an object taken out of a handle with release() back into a handle.
+     */
+    PoolPtr<T> adopt(T* object) { return PoolPtr<T>(object, PoolDeleter<T>{this}); }
+
+    ObjectPoolStats getStats() const {
+        ObjectPoolStats stats;
+        stats.capacity = Capacity;
+        stats.inUse = _inUse.load(std::memory_order_relaxed);
+        stats.peakInUse = _peakInUse.load(std::memory_order_relaxed);
+        stats.exhausted = _exhausted.load(std::memory_order_relaxed);
+        stats.heapFallbacks = 0;
+        for (size_t i = 0; i < Capacity; i++) {
+            stats.heapFallbacks += _slots[i].getHeapFallbackCount();
+        }
+        return stats;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    using Slot = PoolSlot<T, ArenaSize>;
+    static constexpr size_t MASK_WORDS = (Capacity + 31) / 32;
+
+    Slot _slots[Capacity];
+    std::atomic<uint32_t> _freeMasks[MASK_WORDS]; ///< One bit per free object, 32 objects per word.
+    std::atomic<uint32_t> _inUse;
+    std::atomic<uint32_t> _peakInUse;
+    std::atomic<uint32_t> _exhausted;
+};
+
+#endif // OBJECT_POOL_H
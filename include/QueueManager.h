@@ -1,8 +1,9 @@
 /*
- * FreeRTOS Queue Management Utilities
+ * Queue Management Utilities
  *
  * This header provides a thread-safe manager for inter-task communication
- * using FreeRTOS queues, specifically for the DGT3000 BLE Gateway.
+ * using lock-free single-producer single-consumer rings, specifically for
+ * the DGT3000 BLE Gateway.
  * It handles the lifecycle and operations for command, event, and response queues.
  * 
  * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
@@ -18,23 +19,74 @@
 
 #include "BLEGatewayTypes.h"
 #include "00-GatewayConstants.h"
-#include <freertos/FreeRTOS.h>
-#include <freertos/queue.h>
-#include <freertos/semphr.h>
+#include "TimeMailbox.h"
+#include "SpscRing.h"
+#include "ObjectPool.h"
+#include "LatencyHistogram.h"
+#include "StaticInstance.h"
 #include <logging.hpp>
 
 /**
  * @class QueueManager
- * @brief Manages thread-safe FreeRTOS queues for inter-task communication.
+ * @brief Manages thread-safe queues for inter-task communication.
  *
- * This class abstracts the creation, deletion, and operation of queues used
- * to pass data between the BLE task and the I2C task. It manages queues for:
- * - Raw Commands (BLE -> I2C)
- * - Events (I2C -> BLE)
+ * This class abstracts the operation of the queues used to pass data between
+ * the BLE task and the I2C task. Each queue is an SpscRing: every path has
+ * exactly one producer task and one consumer task, so no lock is needed. It
+ * manages queues for:
+ * - Raw Commands (BLE -> I2C), split into a control lane and a display lane
+ * - Events (I2C -> BLE), in one lane per class of event, served by weight
  * - Command Responses (I2C -> BLE)
+ * - Latest clock times (I2C -> BLE), in a mailbox rather than a queue
+ *
+ * It also owns the pools the messages are taken from: a message is acquired
+ * from its pool, moved through the ring as a pointer and goes back to the pool
+ * when the consumer drops its handle, so no message is allocated on the heap.
+ *
+ * Each message is stamped when it is pushed, and the time it spent in its ring
+ * is recorded when it is popped, separately for each ring.
+ */
+/**
+ * @brief Handles of the pooled messages.
  */
-class QueueManager : public esp32m::SimpleLoggable {
+using RawCommandPtr = PoolPtr<RawBLECommand>;
+using EventPtr = PoolPtr<DGTEvent>;
+using ResponsePtr = PoolPtr<CommandResponse>;
+
+class QueueManager : public esp32m::SimpleLoggable, public StaticInstance<QueueManager> {
 public:
+    /**
+     * @enum QueueId
+     * @brief Rings whose traffic is measured.
+     */
+    enum class QueueId : uint8_t {
+        CONTROL_COMMAND = 0,
+        DISPLAY_COMMAND,
+        ALERT_EVENT,    ///< First event lane, in the order of EventLane.
+        BUTTON_EVENT,
+        RESULT_EVENT,
+        TIME_EVENT,
+        STATUS_EVENT,
+        RESPONSE,
+        COUNT
+    };
+
+    /**
+     * @struct QueueMetrics
+     * @brief Traffic of one ring. Written by the producer and the consumer of
+     * the ring, readable from any task.
+     */
+    struct QueueMetrics {
+        std::atomic<uint32_t> enqueued;
+        std::atomic<uint32_t> dequeued;
+        std::atomic<uint32_t> dropped;    ///< Messages refused because the ring stayed full, or replaced by a newer one.
+        std::atomic<uint32_t> highWater;  ///< Largest depth seen after a push.
+        LatencyHistogram residency;       ///< Time from push to pop, in microseconds.
+
+        QueueMetrics() { reset(); }
+        void reset();
+    };
+
     /**
      * @brief Constructs a new QueueManager object.
      */
@@ -62,45 +114,102 @@ public:
      */
     bool isInitialized() const;
     
-    // --- Raw Command Queue (BLE -> I2C) ---
+    // --- Message Pools ---
 
     /**
-     * @brief Sends a raw command to the I2C task.
-     * @param rawData A unique_ptr to the RawBLECommand to send.
-     * @param timeoutMs Timeout in milliseconds to wait for space in the queue.
+     * @brief Takes a raw command from its pool. Called by the BLE callback.
+     * @return The command, empty if the pool is exhausted.
+     */
+    RawCommandPtr acquireRawCommand();
+
+    /**
+     * @brief Takes an event from its pool. Called by the I2C task.
+     * @return The event, empty if the pool is exhausted.
+     */
+    EventPtr acquireEvent(DGTEvent::Type type);
+
+    /**
+     * @brief Takes a command response from its pool. Called by the I2C task.
+     * @return The response, empty if the pool is exhausted.
+     */
+    ResponsePtr acquireResponse();
+
+    /**
+     * @brief Wraps a raw command taken out of its handle with release() back into a handle.
+     */
+    RawCommandPtr adoptRawCommand(RawBLECommand* rawCmd) { return _rawCommandPool.adopt(rawCmd); }
+
+    ObjectPoolStats getRawCommandPoolStats() const { return _rawCommandPool.getStats(); }
+    ObjectPoolStats getEventPoolStats() const { return _eventPool.getStats(); }
+    ObjectPoolStats getResponsePoolStats() const { return _responsePool.getStats(); }
+
+    // --- Raw Command Lanes (BLE -> I2C) ---
+
+    /**
+     * @brief Sends a raw command to the I2C task on the lane given by rawData->lane.
+     * @param rawData The RawBLECommand to send, returned to its pool on failure.
+     * @param timeoutMs Timeout in milliseconds to wait for space in the lane.
      * @return true if the command was sent successfully, false on timeout or error.
      */
-    bool sendRawCommand(std::unique_ptr<RawBLECommand> rawData, uint32_t timeoutMs = QUEUE_OPERATION_TIMEOUT_MS);
+    bool sendRawCommand(RawCommandPtr rawData, uint32_t timeoutMs = QUEUE_OPERATION_TIMEOUT_MS);
     
     /**
-     * @brief Receives a raw command from the queue.
-     * @param timeoutMs Timeout in milliseconds to wait for a command.
-     * @return A unique_ptr to the received RawBLECommand, or nullptr on timeout or error.
+     * @brief Receives a raw command, always draining the control lane first.
+     * The display lane is only read when the control lane is empty.
+     * @param timeoutMs Timeout in milliseconds to wait for a display command
+     * when the control lane is empty.
+     * @return The received RawBLECommand, or nullptr on timeout or error.
      */
-    std::unique_ptr<RawBLECommand> receiveRawCommand(uint32_t timeoutMs = QUEUE_OPERATION_TIMEOUT_MS);
+    RawCommandPtr receiveRawCommand(uint32_t timeoutMs = QUEUE_OPERATION_TIMEOUT_MS);
     
     uint16_t getRawCommandQueueDepth() const;
     uint16_t getRawCommandQueueFreeSpace() const;
     bool isRawCommandQueueFull() const;
     bool isRawCommandQueueEmpty() const;
+    
+    uint16_t getCommandLaneDepth(CommandLane lane) const;
+    uint16_t getCommandLaneFreeSpace(CommandLane lane) const;
+
+    /**
+     * @brief Estimates when a full command lane will accept a command again:
+     * the median time commands currently wait in it, within
+     * BUSY_RETRY_AFTER_MIN_MS and BUSY_RETRY_AFTER_MAX_MS.
+     */
+    uint32_t getRetryAfterMs(CommandLane lane) const;
 
-    // --- Event Queue (I2C -> BLE) ---
+    // --- Event Lanes (I2C -> BLE) ---
 
     /**
-     * @brief Sends a DGT event to the BLE task.
-     * @param event A unique_ptr to the DGTEvent to send.
-     * @param timeoutMs Timeout in milliseconds to wait for space in the queue.
-     * @return true if the event was sent successfully, false on timeout or error.
+     * @brief Sends a DGT event to the BLE task, in the lane of its type.
+     * In a KEEP_LATEST lane the event replaces the pending event of its type
+     * and is always accepted. In a NEVER lane that stays full for timeoutMs the
+     * event is held and pushed again by retryHeldEvents(); it is only dropped
+     * when the QUEUE_HELD_EVENT_SLOTS held events are all in use.
+     * @param event The DGTEvent to send, returned to its pool on failure.
+     * @param timeoutMs Timeout in milliseconds to wait for space in the lane.
+     * @return true if the event was sent or held, false on timeout or error.
+     */
+    bool sendEvent(EventPtr event, uint32_t timeoutMs = QUEUE_OPERATION_TIMEOUT_MS);
+
+    /**
+     * @brief Pushes the held events into their lanes, in order, as far as they have room.
+     * Called by the I2C task (the producer of the event lanes) at every cycle.
      */
-    bool sendEvent(std::unique_ptr<DGTEvent> event, uint32_t timeoutMs = QUEUE_OPERATION_TIMEOUT_MS);
+    void retryHeldEvents();
+
+    /**
+     * @brief Gets the number of events held while their lane was full.
+     */
+    uint8_t getHeldEventCount() const { return _heldEventCount; }
     
     /**
-     * @brief Receives a DGT event from the queue.
-     * @param timeoutMs Timeout in milliseconds to wait for an event.
-     * @return A unique_ptr to the received DGTEvent, or nullptr on timeout or error.
+     * @brief Receives the next DGT event, without waiting. When several lanes
+     * hold events, each is served in proportion to its weight.
+     * @return The received DGTEvent, or nullptr if every lane is empty.
      */
-    std::unique_ptr<DGTEvent> receiveEvent(uint32_t timeoutMs = QUEUE_OPERATION_TIMEOUT_MS);
+    EventPtr receiveEvent();
     
+    uint16_t getEventLaneDepth(EventLane lane) const;
     uint16_t getEventQueueDepth() const;
     uint16_t getEventQueueFreeSpace() const;
     bool isEventQueueFull() const;
@@ -110,37 +219,56 @@ public:
 
     /**
      * @brief Sends a command response to the BLE task.
-     * @param response A unique_ptr to the CommandResponse to send.
+     * @param response The CommandResponse to send, returned to its pool on failure.
      * @param timeoutMs Timeout in milliseconds to wait for space in the queue.
      * @return true if the response was sent successfully, false on timeout or error.
      */
-    bool sendResponse(std::unique_ptr<CommandResponse> response, uint32_t timeoutMs = QUEUE_OPERATION_TIMEOUT_MS);
+    bool sendResponse(ResponsePtr response, uint32_t timeoutMs = QUEUE_OPERATION_TIMEOUT_MS);
     
     /**
      * @brief Receives a command response from the queue.
      * @param timeoutMs Timeout in milliseconds to wait for a response.
-     * @return A unique_ptr to the received CommandResponse, or nullptr on timeout or error.
+     * @return The received CommandResponse, or nullptr on timeout or error.
      */
-    std::unique_ptr<CommandResponse> receiveResponse(uint32_t timeoutMs = QUEUE_OPERATION_TIMEOUT_MS);
+    ResponsePtr receiveResponse(uint32_t timeoutMs = QUEUE_OPERATION_TIMEOUT_MS);
     
     uint16_t getResponseQueueDepth() const;
     uint16_t getResponseQueueFreeSpace() const;
     bool isResponseQueueFull() const;
     bool isResponseQueueEmpty() const;
     
+    // --- Time Mailbox (I2C -> BLE) ---
+
     /**
-     * @brief Sends a high-priority event (e.g., an error) to the front of the event queue.
-     * @param event A unique_ptr to the DGTEvent to send.
-     * @param timeoutMs Timeout in milliseconds to wait for space in the queue.
-     * @return true if the event was sent successfully, false on timeout or error.
+     * @brief Gets the mailbox of the latest clock times. Written by the I2C task, read by the BLE task.
      */
-    bool sendPriorityEvent(std::unique_ptr<DGTEvent> event, uint32_t timeoutMs = QUEUE_OPERATION_TIMEOUT_MS);
+    TimeMailbox& getTimeMailbox() { return _timeMailbox; }
     
     // --- Statistics and Monitoring ---
     
-    const QueueStats& getStatistics() const;
+    /**
+     * @brief Gets a snapshot of the totals over all rings.
+     */
+    QueueStats getStatistics() const;
     void resetStatistics();
-    void updateStatistics();
+
+    /**
+     * @brief Gets the traffic and residency of one ring.
+     */
+    const QueueMetrics& getQueueMetrics(QueueId id) const { return _metrics[(uint8_t)id]; }
+
+    /**
+     * @brief Gets the highest 99th percentile of residency over all rings, in microseconds.
+     */
+    uint32_t getWorstResidencyP99() const;
+
+    /**
+     * @brief Adds the counters, high-water marks and residency percentiles of
+     * every ring under "rings", then the pool statistics under "pools", to a
+     * document. Too large for the status characteristic and for a routine
+     * getStatus: only getQueueStats reports them.
+     */
+    void reportMetrics(JsonObject stats) const;
     
     /**
      * @brief Checks if all queues are operating within healthy utilization thresholds.
@@ -155,7 +283,7 @@ public:
     // --- Emergency Operations ---
     
     /**
-     * @brief Flushes all items from all queues, freeing allocated memory.
+     * @brief Flushes all items from all queues, returning them to their pools.
      */
     void flushAllQueues();
     void flushRawCommandQueue();
@@ -168,26 +296,80 @@ public:
     void printStatistics();
     
 private:
-    QueueHandles _queues; ///< Holds the handles for the FreeRTOS queues.
-    SemaphoreHandle_t _queueMutex; ///< Mutex for thread-safe access to queues.
-    QueueStats _stats; ///< Statistics for queue operations.
+    // Pools of the messages. Declared before the rings, which hold pointers into them.
+    ObjectPool<RawBLECommand, POOL_RAW_COMMAND_SIZE> _rawCommandPool;
+    ObjectPool<DGTEvent, POOL_EVENT_SIZE, POOL_EVENT_ARENA_SIZE> _eventPool;
+    ObjectPool<CommandResponse, POOL_RESPONSE_SIZE, POOL_RESPONSE_ARENA_SIZE> _responsePool;
+    
+    /**
+     * @struct Entry
+     * @brief Owned pointer to a message, with the time it was pushed.
+     */
+    template <typename T>
+    struct Entry {
+        T* item;
+        uint32_t enqueuedUs;
+    };
+
+    // Lock-free rings of owned pointers, one producer and one consumer each.
+    SpscRing<Entry<RawBLECommand>, QUEUE_CONTROL_COMMAND_SIZE> _controlCommandRing; ///< BLE callback -> I2C task.
+    SpscRing<Entry<RawBLECommand>, QUEUE_DISPLAY_COMMAND_SIZE> _displayCommandRing; ///< BLE callback -> I2C task.
+    SpscRing<Entry<DGTEvent>, QUEUE_ALERT_EVENT_SIZE> _alertEventRing;              ///< I2C task -> main loop.
+    SpscRing<Entry<DGTEvent>, QUEUE_BUTTON_EVENT_SIZE> _buttonEventRing;            ///< I2C task -> main loop.
+    SpscRing<Entry<DGTEvent>, QUEUE_RESULT_EVENT_SIZE> _resultEventRing;            ///< I2C task -> main loop.
+    SpscRing<Entry<CommandResponse>, QUEUE_RESPONSE_SIZE> _responseRing;             ///< I2C task -> main loop.
+    bool _initialized;
+    QueueMetrics _metrics[(uint8_t)QueueId::COUNT]; ///< Traffic of each ring.
+
+    // Pending event of each type in the KEEP_LATEST lanes, replaced by the
+    // I2C task and taken by the main loop with an atomic exchange.
+    static constexpr uint8_t EVENT_TYPE_COUNT = DGTEvent::TIME_ANOMALY + 1;
+    std::atomic<DGTEvent*> _latestEvents[EVENT_TYPE_COUNT];
+    std::atomic<uint32_t> _latestEventStamps[EVENT_TYPE_COUNT]; ///< Push time of each pending event.
+    int16_t _eventLaneCredits[(uint8_t)EventLane::COUNT];      ///< Weighted round robin state, main loop only.
+    /**
+     * @struct HeldEvent
+     * @brief Event of a NEVER lane that found its ring full, with the time it was held.
+     */
+    struct HeldEvent {
+        DGTEvent* event;
+        uint32_t heldUs;
+    };
+    HeldEvent _heldEvents[QUEUE_HELD_EVENT_SLOTS]; ///< Oldest first, I2C task only.
+    uint8_t _heldEventCount;
+    uint8_t _heldEventPeak;
+    std::atomic<uint32_t> _receiveTimeouts;         ///< Receives that waited and got nothing.
+    TimeMailbox _timeMailbox; ///< Latest clock times, overwritten instead of queued.
     
     // Health monitoring
     uint32_t _lastHealthCheck;
     bool _healthy;
     
     // Internal helper methods
-    bool createQueue(QueueHandle_t& queue, size_t itemSize, size_t queueLength, const char* name);
-    void destroyQueue(QueueHandle_t& queue);
-    bool sendToQueueSafe(QueueHandle_t queue, const void* item, size_t itemSize, uint32_t timeoutMs);
-    bool receiveFromQueueSafe(QueueHandle_t queue, void* item, size_t itemSize, uint32_t timeoutMs);
-    void updateQueueStats(bool isSend, bool success, bool isCommand);
+    template <typename T, size_t Capacity>
+    bool pushEntry(SpscRing<Entry<T>, Capacity>& ring, QueueId id, T* item, uint32_t timeoutMs,
+                   uint32_t enqueuedUs, bool countDrop = true);
+    template <typename T, size_t Capacity>
+    bool popEntry(SpscRing<Entry<T>, Capacity>& ring, QueueId id, T*& item, uint32_t timeoutMs);
+    bool pushEventLane(EventLane lane, DGTEvent* event, uint32_t enqueuedUs, uint32_t timeoutMs, bool countDrop);
+    bool hasHeldEvents(EventLane lane) const;
+    bool holdEvent(DGTEvent* event);
+    void storeLatestEvent(DGTEvent* event);
+    bool takeLatestEvent(EventLane lane, DGTEvent*& event);
+    bool popEventLane(EventLane lane, DGTEvent*& event);
+    static QueueId getEventQueueId(EventLane lane) { return (QueueId)((uint8_t)QueueId::ALERT_EVENT + (uint8_t)lane); }
+    static uint8_t getEventLaneWeight(EventLane lane);
     
     // Constants for health monitoring
     static constexpr uint32_t HEALTH_CHECK_INTERVAL_MS = 5000;
     static constexpr float QUEUE_HEALTH_THRESHOLD = 0.8f; // 80% utilization
 };
 
+/**
+ * @brief Converts a QueueManager::QueueId to the prefix of its status keys.
+ */
+const char* getQueueIdString(QueueManager::QueueId id);
+
 // Global queue manager instance
 extern std::unique_ptr<QueueManager> g_queueManager;
 
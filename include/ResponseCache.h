@@ -0,0 +1,136 @@
+/*
+ * Command Response Cache for DGT3000 Gateway
+ *
+ * This header defines a small LRU cache of serialized command responses,
+ * keyed by command ID and protocol, used to answer client retransmits
+ * without re-executing the command.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "00-GatewayConstants.h"
+#include "BLEGatewayTypes.h"
+#include <logging.hpp>
+
+/**
+ * @class ResponseCache
+ * @brief Thread-safe LRU cache of serialized command responses.
+ *
+ * A command ID is registered as "pending" when its command is admitted, and
+ * "completed" with the serialized response once it has been sent. A duplicate
+ * ID seen within RESPONSE_CACHE_WINDOW_MS is either answered from the cache
+ * (completed) or ignored (pending, the response is on its way).
+ * JSON and binary commands are kept apart: the same ID string sent with the
+ * other protocol is another command.
+ */
+class ResponseCache : public esp32m::SimpleLoggable {
+public:
+    /**
+     * @enum LookupResult
+     * @brief Outcome of a lookup for an incoming command ID.
+     */
+    enum LookupResult : uint8_t {
+        MISS = 0,   ///< Unknown ID. It has been registered as pending.
+        PENDING,    ///< The same ID is already being executed.
+        HIT         ///< A response is cached and has been copied to the output buffer.
+    };
+
+    ResponseCache();
+    ~ResponseCache();
+
+    /**
+     * @brief Creates the mutex protecting the cache.
+     * @return true on success, false otherwise.
+     */
+    bool initialize();
+
+    /**
+     * @brief Looks up a command ID, registering it as pending on a miss.
+     * @param id The command ID.
+     * @param response Output buffer receiving the cached response on a hit.
+     * @param responseSize Size of the output buffer.
+     * @return The lookup result.
+     */
+    LookupResult lookup(const char* id, char* response, size_t responseSize);
+
+    /**
+     * @brief Looks up a binary command ID, registering it as pending on a miss.
+     * @param id The command ID, as formatted by BinaryProtocol::formatCommandId.
+     * @param frame Output buffer receiving the cached response frame on a hit.
+     * @param frameSize Size of the output buffer.
+     * @param length Receives the length of the cached frame on a hit.
+     * @return The lookup result.
+     */
+    LookupResult lookupBinary(const char* id, uint8_t* frame, size_t frameSize, size_t& length);
+
+    /**
+     * @brief Stores the serialized response of a pending command ID.
+     * Responses that do not fit in an entry are not cached.
+     * @param id The command ID.
+     * @param response The serialized JSON response.
+     */
+    void complete(const char* id, const char* response);
+
+    /**
+     * @brief Stores the encoded response frame of a pending binary command ID.
+     * Frames that do not fit in an entry are not cached.
+     * @param id The command ID.
+     * @param frame The encoded response frame.
+     * @param length Length of the frame.
+     */
+    void completeBinary(const char* id, const uint8_t* frame, size_t length);
+
+    /**
+     * @brief Forgets a command ID, e.g. when its command could not be queued.
+     * @param id The command ID.
+     * @param format The protocol the command was received with.
+     */
+    void remove(const char* id, CommandFormat format = CommandFormat::JSON);
+
+    /**
+     * @brief Empties the cache.
+     */
+    void clear();
+
+    uint32_t getHits() const { return _hits; }
+    uint32_t getMisses() const { return _misses; }
+
+private:
+    struct Entry {
+        char id[APP_MAX_COMMAND_ID_LENGTH];
+        uint8_t response[RESPONSE_CACHE_ENTRY_SIZE];
+        uint16_t responseLength;
+        CommandFormat format;
+        bool used;
+        bool completed;
+        uint32_t createdTime;  ///< When the ID was first seen (window start).
+        uint32_t lastUseTime;  ///< For LRU eviction.
+    };
+
+    Entry _entries[RESPONSE_CACHE_SIZE];
+    SemaphoreHandle_t _mutex;
+#if GATEWAY_STATIC_ALLOCATION
+    StaticSemaphore_t _mutexBuffer;
+#endif
+    uint32_t _hits;
+    uint32_t _misses;
+
+    LookupResult lookup(const char* id, CommandFormat format, uint8_t* response, size_t responseSize, size_t& length);
+    void complete(const char* id, CommandFormat format, const uint8_t* response, size_t length);
+    Entry* find(const char* id, CommandFormat format, uint32_t now);
+    Entry* allocate(uint32_t now);
+    bool isExpired(const Entry& entry, uint32_t now) const;
+};
+
+#endif // RESPONSE_CACHE_H
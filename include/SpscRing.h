@@ -0,0 +1,142 @@
+/*
+ * Single-Producer Single-Consumer Ring for DGT3000 Gateway
+ *
+ * This header defines the lock-free ring buffer used between the I2C task
+ * (core 0) and the BLE side (core 1), with task notifications for the
+ * rare blocking waits.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <utility>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "00-GatewayConstants.h"
+
+/**
+ * @class SpscRing
+ * @brief Bounded lock-free FIFO for exactly one producer task and one consumer task.
+ *
+ * Items are stored inline. Each index is written by one side only, so push()
+ * and pop() need no critical section: the producer publishes an item with a
+ * release store of the tail, the consumer frees a slot with a release store
+ * of the head. The two indexes live in separate cache lines.
+ *
+ * A side that has to wait (full ring for the producer, empty ring for the
+ * consumer) registers its task handle and sleeps on its task notification;
+ * the other side notifies it after its next operation. Waits re-check the
+ * ring after each wakeup, so stray notifications are harmless.
+ *
+ * @tparam T Item type, moved in and out of the ring.
+ * @tparam Capacity Maximum number of items.
+ */
+template <typename T, size_t Capacity>
+class SpscRing {
+public:
+    SpscRing() : _head(0), _tail(0), _consumerWaiter(nullptr), _producerWaiter(nullptr) {}
+
+    /**
+     * @brief Appends an item. Producer side only.
+     * @param item The item, moved into the ring on success.
+     * @param timeoutMs Time to wait for a free slot, 0 to fail at once.
+     * @return false if the ring stayed full.
+     */
+    bool push(T& item, uint32_t timeoutMs = 0) {
+        if (!tryPush(item) && !waitUntil([&] { return tryPush(item); }, _producerWaiter, timeoutMs)) {
+            return false;
+        }
+        wake(_consumerWaiter);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest item. Consumer side only.
+     * @param item Set to the item on success.
+     * @param timeoutMs Time to wait for an item, 0 to fail at once.
+     * @return false if the ring stayed empty.
+     */
+    bool pop(T& item, uint32_t timeoutMs = 0) {
+        if (!tryPop(item) && !waitUntil([&] { return tryPop(item); }, _consumerWaiter, timeoutMs)) {
+            return false;
+        }
+        wake(_producerWaiter);
+        return true;
+    }
+
+    /**
+     * @brief Gets the number of items. Exact from either side, approximate from a third task.
+     */
+    size_t size() const {
+        uint32_t tail = _tail.load(std::memory_order_acquire);
+        uint32_t head = _head.load(std::memory_order_acquire);
+        return (tail + SLOTS - head) % SLOTS;
+    }
+
+    size_t freeSpace() const { return Capacity - size(); }
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    // One slot always stays empty to tell a full ring from an empty one.
+    static constexpr uint32_t SLOTS = Capacity + 1;
+
+    alignas(SPSC_RING_ALIGNMENT) std::atomic<uint32_t> _head;  ///< Next slot to read, written by the consumer.
+    alignas(SPSC_RING_ALIGNMENT) std::atomic<uint32_t> _tail;  ///< Next slot to write, written by the producer.
+    alignas(SPSC_RING_ALIGNMENT) std::atomic<TaskHandle_t> _consumerWaiter;
+    std::atomic<TaskHandle_t> _producerWaiter;
+    alignas(SPSC_RING_ALIGNMENT) T _items[SLOTS];
+
+    bool tryPush(T& item) {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        uint32_t next = (tail + 1) % SLOTS;
+        if (next == _head.load(std::memory_order_acquire)) return false;
+        _items[tail] = std::move(item);
+        _tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& item) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) return false;
+        item = std::move(_items[head]);
+        _head.store((head + 1) % SLOTS, std::memory_order_release);
+        return true;
+    }
+
+    // Retries the operation each time the other side notifies, until the timeout.
+    // The waiter is registered before the retry, so a notification sent between
+    // the failed attempt and the sleep is not lost.
+    template <typename Operation>
+    bool waitUntil(Operation operation, std::atomic<TaskHandle_t>& waiter, uint32_t timeoutMs) {
+        uint32_t start = millis();
+        uint32_t elapsed;
+        while ((elapsed = millis() - start) < timeoutMs) {
+            waiter.store(xTaskGetCurrentTaskHandle(), std::memory_order_seq_cst);
+            if (operation()) {
+                waiter.store(nullptr, std::memory_order_relaxed);
+                return true;
+            }
+            TickType_t ticks = pdMS_TO_TICKS(timeoutMs - elapsed);
+            ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1);
+            waiter.store(nullptr, std::memory_order_relaxed);
+        }
+        return operation();
+    }
+
+    void wake(std::atomic<TaskHandle_t>& waiter) {
+        TaskHandle_t task = waiter.exchange(nullptr, std::memory_order_seq_cst);
+        if (task != nullptr) xTaskNotifyGive(task);
+    }
+};
+
+#endif // SPSC_RING_H
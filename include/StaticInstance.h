@@ -0,0 +1,73 @@
+/*
+ * Static Instance Storage for DGT3000 Gateway
+ *
+ * This header defines the base class that places the single instance of a
+ * long-lived gateway object in static storage when the gateway is built
+ * with GATEWAY_STATIC_ALLOCATION.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef STATIC_INSTANCE_H
+#define STATIC_INSTANCE_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+#include "00-GatewayConstants.h"
+
+/**
+ * @class StaticInstance
+ * @brief Gives T a class-specific operator new backed by one static slot.
+ *
+ * The objects created once at boot (managers, BLE callbacks) derive from it,
+ * so that `new T(...)` and the owning unique_ptr stay unchanged: in a static
+ * build the object is constructed in the slot of StaticInstance<T>, which the
+ * linker reserves and the memory report attributes to T. The slot has the
+ * alignment of T, which matters for the over-aligned members (SpscRing).
+ * A second instance while the first is alive gets nullptr, like a failed
+ * allocation.
+ *
+ * Without GATEWAY_STATIC_ALLOCATION, this class adds nothing.
+ *
+ * @tparam T The derived class.
+ */
+template <typename T>
+class StaticInstance {
+#if GATEWAY_STATIC_ALLOCATION
+public:
+    static void* operator new(size_t size) noexcept {
+        uint8_t* storage = getStorage();
+        if (_allocated || size > sizeof(T)) return nullptr;
+        if (reinterpret_cast<uintptr_t>(storage) % alignof(T) != 0) return nullptr;
+        _allocated = true;
+        return storage;
+    }
+
+    static void operator delete(void* ptr) noexcept {
+        if (ptr == getStorage()) _allocated = false;
+    }
+
+private:
+    // T is still incomplete when this class is instantiated: the slot is only
+    // sized and aligned in this body, instantiated by the first `new T`.
+    static uint8_t* getStorage() noexcept {
+        alignas(T) static uint8_t storage[sizeof(T)];
+        return storage;
+    }
+
+    static bool _allocated;
+#endif
+};
+
+#if GATEWAY_STATIC_ALLOCATION
+template <typename T>
+bool StaticInstance<T>::_allocated = false;
+#endif
+
+#endif // STATIC_INSTANCE_H
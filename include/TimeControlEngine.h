@@ -0,0 +1,161 @@
+/*
+ * Time Control Engine for DGT3000 Gateway
+ *
+ * This header defines the gateway-resident time control: it reacts to
+ * lever moves locally and computes the new clock times (increment, delay,
+ * multi-period), without a round trip to the client.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef TIME_CONTROL_ENGINE_H
+#define TIME_CONTROL_ENGINE_H
+
+#include <Arduino.h>
+#include "00-GatewayConstants.h"
+
+/**
+ * @class TimeControlEngine
+ * @brief Time control arithmetic, driven by lever moves.
+ *
+ * The engine only computes clock settings; the owner (the I2C task) reads the
+ * clock times, passes them to onMove() and writes the returned setting to the
+ * clock. Times are in whole seconds, the resolution of the DGT3000.
+ */
+class TimeControlEngine {
+public:
+    /**
+     * @enum Mode
+     * @brief Bonus applied to each move.
+     */
+    enum class Mode : uint8_t {
+        NONE = 0,   ///< Sudden death: no bonus.
+        FISCHER,    ///< The increment is added after each move.
+        BRONSTEIN,  ///< The time used is given back, up to the increment.
+        DELAY       ///< US delay: the clock starts counting after the increment.
+    };
+
+    /**
+     * @enum Side
+     * @brief Side of the clock.
+     */
+    enum class Side : uint8_t {
+        NONE = 0,
+        LEFT,
+        RIGHT
+    };
+
+    /**
+     * @struct Period
+     * @brief A period of the time control, e.g. 40 moves in 90 minutes.
+     */
+    struct Period {
+        uint16_t moves;            ///< Moves to play in this period, 0 for the rest of the game.
+        uint32_t seconds;          ///< Time added at the start of the period.
+        uint16_t incrementSeconds; ///< Increment or delay per move in this period.
+    };
+
+    /**
+     * @struct ClockSetting
+     * @brief Times and running side to write to the clock.
+     */
+    struct ClockSetting {
+        uint32_t leftSeconds;
+        uint32_t rightSeconds;
+        Side running;  ///< Side counting down, NONE if both are stopped.
+    };
+
+    TimeControlEngine();
+
+    /**
+     * @brief Configures and enables the time control. Both sides start the first period.
+     * @param mode Bonus applied to each move.
+     * @param periods Periods of the game, in order.
+     * @param count Number of periods, 1 to TIME_CONTROL_MAX_PERIODS.
+     * @param initial Set to the clock setting at the start of the game (both stopped).
+     * @param err Set to an error message on failure.
+     * @return false if the configuration is invalid.
+     */
+    bool configure(Mode mode, const Period* periods, uint8_t count, ClockSetting& initial, const char*& err);
+
+    /**
+     * @brief Disables the time control. Lever moves are then only reported.
+     */
+    void disable();
+
+    /**
+     * @brief Stops following the game until the next lever move, e.g. after the
+     * client stopped or set the clock. Moves and periods are kept.
+     */
+    void pause();
+
+    /**
+     * @brief Handles the end of a move.
+     * @param side Side whose player pressed the lever.
+     * @param leftSeconds Current time of the left side.
+     * @param rightSeconds Current time of the right side.
+     * @param now Current time in milliseconds.
+     * @param setting Set to the new clock setting.
+     * @return true if the clock must be set, false if the move is ignored.
+     */
+    bool onMove(Side side, uint32_t leftSeconds, uint32_t rightSeconds, uint32_t now, ClockSetting& setting);
+
+    /**
+     * @brief Ends the delay of the running side when it has elapsed (US delay).
+     * @param now Current time in milliseconds.
+     * @param setting Set to the new clock setting.
+     * @return true if the clock must be set.
+     */
+    bool update(uint32_t now, ClockSetting& setting);
+
+    bool isEnabled() const { return _enabled; }
+    Mode getMode() const { return _mode; }
+    Side getRunning() const { return _running; }
+    bool isDelayPending() const { return _delayPending; }
+    uint16_t getMoves(Side side) const;
+    uint8_t getPeriod(Side side) const;
+
+private:
+    bool _enabled;
+    Mode _mode;
+    Period _periods[TIME_CONTROL_MAX_PERIODS];
+    uint8_t _periodCount;
+
+    Side _running;
+    bool _delayPending;
+    uint32_t _delayEndTime;
+    uint32_t _moveStartSeconds;     ///< Time of the running side when its move started.
+    uint32_t _delayTimes[2];        ///< Times of both sides, held while the delay runs.
+
+    uint16_t _moves[2];             ///< Moves completed by each side.
+    uint8_t _period[2];             ///< Current period index of each side.
+    uint16_t _periodEndMove[2];     ///< Move count ending the current period, 0 if last.
+
+    static uint8_t index(Side side) { return side == Side::LEFT ? 0 : 1; }
+    static Side opponent(Side side) { return side == Side::LEFT ? Side::RIGHT : Side::LEFT; }
+    uint32_t applyMove(Side side, uint32_t remainingSeconds);
+    void startMove(Side side, uint32_t remainingSeconds, uint32_t now);
+};
+
+/**
+ * @brief Parses a time control mode name ("none", "fischer", "bronstein", "delay").
+ * @return false if the name is unknown.
+ */
+bool parseTimeControlMode(const char* name, TimeControlEngine::Mode& mode);
+
+/**
+ * @brief Converts a TimeControlEngine::Mode to a human-readable string.
+ */
+const char* getTimeControlModeString(TimeControlEngine::Mode mode);
+
+/**
+ * @brief Converts a TimeControlEngine::Side to a human-readable string.
+ */
+const char* getTimeControlSideString(TimeControlEngine::Side side);
+
+#endif // TIME_CONTROL_ENGINE_H
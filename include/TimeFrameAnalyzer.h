@@ -0,0 +1,133 @@
+/*
+ * Time Frame Analyzer for DGT3000 Gateway
+ *
+ * This header defines the analyzer that checks the stream of time messages
+ * from the clock against esp_timer: lost and duplicated seconds, irregular
+ * gaps between messages and long-term drift of the clock oscillator.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef TIME_FRAME_ANALYZER_H
+#define TIME_FRAME_ANALYZER_H
+
+#include <Arduino.h>
+#include "DGT3000.h"
+#include "TimeControlEngine.h"
+#include "00-GatewayConstants.h"
+
+/**
+ * @class TimeFrameAnalyzer
+ * @brief Quality checks of the time messages received on the I2C bus.
+ *
+ * A running side is expected to change by one second per message, about one
+ * second apart. The run modes come from the clock model, so only the sides
+ * the gateway started are checked, and the baseline restarts each time the
+ * gateway sets the clock. The drift adds up, over all the runs since
+ * clearStats(), the clock time between the first and the last second change
+ * of each run against the esp_timer time between them. It keeps improving
+ * during a long game, where the clock model only keeps a smoothed short-term
+ * value. Since the messages are
+ * stamped on arrival on the bus, gaps found here come from the clock or the
+ * bus, not from BLE. It is not thread-safe; it is owned by the I2C task.
+ */
+class TimeFrameAnalyzer {
+public:
+    /**
+     * @enum Anomaly
+     * @brief Kind of problem found in a time message.
+     */
+    enum class Anomaly : uint8_t {
+        NONE = 0,
+        MISSING_SECONDS,  ///< A running side skipped seconds (lost messages).
+        DUPLICATE_SECOND, ///< A running side repeated the same second.
+        IRREGULAR_GAP,    ///< The time between two messages does not match the seconds elapsed.
+        DRIFT             ///< The clock oscillator drifts beyond TIME_ANALYZER_DRIFT_ALERT_PPM.
+    };
+
+    /**
+     * @struct Report
+     * @brief An anomaly found in a time message.
+     */
+    struct Report {
+        Anomaly anomaly;
+        TimeControlEngine::Side side;  ///< Side concerned, NONE for gaps.
+        int32_t value;                 ///< Seconds missing, gap in ms, or drift in ppm.
+    };
+
+    /**
+     * @struct Stats
+     * @brief Aggregates since the last clearStats().
+     */
+    struct Stats {
+        uint32_t frames;           ///< Time messages analyzed while a side was running.
+        uint32_t missingSeconds;
+        uint32_t duplicateFrames;
+        uint32_t irregularGaps;
+        uint32_t minGapMs;         ///< Shortest gap between two one-second messages.
+        uint32_t maxGapMs;         ///< Longest gap between two consecutive messages.
+        int32_t driftPpm;          ///< Long-term drift, positive when the clock runs slow.
+        uint32_t driftSpanSeconds; ///< Clock time over which driftPpm was measured, 0 if not yet measured.
+    };
+
+    TimeFrameAnalyzer();
+
+    /**
+     * @brief Restarts the baseline, e.g. after the clock was set. Aggregates and drift are kept.
+     */
+    void reset();
+
+    /**
+     * @brief Clears the aggregates and the drift, e.g. for a new clock.
+     */
+    void clearStats();
+
+    /**
+     * @brief Analyzes a time message.
+     * @param time The decoded times: [L_H, L_M, L_S, R_H, R_M, R_S].
+     * @param leftMode, rightMode Run modes set by the gateway (DGTRunMode).
+     * @param arrivalUs esp_timer time at which the message was received.
+     * @param report Set to the anomaly found, if any.
+     * @return true if an anomaly was found.
+     */
+    bool onFrame(const uint8_t time[6], uint8_t leftMode, uint8_t rightMode, int64_t arrivalUs, Report& report);
+
+    const Stats& getStats() const { return _stats; }
+
+private:
+    struct SideState {
+        uint32_t lastSeconds;
+        uint32_t anchorSeconds;  ///< Clock time at the first second change of the run.
+        int64_t anchorUs;
+        bool anchored;
+        uint32_t runSeconds;     ///< Clock time from the anchor to the last second change.
+        int64_t runUs;           ///< esp_timer time over the same span.
+    };
+    SideState _sides[2];
+    uint8_t _lastModes[2];
+    int64_t _lastArrivalUs;
+    bool _hasLast;
+    Stats _stats;
+
+    // Drift over the completed runs
+    uint32_t _driftSeconds;
+    int64_t _driftUs;
+    bool _driftReported;
+
+    void analyzeSide(uint8_t index, uint32_t seconds, uint8_t mode, int64_t arrivalUs,
+                     uint32_t& advanced, Report& report);
+    void endRuns();
+    void updateDrift(TimeControlEngine::Side side, Report& report);
+};
+
+/**
+ * @brief Converts a TimeFrameAnalyzer::Anomaly to a human-readable string.
+ */
+const char* getTimeAnomalyString(TimeFrameAnalyzer::Anomaly anomaly);
+
+#endif // TIME_FRAME_ANALYZER_H
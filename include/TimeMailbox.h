@@ -0,0 +1,70 @@
+/*
+ * Time Mailbox for DGT3000 Gateway
+ *
+ * This header defines the single-slot mailbox carrying the latest clock
+ * times from the I2C task to the BLE task, replacing one queued event per
+ * time message.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef TIME_MAILBOX_H
+#define TIME_MAILBOX_H
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * @struct TimeSnapshot
+ * @brief Clock times and run modes at one time message.
+ */
+struct TimeSnapshot {
+    uint8_t time[6];     ///< Left h/m/s, right h/m/s, as returned by DGT3000::getTime().
+    uint8_t leftMode;    ///< Run mode of the left side (0: stopped, 1: down, 2: up).
+    uint8_t rightMode;   ///< Run mode of the right side.
+    uint32_t timestamp;  ///< millis() when the time message was received.
+};
+
+/**
+ * @class TimeMailbox
+ * @brief Latest-value mailbox protected by a sequence lock.
+ *
+ * One writer (the I2C task) overwrites the slot without ever waiting; one
+ * reader (the BLE task) takes the latest value when it has airtime. Values
+ * the reader did not take in time are superseded, never queued, so a slow
+ * link cannot fill the event queue with stale times.
+ */
+class TimeMailbox {
+public:
+    TimeMailbox();
+
+    /**
+     * @brief Replaces the slot content. Writer side only.
+     */
+    void publish(const TimeSnapshot& snapshot);
+
+    /**
+     * @brief Reads the slot if it was published since the last successful read. Reader side only.
+     * @param snapshot Set to the latest value.
+     * @return false if nothing new was published.
+     */
+    bool take(TimeSnapshot& snapshot);
+
+    /**
+     * @brief Gets the number of values overwritten before the reader took them.
+     */
+    uint32_t getSupersededCount() const { return _superseded.load(std::memory_order_relaxed); }
+
+private:
+    TimeSnapshot _slot;
+    std::atomic<uint32_t> _sequence;  ///< Odd while a write is in progress.
+    std::atomic<uint32_t> _taken;     ///< Sequence of the last value read.
+    std::atomic<uint32_t> _superseded;
+};
+
+#endif // TIME_MAILBOX_H
@@ -21,6 +21,37 @@
 // Static instance for handling I2C slave callbacks.
 DGT3000* DGT3000::_instance = nullptr;
 
+#ifdef DGT3000_STATIC_ALLOCATION
+// Storage of the single driver instance in static builds.
+alignas(DGT3000) static uint8_t dgt3000Storage[sizeof(DGT3000)];
+static bool dgt3000Allocated = false;
+
+void* DGT3000::operator new(size_t size) noexcept {
+    if (dgt3000Allocated || size > sizeof(dgt3000Storage)) return nullptr;
+    dgt3000Allocated = true;
+    return dgt3000Storage;
+}
+
+void DGT3000::operator delete(void* ptr) noexcept {
+    if (ptr == dgt3000Storage) dgt3000Allocated = false;
+}
+#endif
+
+// I2C bus objects: allocated, or the framework's own in static builds.
+static TwoWire* createWire(uint8_t busNum) {
+#ifdef DGT3000_STATIC_ALLOCATION
+    return (busNum == 0) ? &Wire : &Wire1;
+#else
+    return new TwoWire(busNum);
+#endif
+}
+
+static void destroyWire(TwoWire* wire) {
+#ifndef DGT3000_STATIC_ALLOCATION
+    delete wire;
+#endif
+}
+
 // Pre-calculated CRC-8-ATM table (x^8 + x^2 + x + 1).
 static const uint8_t crc_table[256] = {
     0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
@@ -77,6 +108,7 @@ DGT3000::DGT3000() {
     _newAckReceived = false;
     _newPingResponseReceived = false;
     _newTimeAvailable = false;
+    _lastTimeUpdateMicros = 0;
     
     resetRxData();
     
@@ -100,28 +132,28 @@ bool DGT3000::begin(int masterSDA, int masterSCL, int slaveSDA, int slaveSCL) {
     // Clean up any existing I2C instances
     if (_i2cMaster) {
         _i2cMaster->end();
-        delete _i2cMaster;
+        destroyWire(_i2cMaster);
         _i2cMaster = nullptr;
     }
     if (_i2cSlave) {
         _i2cSlave->end();
-        delete _i2cSlave;
+        destroyWire(_i2cSlave);
         _i2cSlave = nullptr;
     }
     
     // Initialize I2C Master (for sending commands)
-    _i2cMaster = new TwoWire(0);
+    _i2cMaster = createWire(0);
     if (!_i2cMaster->begin(_masterSDA, _masterSCL, DGT3000_I2C_FREQUENCY)) {
         DGT_LOG_INFO("DGT3000: Failed to initialize I2C Master.");
         DGT_LOG_INFO_F("DGT3000: Master pins - SDA: %d, SCL: %d", _masterSDA, _masterSCL);
-        delete _i2cMaster;
+        destroyWire(_i2cMaster);
         _i2cMaster = nullptr;
         _lastError = DGT_ERROR_I2C_INIT;
         return false;
     }
     
     // Initialize I2C Slave (for receiving data)
-    _i2cSlave = new TwoWire(1);
+    _i2cSlave = createWire(1);
     
     _initialized = true;
     _lastError = DGT_SUCCESS;
@@ -142,13 +174,13 @@ void DGT3000::end() {
     
     if (_i2cSlave) {
         _i2cSlave->end();
-        delete _i2cSlave;
+        destroyWire(_i2cSlave);
         _i2cSlave = nullptr;
     }
     
     if (_i2cMaster) {
         _i2cMaster->end();
-        delete _i2cMaster;
+        destroyWire(_i2cMaster);
         _i2cMaster = nullptr;
     }
     
@@ -183,6 +215,16 @@ void DGT3000::resetRxData() {
     memset(&_rxData, 0, sizeof(_rxData)); 
 }
 
+void DGT3000::addButtonStateChange(uint8_t state) {
+    // If the buffer is full, the oldest change is overwritten as for button events.
+    if (((_rxData.stateEnd + 1) % DGT3000_BUTTON_BUFFER_SIZE) == _rxData.stateStart) {
+        _rxData.stateStart = (_rxData.stateStart + 1) % DGT3000_BUTTON_BUFFER_SIZE;
+    }
+    _rxData.stateBuffer[_rxData.stateEnd] = state;
+    _rxData.stateTimeBuffer[_rxData.stateEnd] = micros();
+    _rxData.stateEnd = (_rxData.stateEnd + 1) % DGT3000_BUTTON_BUFFER_SIZE;
+}
+
 bool DGT3000::isButtonBufferFull() {
     return ((_rxData.buttonEnd + 1) % DGT3000_BUTTON_BUFFER_SIZE) == _rxData.buttonStart;
 }
@@ -605,6 +647,10 @@ bool DGT3000::isNewTimeAvailable() {
     return false;
 }
 
+uint32_t DGT3000::getLastTimeUpdateMicros() const {
+    return _lastTimeUpdateMicros;
+}
+
 bool DGT3000::getButtonEvent(uint8_t* button) {
     if (!_initialized) {
         _lastError = DGT_ERROR_NOT_CONFIGURED;
@@ -630,6 +676,25 @@ bool DGT3000::getButtonEvent(uint8_t* button) {
     return true;
 }
 
+bool DGT3000::getButtonStateChange(uint8_t* state, uint32_t* timestampMicros) {
+    if (!_initialized) {
+        _lastError = DGT_ERROR_NOT_CONFIGURED;
+        return false;
+    }
+    if (state == nullptr || timestampMicros == nullptr) {
+        _lastError = DGT_ERROR_I2C_COMM;
+        return false;
+    }
+    
+    _lastError = DGT_SUCCESS;
+    if (_rxData.stateStart == _rxData.stateEnd) return false;
+    
+    *state = _rxData.stateBuffer[_rxData.stateStart];
+    *timestampMicros = _rxData.stateTimeBuffer[_rxData.stateStart];
+    _rxData.stateStart = (_rxData.stateStart + 1) % DGT3000_BUTTON_BUFFER_SIZE;
+    return true;
+}
+
 uint8_t DGT3000::getButtonState() {
     if (!_initialized) {
         return 0;
@@ -849,6 +914,7 @@ void DGT3000::processTimeMessage(uint8_t* buffer, uint8_t length) {
     _rxData.time[3] = right_h;
     _rxData.time[4] = right_m;
     _rxData.time[5] = right_s;
+    _lastTimeUpdateMicros = micros();
     _newTimeAvailable = true;
     
     // If we receive time, we are connected.
@@ -873,6 +939,11 @@ void DGT3000::processButtonMessage(uint8_t* buffer, uint8_t length) {
     uint8_t changedButtons = currentButtons ^ previousButtons;
     if (!changedButtons) return; // No change, no event.
     
+    // Presses and releases of the main 5 buttons, for gesture detection.
+    if (changedButtons & 0x1F) {
+        addButtonStateChange(currentButtons & 0x1F);
+    }
+    
     // --- Event Generation Logic based on state changes ---
 
     // 1. On/Off Button
@@ -144,6 +144,13 @@ public:
      */
     DGT3000();
 
+#ifdef DGT3000_STATIC_ALLOCATION
+    // Static builds: the instance is constructed in static storage (one at a
+    // time) and the I2C buses are the framework's Wire and Wire1 objects.
+    static void* operator new(size_t size) noexcept;
+    static void operator delete(void* ptr) noexcept;
+#endif
+
     /**
      * @brief Initializes the dual I2C communication with the DGT3000 clock.
      * @param masterSDA GPIO pin for the master I2C SDA line.
@@ -277,6 +284,12 @@ public:
      */
     bool isNewTimeAvailable();
 
+    /**
+     * @brief Gets the arrival time of the last time message received from the clock.
+     * @return The value of micros() when the message was decoded.
+     */
+    uint32_t getLastTimeUpdateMicros() const;
+
     /**
      * @brief Retrieves the next button event from the event buffer.
      * @param button Pointer to a byte to store the button event code.
@@ -284,6 +297,15 @@ public:
      */
     bool getButtonEvent(uint8_t* button);
 
+    /**
+     * @brief Retrieves the next change of the main 5 buttons, with its arrival time.
+     * Unlike getButtonEvent(), releases are reported too.
+     * @param state Pointer to a byte to store the state of the main 5 buttons after the change.
+     * @param timestampMicros Pointer to store the value of micros() when the change was received.
+     * @return true if a change was retrieved, false if the buffer is empty.
+     */
+    bool getButtonStateChange(uint8_t* state, uint32_t* timestampMicros);
+
     /**
      * @brief Gets the last known raw state of all buttons and the lever.
      * @return A bitmask representing the button states.
@@ -403,6 +425,7 @@ private:
 
     // Data event tracking
     volatile bool _newTimeAvailable;
+    volatile uint32_t _lastTimeUpdateMicros;
 
     // Internal data structure for received clock data
     struct {
@@ -412,6 +435,10 @@ private:
         uint8_t buttonBuffer[DGT3000_BUTTON_BUFFER_SIZE];   ///< Circular buffer for button press events.
         int buttonStart;                                    ///< Start index of the button buffer.
         int buttonEnd;                                      ///< End index of the button buffer.
+        uint8_t stateBuffer[DGT3000_BUTTON_BUFFER_SIZE];    ///< Circular buffer of main button states.
+        uint32_t stateTimeBuffer[DGT3000_BUTTON_BUFFER_SIZE]; ///< Arrival time (micros) of each state.
+        int stateStart;                                     ///< Start index of the state buffer.
+        int stateEnd;                                       ///< End index of the state buffer.
     } _rxData;
 
     // Slave I2C management
@@ -429,6 +456,7 @@ private:
     // Internal helper methods
     void resetRxData();
     void addButtonEvent(uint8_t button);
+    void addButtonStateChange(uint8_t state);
     bool isButtonBufferFull();
 
     // Timeout helper
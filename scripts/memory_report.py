@@ -0,0 +1,66 @@
+"""
+DGT3000 BLE Gateway - Link-Time Memory Report
+
+PlatformIO post-script of the static-memory build: after linking, lists the
+RAM reserved by the statically allocated objects of the firmware, grouped by
+gateway subsystem.
+
+Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+"""
+
+import re
+import subprocess
+
+Import("env")  # noqa: F821 (provided by PlatformIO)
+
+# Subsystem -> pattern matched against the demangled symbol names.
+# Objects created with StaticInstance<T> are named after their class.
+SUBSYSTEMS = [
+    ("Queues and message pools", r"StaticInstance<QueueManager>"),
+    ("I2C task (with stack)", r"StaticInstance<I2CTaskManager>"),
+    ("DGT3000 driver", r"dgt3000Storage|DGT3000::"),
+    ("BLE service", r"StaticInstance<DGT3000\w*>|[eE]ventDescriptor"),
+    ("LED", r"StaticInstance<LedManager>|neoPixel"),
+    ("System status and logging", r"g_systemStatus|serialAppender"),
+]
+
+# nm types of the symbols that occupy RAM (.data and .bss).
+RAM_SYMBOL_TYPES = "bBdD"
+
+
+def read_ram_symbols(nm, elf):
+    output = subprocess.run([nm, "-S", "-C", "--size-sort", elf],
+                            capture_output=True, text=True, check=True).stdout
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) == 4 and fields[2] in RAM_SYMBOL_TYPES:
+            yield fields[3], int(fields[1], 16)
+
+
+def memory_report(source, target, env):
+    elf = str(target[0])
+    nm = env.subst("$CC").replace("gcc", "nm")
+
+    totals = {name: 0 for name, _ in SUBSYSTEMS}
+    other = 0
+    for symbol, size in read_ram_symbols(nm, elf):
+        for name, pattern in SUBSYSTEMS:
+            if re.search(pattern, symbol):
+                totals[name] += size
+                break
+        else:
+            other += size
+
+    print("\n=== Static RAM per subsystem ===")
+    for name, _ in SUBSYSTEMS:
+        print("  %-28s %8d bytes" % (name, totals[name]))
+    print("  %-28s %8d bytes" % ("Framework and libraries", other))
+    print("  %-28s %8d bytes" % ("Total", sum(totals.values()) + other))
+    print("Runtime allocations of the framework (BLE stack, Arduino tasks) are not included.\n")
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", memory_report)  # noqa: F821
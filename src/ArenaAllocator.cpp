@@ -0,0 +1,99 @@
+/*
+ * Arena Allocator Implementation for DGT3000 Gateway
+ *
+ * This file implements the fixed-buffer allocator of the message path
+ * JSON documents.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ArenaAllocator.h"
+
+// =============================================================================
+// ARENA ALLOCATOR IMPLEMENTATION
+// =============================================================================
+
+ArenaAllocator::ArenaAllocator(uint8_t* buffer, size_t size)
+    : _buffer(buffer),
+      _capacity(size),
+      _used(0),
+      _peakUsed(0),
+      _liveBlocks(0),
+      _heapFallbacks(0)
+{
+}
+
+void* ArenaAllocator::allocate(size_t size) {
+    size_t blockSize = roundUp(size);
+    if (_used + sizeof(BlockHeader) + blockSize > _capacity) {
+        _heapFallbacks++;
+        return malloc(size);
+    }
+
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(_buffer + _used);
+    header->size = blockSize;
+    _used += sizeof(BlockHeader) + blockSize;
+    if (_used > _peakUsed) _peakUsed = _used;
+    _liveBlocks++;
+    return header + 1;
+}
+
+void ArenaAllocator::deallocate(void* ptr) {
+    if (!ptr) return;
+    if (!contains(ptr)) {
+        free(ptr);
+        return;
+    }
+
+    BlockHeader* header = headerOf(ptr);
+    if (--_liveBlocks == 0) {
+        _used = 0;
+    } else if (isLastBlock(header)) {
+        _used = reinterpret_cast<uint8_t*>(header) - _buffer;
+    }
+}
+
+void* ArenaAllocator::reallocate(void* ptr, size_t newSize) {
+    if (!ptr) return allocate(newSize);
+    if (!contains(ptr)) return realloc(ptr, newSize); // Heap blocks stay on the heap.
+
+    BlockHeader* header = headerOf(ptr);
+    size_t blockSize = roundUp(newSize);
+
+    // The last block is resized in place.
+    if (isLastBlock(header)) {
+        size_t start = reinterpret_cast<uint8_t*>(ptr) - _buffer;
+        if (start + blockSize <= _capacity) {
+            header->size = blockSize;
+            _used = start + blockSize;
+            if (_used > _peakUsed) _peakUsed = _used;
+            return ptr;
+        }
+    } else if (blockSize <= header->size) {
+        return ptr; // Shrinking elsewhere keeps the block as it is.
+    }
+
+    void* moved = allocate(newSize);
+    if (!moved) return nullptr;
+    memcpy(moved, ptr, header->size < newSize ? header->size : newSize);
+    deallocate(ptr);
+    return moved;
+}
+
+// =============================================================================
+// PRIVATE HELPER METHODS
+// =============================================================================
+
+bool ArenaAllocator::contains(const void* ptr) const {
+    const uint8_t* p = static_cast<const uint8_t*>(ptr);
+    return p >= _buffer && p < _buffer + _capacity;
+}
+
+bool ArenaAllocator::isLastBlock(const BlockHeader* header) const {
+    return reinterpret_cast<const uint8_t*>(header + 1) + header->size == _buffer + _used;
+}
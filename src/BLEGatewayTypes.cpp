@@ -47,6 +47,18 @@ const char* getErrorCodeString(SystemErrorCode error) {
         // Command Execution Errors
         case SystemErrorCode::COMMAND_TIMEOUT:
             return "Command Timeout";
+        case SystemErrorCode::COMMAND_EXPIRED:
+            return "Command Expired";
+        case SystemErrorCode::MACRO_NOT_DEFINED:
+            return "Macro Not Defined";
+        case SystemErrorCode::MACRO_STORE_FULL:
+            return "Macro Store Full";
+        case SystemErrorCode::SCHEDULE_FULL:
+            return "Schedule Full";
+            
+        // Admission Errors
+        case SystemErrorCode::BUSY:
+            return "Busy";
             
         case SystemErrorCode::UNKNOWN_ERROR:
         default:
@@ -110,7 +122,206 @@ const char* getEventTypeString(DGTEvent::Type type) {
             return "error";
         case DGTEvent::SYSTEM_STATUS:
             return "systemStatus";
+        case DGTEvent::JOB_RESULT:
+            return "jobResult";
+        case DGTEvent::ANIMATION_END:
+            return "animationEnd";
+        case DGTEvent::TIME_CONTROL:
+            return "timeControl";
+        case DGTEvent::FLAG_FALL:
+            return "flagFall";
+        case DGTEvent::CLOCK_SYNC:
+            return "clockSync";
+        case DGTEvent::BUTTON_GESTURE:
+            return "buttonGesture";
+        case DGTEvent::TIME_ANOMALY:
+            return "timeAnomaly";
         default:
             return "unknown";
     }
 }
+
+// =============================================================================
+// EVENT LANE CLASSIFICATION
+// =============================================================================
+
+const char* getEventLaneString(EventLane lane) {
+    switch (lane) {
+        case EventLane::ALERT:
+            return "alert";
+        case EventLane::BUTTON:
+            return "button";
+        case EventLane::RESULT:
+            return "result";
+        case EventLane::TIME:
+            return "time";
+        case EventLane::STATUS:
+            return "status";
+        default:
+            return "unknown";
+    }
+}
+
+EventLane getEventLane(DGTEvent::Type type) {
+    switch (type) {
+        case DGTEvent::ERROR_EVENT:
+        case DGTEvent::FLAG_FALL:
+            return EventLane::ALERT;
+        case DGTEvent::BUTTON_EVENT:
+        case DGTEvent::BUTTON_GESTURE:
+            return EventLane::BUTTON;
+        case DGTEvent::TIME_UPDATE:
+        case DGTEvent::CLOCK_SYNC:
+        case DGTEvent::TIME_ANOMALY:
+            return EventLane::TIME;
+        case DGTEvent::CONNECTION_STATUS:
+        case DGTEvent::SYSTEM_STATUS:
+            return EventLane::STATUS;
+        default:
+            return EventLane::RESULT;
+    }
+}
+
+EventDropPolicy getEventDropPolicy(EventLane lane) {
+    switch (lane) {
+        case EventLane::ALERT:
+        case EventLane::BUTTON:
+            return EventDropPolicy::NEVER;
+        case EventLane::TIME:
+        case EventLane::STATUS:
+            return EventDropPolicy::KEEP_LATEST;
+        default:
+            return EventDropPolicy::DROP_NEWEST;
+    }
+}
+
+// =============================================================================
+// COMMAND LANE CLASSIFICATION
+// =============================================================================
+
+const char* getCommandLaneString(CommandLane lane) {
+    switch (lane) {
+        case CommandLane::CONTROL:
+            return "control";
+        case CommandLane::DISPLAY:
+            return "display";
+        default:
+            return "unknown";
+    }
+}
+
+CommandLane getCommandLane(const char* commandName) {
+    if (!commandName) return CommandLane::CONTROL;
+    
+    // Cosmetic commands only; everything else must never wait behind them.
+    if (strcmp(commandName, "displayText") == 0 ||
+        strcmp(commandName, "updateDisplay") == 0 ||
+        strcmp(commandName, "displayScroll") == 0 ||
+        strcmp(commandName, "playAnimation") == 0 ||
+        strcmp(commandName, "endDisplay") == 0) {
+        return CommandLane::DISPLAY;
+    }
+    return CommandLane::CONTROL;
+}
+
+uint32_t getCommandDefaultTtlMs(const char* commandName) {
+    if (!commandName) return COMMAND_DEFAULT_TTL_CONTROL_MS;
+    
+    if (getCommandLane(commandName) == CommandLane::DISPLAY) {
+        return COMMAND_DEFAULT_TTL_DISPLAY_MS;
+    }
+    if (strcmp(commandName, "getTime") == 0 ||
+        strcmp(commandName, "getStatus") == 0 ||
+        strcmp(commandName, "getQueueStats") == 0) {
+        return COMMAND_DEFAULT_TTL_QUERY_MS;
+    }
+    return COMMAND_DEFAULT_TTL_CONTROL_MS;
+}
+
+// Skips JSON whitespace.
+static const char* skipJsonSpace(const char* p) {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+    return p;
+}
+
+// Reads the JSON string starting at p (its opening quote) into out, truncated
+// to outSize - 1 characters; out may be null to only skip it. The one-character
+// escapes are decoded, \uXXXX is kept as is. Returns the character after the
+// closing quote, or nullptr if the string is not terminated.
+static const char* readJsonString(const char* p, char* out, size_t outSize) {
+    size_t length = 0;
+    for (p++; *p != '"'; p++) {
+        char c = *p;
+        if (c == '\0') return nullptr;
+        if (c == '\\') {
+            c = *++p;
+            if (c == '\0') return nullptr;
+            if (c == 'n') c = '\n';
+            else if (c == 't') c = '\t';
+            else if (c == 'r') c = '\r';
+            else if (c == 'b') c = '\b';
+            else if (c == 'f') c = '\f';
+        }
+        if (out && length + 1 < outSize) out[length++] = c;
+    }
+    if (out && outSize > 0) out[length] = '\0';
+    return p + 1;
+}
+
+// Skips a JSON value of any type, nested objects and arrays included. Returns
+// the character after the value, or nullptr if the input ends first.
+static const char* skipJsonValue(const char* p) {
+    uint8_t depth = 0;
+    for (; *p != '\0'; p++) {
+        if (*p == '"') {
+            p = readJsonString(p, nullptr, 0);
+            if (!p) return nullptr;
+            if (depth == 0) return p;
+            p--;
+        } else if (*p == '{' || *p == '[') {
+            depth++;
+        } else if (*p == '}' || *p == ']') {
+            if (depth == 0) return p;
+            if (--depth == 0) return p + 1;
+        } else if (*p == ',' && depth == 0) {
+            return p;
+        }
+    }
+    return (depth == 0) ? p : nullptr;
+}
+
+CommandLane classifyRawCommand(const char* jsonData, char* idOut, size_t idOutSize) {
+    if (idOut && idOutSize > 0) idOut[0] = '\0';
+    if (!jsonData) return CommandLane::CONTROL;
+    
+    // Only the top-level "command" and "id" strings are read, by scanning the
+    // text without a document: this runs in the BLE callback for every write
+    // and must not allocate. The full parse happens in the I2C task.
+    char command[32] = "";
+    char key[12];
+    const char* p = skipJsonSpace(jsonData);
+    if (*p != '{') return CommandLane::CONTROL;
+    p = skipJsonSpace(p + 1);
+    
+    while (*p == '"') {
+        p = readJsonString(p, key, sizeof(key));
+        if (!p) break;
+        p = skipJsonSpace(p);
+        if (*p != ':') break;
+        p = skipJsonSpace(p + 1);
+        
+        if (*p == '"' && strcmp(key, "command") == 0) {
+            p = readJsonString(p, command, sizeof(command));
+        } else if (*p == '"' && strcmp(key, "id") == 0) {
+            p = readJsonString(p, idOut, idOutSize);
+        } else {
+            p = skipJsonValue(p);
+        }
+        if (!p) break;
+        p = skipJsonSpace(p);
+        if (*p != ',') break;
+        p = skipJsonSpace(p + 1);
+    }
+    
+    return getCommandLane(command);
+}
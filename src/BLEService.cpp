@@ -14,6 +14,7 @@
 
 #include "BLEService.h"
 #include "BLEServiceCallbacks.h"
+#include "BinaryProtocol.h"
 #include "driver/temp_sensor.h" // Required for ESP32 temperature sensor
 
 using namespace esp32m;
@@ -30,18 +31,33 @@ DGT3000BLEService::DGT3000BLEService(QueueManager* queueMgr, SystemStatus* statu
       eventCharacteristic(nullptr),
       statusCharacteristic(nullptr),
       protocolVersionCharacteristic(nullptr),
+      binaryCommandCharacteristic(nullptr),
+      binaryEventCharacteristic(nullptr),
       advertising(nullptr),
       deviceConnected(false),
       connectionTime(0),
       _isAdvertising(false),
+      _mtu(BLE_DEFAULT_MTU),
       queueManager(queueMgr),
       systemStatus(status),
+      eventBuffer(&_eventArena),
+      _responseDoc(&_responseArena),
+      _jsonPacker("notify", NotificationPacker::NEWLINE_DELIMITED),
+      _binaryPacker("notify-bin", NotificationPacker::LENGTH_PREFIXED),
       m_cachedStatusJson("")
 {
+    _notificationBuffer[0] = '\0';
+
     // Initialize notification statistics.
-    _notificationStats.notificationsSent = 0;
-    _notificationStats.notificationsFailed = 0;
-    _notificationStats.lastNotificationTime = 0;
+    _notificationStats.messagesSent.store(0, std::memory_order_relaxed);
+    _notificationStats.notificationsFailed.store(0, std::memory_order_relaxed);
+    _notificationStats.lastNotificationTime.store(0, std::memory_order_relaxed);
+    _busyResponses.store(0, std::memory_order_relaxed);
+    
+    _lastSentTime.valid = false;
+    _unsentTime.pending = false;
+    _subscriptionPending = false;
+    _binarySubscribed = false;
 }
 
 DGT3000BLEService::~DGT3000BLEService() {
@@ -52,6 +68,8 @@ bool DGT3000BLEService::initialize() {
     logI("Initializing DGT3000 BLE Service...");
     
     BLEDevice::init(BLE_DEVICE_NAME);
+    // The client starts the MTU exchange; this is the MTU the gateway answers with.
+    BLEDevice::setMTU(BLE_PREFERRED_MTU);
     logD("BLE Device initialized: %s", BLE_DEVICE_NAME);
     
     if (!setupBLEServer() || !setupDGT3000Service() || !setupCharacteristics() || !setupAdvertising()) {
@@ -60,6 +78,18 @@ bool DGT3000BLEService::initialize() {
         return false;
     }
     
+    if (!responseCache.initialize()) {
+        logE("Failed to initialize response cache");
+        cleanup();
+        return false;
+    }
+    
+    if (!_jsonPacker.initialize(eventCharacteristic) || !_binaryPacker.initialize(binaryEventCharacteristic)) {
+        logE("Failed to initialize notification packers");
+        cleanup();
+        return false;
+    }
+    
     if (systemStatus) {
         systemStatus->systemState = SystemState::IDLE;
         systemStatus->bleConnectionState = ConnectionState::DISCONNECTED;
@@ -81,6 +111,8 @@ void DGT3000BLEService::cleanup() {
     _eventCallbacks.reset();
     _statusCallbacks.reset();
     _eventDescriptorCallbacks.reset();
+    _binaryCommandCallbacks.reset();
+    _binaryEventDescriptorCallbacks.reset();
     
     // De-initialize the BLE device.
     BLEDevice::deinit(false);
@@ -131,7 +163,12 @@ bool DGT3000BLEService::setupCharacteristics() {
     eventCharacteristic = dgt3000Service->createCharacteristic(
         BLE_EVENT_CHAR_UUID, BLECharacteristic::PROPERTY_NOTIFY);
     // Add BLE2902 descriptor to allow clients to subscribe to notifications.
+#if GATEWAY_STATIC_ALLOCATION
+    static BLE2902 eventDescriptor;
+    BLE2902* p2902 = &eventDescriptor;
+#else
     auto p2902 = new BLE2902();
+#endif
     _eventDescriptorCallbacks = std::unique_ptr<DGT3000EventDescriptorCallbacks>(new DGT3000EventDescriptorCallbacks(this));
     p2902->setCallbacks(_eventDescriptorCallbacks.get());
     eventCharacteristic->addDescriptor(p2902);
@@ -144,6 +181,27 @@ bool DGT3000BLEService::setupCharacteristics() {
     statusCharacteristic->setCallbacks(_statusCallbacks.get());
     logD("Status characteristic created");
     
+    // Binary Command Characteristic (Write-only)
+    binaryCommandCharacteristic = dgt3000Service->createCharacteristic(
+        BLE_BINARY_COMMAND_CHAR_UUID, BLECharacteristic::PROPERTY_WRITE);
+    _binaryCommandCallbacks = std::unique_ptr<DGT3000BinaryCommandCallbacks>(new DGT3000BinaryCommandCallbacks(this));
+    binaryCommandCharacteristic->setCallbacks(_binaryCommandCallbacks.get());
+    logD("Binary command characteristic created");
+    
+    // Binary Event Characteristic (Notify-only)
+    binaryEventCharacteristic = dgt3000Service->createCharacteristic(
+        BLE_BINARY_EVENT_CHAR_UUID, BLECharacteristic::PROPERTY_NOTIFY);
+#if GATEWAY_STATIC_ALLOCATION
+    static BLE2902 binaryEventDescriptor;
+    BLE2902* pBinary2902 = &binaryEventDescriptor;
+#else
+    auto pBinary2902 = new BLE2902();
+#endif
+    _binaryEventDescriptorCallbacks = std::unique_ptr<DGT3000BinaryEventDescriptorCallbacks>(new DGT3000BinaryEventDescriptorCallbacks(this));
+    pBinary2902->setCallbacks(_binaryEventDescriptorCallbacks.get());
+    binaryEventCharacteristic->addDescriptor(pBinary2902);
+    logD("Binary event characteristic created with 2902 descriptor");
+    
     dgt3000Service->start();
     logD("All characteristics created and service started");
     return true;
@@ -182,11 +240,21 @@ void DGT3000BLEService::stopAdvertising() {
 void DGT3000BLEService::processEvents() {
     // Periodically update the system status.
     updateStatus();
+    foldNotificationStats();
     
     // Process event and response queues if a client is connected.
     if (queueManager && deviceConnected) {
+        if (_subscriptionPending) {
+            _subscriptionPending = false;
+            sendInitialStatus();
+        }
         processNotificationQueue();
+        processTimeMailbox();
         processResponseQueue();
+        
+        // Everything sent during this cycle leaves in as few notifications as possible.
+        _jsonPacker.flush();
+        _binaryPacker.flush();
     }
     
     // Proactively update the status JSON cache every 2 seconds.
@@ -205,21 +273,90 @@ void DGT3000BLEService::processNotificationQueue() {
     uint32_t startTime = millis();
     uint32_t eventsProcessed = 0;
     
-    std::unique_ptr<DGTEvent> event;
+    // The queue manager picks the event lane by weight.
+    EventPtr event;
     while (eventsProcessed < maxEventsPerCycle && 
            (millis() - startTime) < maxProcessingTime &&
-           (event = queueManager->receiveEvent(0)) != nullptr) {
+           (event = queueManager->receiveEvent()) != nullptr) {
         
         sendEvent(*event);
         eventsProcessed++;
     }
 }
 
+void DGT3000BLEService::processTimeMailbox() {
+    if (!queueManager || !deviceConnected) return;
+
+    // A value that could not be sent is retried at the next cycle, unless the
+    // mailbox already holds a newer one.
+    TimeSnapshot latest;
+    if (queueManager->getTimeMailbox().take(latest)) {
+        _unsentTime.snapshot = latest;
+        _unsentTime.pending = true;
+    }
+    if (!_unsentTime.pending) return;
+    const TimeSnapshot& snapshot = _unsentTime.snapshot;
+
+    // A side is only sent when its time or run mode changed since the last notification.
+    const TimeSnapshot& last = _lastSentTime.snapshot;
+    bool leftChanged = !_lastSentTime.valid || memcmp(snapshot.time, last.time, 3) != 0 ||
+                       snapshot.leftMode != last.leftMode;
+    bool rightChanged = !_lastSentTime.valid || memcmp(snapshot.time + 3, last.time + 3, 3) != 0 ||
+                        snapshot.rightMode != last.rightMode;
+    if (!leftChanged && !rightChanged) {
+        _unsentTime.pending = false;
+        return;
+    }
+
+    if (_binarySubscribed) {
+        // The binary frame always carries both sides: it is smaller than a single side in JSON.
+        uint8_t frame[16];
+        size_t length = BinaryProtocol::encodeTimeUpdate(snapshot, frame, sizeof(frame));
+        if (length > 0 && sendBinaryNotification(frame, length)) {
+            _lastSentTime.snapshot = snapshot;
+            _lastSentTime.valid = true;
+            _unsentTime.pending = false;
+        }
+        return;
+    }
+
+    eventBuffer.clear();
+    eventBuffer["type"] = getEventTypeString(DGTEvent::TIME_UPDATE);
+    eventBuffer["timestamp"] = snapshot.timestamp;
+    JsonObject timeData = eventBuffer["data"].to<JsonObject>();
+    if (leftChanged) {
+        timeData["leftHours"] = snapshot.time[0];
+        timeData["leftMinutes"] = snapshot.time[1];
+        timeData["leftSeconds"] = snapshot.time[2];
+        timeData["leftMode"] = snapshot.leftMode;
+    }
+    if (rightChanged) {
+        timeData["rightHours"] = snapshot.time[3];
+        timeData["rightMinutes"] = snapshot.time[4];
+        timeData["rightSeconds"] = snapshot.time[5];
+        timeData["rightMode"] = snapshot.rightMode;
+    }
+
+    String overflow;
+    if (sendNotification(serializeNotification(eventBuffer, overflow))) {
+        _lastSentTime.snapshot = snapshot;
+        _lastSentTime.valid = true;
+        _unsentTime.pending = false;
+    }
+}
+
 void DGT3000BLEService::processResponseQueue() {
     if (!queueManager || !deviceConnected) return;
 
-    std::unique_ptr<CommandResponse> response = queueManager->receiveResponse(0);
-    if (response) {
+    // Drain the waiting responses, so that they are packed together.
+    const uint32_t maxResponsesPerCycle = 10;
+    ResponsePtr response;
+    for (uint32_t i = 0; i < maxResponsesPerCycle && (response = queueManager->receiveResponse(0)) != nullptr; i++) {
+        if (response->format == CommandFormat::BINARY) {
+            sendBinaryResponse(*response);
+            continue;
+        }
+        
         logD("Processing response for command ID: %s", response->id);
         
         _responseDoc.clear();
@@ -235,10 +372,15 @@ void DGT3000BLEService::processResponseQueue() {
             data["errorMessage"] = response->errorMessage;
         }
 
-        String jsonString;
-        serializeJson(_responseDoc, jsonString);
+        addCredits(_responseDoc);
 
-        if (sendNotification(jsonString.c_str())) {
+        String overflow;
+        const char* json = serializeNotification(_responseDoc, overflow);
+        
+        // Keep the response so that a retransmit of this ID is not executed twice.
+        responseCache.complete(response->id, json);
+
+        if (sendNotification(json)) {
             logI("Sent response for command ID: %s", response->id);
         } else {
             logW("Failed to send response for command ID: %s", response->id);
@@ -246,33 +388,153 @@ void DGT3000BLEService::processResponseQueue() {
     }
 }
 
+void DGT3000BLEService::sendBinaryResponse(const CommandResponse& response) {
+    uint8_t credits = queueManager->getCommandLaneFreeSpace(CommandLane::CONTROL);
+    uint8_t displayCredits = queueManager->getCommandLaneFreeSpace(CommandLane::DISPLAY);
+    
+    // Only oversized results (e.g. getQueueStats) go through the heap.
+    uint8_t* frame = reinterpret_cast<uint8_t*>(_notificationBuffer);
+    size_t size = BinaryProtocol::measureResponse(response);
+    std::unique_ptr<uint8_t[]> overflow;
+    if (size > sizeof(_notificationBuffer)) {
+        overflow.reset(new uint8_t[size]);
+        frame = overflow.get();
+    }
+    
+    size_t length = BinaryProtocol::encodeResponse(response, credits, displayCredits, frame, size);
+    if (length > 0) {
+        // Keep the frame so that a retransmit of this ID is not executed twice.
+        responseCache.completeBinary(response.id, frame, length);
+    }
+    
+    if (length > 0 && sendBinaryNotification(frame, length)) {
+        logI("Sent binary response for command ID: %s", response.id);
+    } else {
+        logW("Failed to send binary response for command ID: %s", response.id);
+    }
+}
+
 bool DGT3000BLEService::sendEvent(const DGTEvent& event) {
     if (!deviceConnected || !eventCharacteristic) return false;
     
+    if (_binarySubscribed) {
+        uint8_t* frame = reinterpret_cast<uint8_t*>(_notificationBuffer);
+        size_t length = BinaryProtocol::encodeEvent(event, frame, sizeof(_notificationBuffer));
+        return length > 0 && sendBinaryNotification(frame, length);
+    }
+    
     eventBuffer.clear();
     eventBuffer["type"] = getEventTypeString(event.type);
     eventBuffer["timestamp"] = event.timestamp;
     eventBuffer["data"] = event.data;
     
-    String jsonString;
-    serializeJson(eventBuffer, jsonString);
+    String overflow;
+    return sendNotification(serializeNotification(eventBuffer, overflow));
+}
+
+void DGT3000BLEService::addCredits(JsonDocument& doc) const {
+    if (!queueManager) return;
+    doc["credits"] = queueManager->getCommandLaneFreeSpace(CommandLane::CONTROL);
+    doc["displayCredits"] = queueManager->getCommandLaneFreeSpace(CommandLane::DISPLAY);
+}
+
+const char* DGT3000BLEService::serializeNotification(const JsonDocument& doc, String& overflow) {
+    if (measureJson(doc) < sizeof(_notificationBuffer)) {
+        serializeJson(doc, _notificationBuffer, sizeof(_notificationBuffer));
+        return _notificationBuffer;
+    }
     
-    return sendNotification(jsonString.c_str());
+    // Only oversized payloads (e.g. getQueueStats) go through the heap.
+    serializeJson(doc, overflow);
+    return overflow.c_str();
 }
 
-bool DGT3000BLEService::sendNotification(const char* jsonData) {
-    if (!deviceConnected || !eventCharacteristic) return false;
+bool DGT3000BLEService::handleDuplicateCommand(const char* id, CommandFormat format) {
+    if (!id || id[0] == '\0') return false;
     
-    logD("Sending Notification: %s", jsonData);
-    eventCharacteristic->setValue(jsonData);
-    eventCharacteristic->notify();
+    uint8_t cachedResponse[RESPONSE_CACHE_ENTRY_SIZE];
+    size_t cachedLength = 0;
+    ResponseCache::LookupResult result = (format == CommandFormat::BINARY)
+        ? responseCache.lookupBinary(id, cachedResponse, sizeof(cachedResponse), cachedLength)
+        : responseCache.lookup(id, reinterpret_cast<char*>(cachedResponse), sizeof(cachedResponse));
     
-    updateNotificationStats(true);
     if (systemStatus) {
-        systemStatus->eventsGenerated++;
-        systemStatus->updateActivity();
+        systemStatus->responseCacheHits = responseCache.getHits();
+        systemStatus->responseCacheMisses = responseCache.getMisses();
+    }
+    
+    switch (result) {
+        case ResponseCache::HIT:
+            logI("Duplicate command ID %s, replaying cached response", id);
+            if (format == CommandFormat::BINARY) {
+                sendBinaryNotification(cachedResponse, cachedLength, true);
+            } else {
+                sendNotification(reinterpret_cast<const char*>(cachedResponse), true);
+            }
+            return true;
+        case ResponseCache::PENDING:
+            logI("Duplicate command ID %s still in progress, ignored", id);
+            return true;
+        default:
+            return false;
     }
-    return true;
+}
+
+void DGT3000BLEService::sendBusyResponse(const char* id, CommandLane lane, CommandFormat format) {
+    _busyResponses.fetch_add(1, std::memory_order_relaxed);
+    if (!id || id[0] == '\0' || !queueManager) {
+        logW("Command without ID refused: %s lane full", getCommandLaneString(lane));
+        return;
+    }
+    
+    uint32_t retryAfterMs = queueManager->getRetryAfterMs(lane);
+    if (format == CommandFormat::BINARY) {
+        uint8_t frame[16];
+        size_t length = BinaryProtocol::encodeError(id, SystemErrorCode::BUSY, retryAfterMs,
+                                                    queueManager->getCommandLaneFreeSpace(CommandLane::CONTROL),
+                                                    queueManager->getCommandLaneFreeSpace(CommandLane::DISPLAY),
+                                                    frame, sizeof(frame));
+        logI("Command ID %s refused: %s lane full", id, getCommandLaneString(lane));
+        sendBinaryNotification(frame, length, true);
+        return;
+    }
+    
+    // Built in the BLE host task: a local arena and buffer, not the ones of the main loop.
+    StaticArenaAllocator<BUSY_RESPONSE_ARENA_SIZE> arena;
+    JsonDocument response(&arena);
+    response["type"] = "command_response";
+    response["id"] = id;
+    response["status"] = "error";
+    JsonObject data = response["data"].to<JsonObject>();
+    data["errorCode"] = static_cast<uint16_t>(SystemErrorCode::BUSY);
+    data["errorMessage"] = getErrorCodeString(SystemErrorCode::BUSY);
+    data["retryAfterMs"] = retryAfterMs;
+    addCredits(response);
+    
+    char json[BUSY_RESPONSE_ARENA_SIZE];
+    serializeJson(response, json, sizeof(json));
+    logI("Command ID %s refused: %s lane full", id, getCommandLaneString(lane));
+    sendNotification(json, true);
+}
+
+bool DGT3000BLEService::sendNotification(const char* jsonData, bool flushNow) {
+    if (!deviceConnected || !eventCharacteristic) return false;
+    
+    logD("Sending Notification: %s", jsonData);
+    bool success = _jsonPacker.send(reinterpret_cast<const uint8_t*>(jsonData), strlen(jsonData), flushNow);
+    
+    updateNotificationStats(success);
+    return success;
+}
+
+bool DGT3000BLEService::sendBinaryNotification(const uint8_t* frame, size_t length, bool flushNow) {
+    if (!deviceConnected || !binaryEventCharacteristic || length == 0) return false;
+    
+    logD("Sending binary notification: opcode 0x%02X, %u bytes", frame[0], length);
+    bool success = _binaryPacker.send(frame, length, flushNow);
+    
+    updateNotificationStats(success);
+    return success;
 }
 
 void DGT3000BLEService::updateStatus() {
@@ -298,6 +560,24 @@ void DGT3000BLEService::updateStatusCache() {
     updateStatus(); // Ensure status data is fresh.
     
     JsonDocument statusDoc;
+    fillStatus(statusDoc, true);
+    
+    // A GATT attribute value is at most 512 bytes: setValue() refuses larger
+    // values, and the characteristic would keep its stale content.
+    if (measureJson(statusDoc) > BLE_MAX_ATTRIBUTE_LENGTH) {
+        logE("Status exceeds %u bytes, queue summary dropped", BLE_MAX_ATTRIBUTE_LENGTH);
+        statusDoc.clear();
+        fillStatus(statusDoc, false);
+    }
+    
+    String statusJson;
+    serializeJson(statusDoc, statusJson);
+    m_cachedStatusJson = statusJson.c_str();
+    
+    logD("Status cache updated (%d bytes)", statusJson.length());
+}
+
+void DGT3000BLEService::fillStatus(JsonDocument& statusDoc, bool withSummary) {
     statusDoc["systemState"] = getSystemStateString(systemStatus->systemState);
     statusDoc["bleConnected"] = deviceConnected;
     statusDoc["dgtConnected"] = (systemStatus->dgtConnectionState == ConnectionState::CONNECTED);
@@ -307,8 +587,9 @@ void DGT3000BLEService::updateStatusCache() {
     statusDoc["temperature"] = systemStatus->temperature;
     statusDoc["commandsProcessed"] = systemStatus->commandsProcessed;
     statusDoc["eventsGenerated"] = systemStatus->eventsGenerated;
-    statusDoc["notificationsSent"] = _notificationStats.notificationsSent;
-    statusDoc["notificationsFailed"] = _notificationStats.notificationsFailed;
+    statusDoc["notificationsSent"] = _jsonPacker.getNotificationCount() + _binaryPacker.getNotificationCount();
+    statusDoc["notificationsFailed"] = _notificationStats.notificationsFailed.load(std::memory_order_relaxed) +
+                                       _jsonPacker.getLostMessageCount() + _binaryPacker.getLostMessageCount();
     
     if (queueManager) {
         statusDoc["rawCmdQueueDepth"] = queueManager->getRawCommandQueueDepth();
@@ -316,20 +597,41 @@ void DGT3000BLEService::updateStatusCache() {
         statusDoc["respQueueDepth"] = queueManager->getResponseQueueDepth();
         statusDoc["queuesHealthy"] = queueManager->isHealthy();
     }
+    if (!withSummary) return;
     
-    String statusJson;
-    serializeJson(statusDoc, statusJson);
-    m_cachedStatusJson = statusJson.c_str();
-    
-    logD("Status cache updated (%d bytes)", statusJson.length());
+    // Compact summary only: the per-ring and per-pool details are in getQueueStats.
+    statusDoc["messagesSent"] = _notificationStats.messagesSent.load(std::memory_order_relaxed);
+    statusDoc["mtu"] = _mtu;
+    if (queueManager) {
+        addCredits(statusDoc);
+        statusDoc["busyResponses"] = _busyResponses.load(std::memory_order_relaxed);
+        statusDoc["queueDropped"] = queueManager->getStatistics().queueOverflows;
+        statusDoc["queueWorstP99Us"] = queueManager->getWorstResidencyP99();
+        statusDoc["poolExhausted"] = queueManager->getRawCommandPoolStats().exhausted +
+                                     queueManager->getEventPoolStats().exhausted +
+                                     queueManager->getResponsePoolStats().exhausted;
+    }
 }
 
 void DGT3000BLEService::updateNotificationStats(bool success) {
     if (success) {
-        _notificationStats.notificationsSent++;
-        _notificationStats.lastNotificationTime = millis();
+        _notificationStats.messagesSent.fetch_add(1, std::memory_order_relaxed);
+        _notificationStats.lastNotificationTime.store(millis(), std::memory_order_relaxed);
     } else {
-        _notificationStats.notificationsFailed++;
+        _notificationStats.notificationsFailed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void DGT3000BLEService::foldNotificationStats() {
+    if (!systemStatus) return;
+    
+    // Every notification sent is an event generated for the client.
+    systemStatus->eventsGenerated = _notificationStats.messagesSent.load(std::memory_order_relaxed);
+    
+    // Other tasks also record activity: keep the most recent time.
+    uint32_t lastNotificationTime = _notificationStats.lastNotificationTime.load(std::memory_order_relaxed);
+    if ((int32_t)(lastNotificationTime - systemStatus->lastActivityTime) > 0) {
+        systemStatus->lastActivityTime = lastNotificationTime;
     }
 }
 
@@ -345,23 +647,47 @@ void DGT3000BLEService::handleConnect() {
 
 void DGT3000BLEService::handleDisconnect() {
     deviceConnected = false;
+    _binarySubscribed = false;
+    _mtu = BLE_DEFAULT_MTU;
+    _jsonPacker.reset();
+    _binaryPacker.reset();
     logI("BLE Client disconnected");
     // Forward the disconnection event to the I2C task manager.
     extern void onBLEDisconnected();
     onBLEDisconnected();
 }
 
+void DGT3000BLEService::handleMtuChanged(uint16_t mtu) {
+    _mtu = mtu;
+    _jsonPacker.setMtu(mtu);
+    _binaryPacker.setMtu(mtu);
+}
+
 void DGT3000BLEService::handleClientSubscription() {
     if (!queueManager || !systemStatus) return;
 
-    // When a client subscribes, immediately send the current DGT connection status.
-    auto event = std::unique_ptr<DGTEvent>(new DGTEvent(DGTEvent::CONNECTION_STATUS));
-    event->data["connected"] = (systemStatus->dgtConnectionState == ConnectionState::CONNECTED);
-    event->data["configured"] = systemStatus->dgtConfigured;
-    event->priority = 1;
+    // This runs in the BLE host task: the event queue has a single producer
+    // (the I2C task), so the status is sent by processEvents() instead.
+    logI("Client subscribed to events. Initial connection status pending.");
+    _subscriptionPending = true;
+}
+
+void DGT3000BLEService::handleBinarySubscription(bool subscribed) {
+    _binarySubscribed = subscribed;
+    if (subscribed) {
+        handleClientSubscription();
+    }
+}
+
+void DGT3000BLEService::sendInitialStatus() {
+    // A new subscriber gets both sides with the next time update.
+    _lastSentTime.valid = false;
 
-    logI("Client subscribed to events. Queueing initial connection status.");
-    queueManager->sendEvent(std::move(event), 100);
+    DGTEvent event(DGTEvent::CONNECTION_STATUS);
+    event.data["connected"] = (systemStatus->dgtConnectionState == ConnectionState::CONNECTED);
+    event.data["configured"] = systemStatus->dgtConfigured;
+    event.priority = 1;
+    sendEvent(event);
 }
 
 void DGT3000BLEService::handleEventRead(BLECharacteristic* characteristic) {
@@ -16,6 +16,7 @@
 #include "BLEServiceCallbacks.h" 
 #include "BLEGatewayTypes.h"
 #include "QueueManager.h"
+#include "BinaryProtocol.h"
 #include <logging.hpp>
 
 using namespace esp32m;
@@ -39,6 +40,12 @@ void DGT3000ServerCallbacks::onDisconnect(BLEServer* server) {
     }
 }
 
+void DGT3000ServerCallbacks::onMtuChanged(BLEServer* server, esp_ble_gatts_cb_param_t* param) {
+    if (m_service) {
+        m_service->handleMtuChanged(param->mtu.mtu);
+    }
+}
+
 // =============================================================================
 // DGT3000CommandCallbacks Implementation
 // =============================================================================
@@ -56,26 +63,80 @@ void DGT3000CommandCallbacks::onWrite(BLECharacteristic* characteristic) {
         return;
     }
     
-    // Allocate a command object on the heap and wrap it in a unique_ptr.
-    auto rawCmd = std::unique_ptr<RawBLECommand>(new RawBLECommand());
-    if (!rawCmd) {
-        log_e("Failed to allocate memory for RawBLECommand");
+    if (!m_service || !m_service->queueManager) {
+        log_e("QueueManager not available; command dropped.");
         return;
     }
     
-    rawCmd->timestamp = millis();
-    rawCmd->length = value.length();
-    strncpy(rawCmd->jsonData, value.c_str(), sizeof(rawCmd->jsonData) - 1);
-    rawCmd->jsonData[sizeof(rawCmd->jsonData) - 1] = '\0';
+    char commandId[APP_MAX_COMMAND_ID_LENGTH];
+    CommandLane lane = classifyRawCommand(value.c_str(), commandId, sizeof(commandId));
     
-    // Send the command to the processing queue. The QueueManager takes ownership.
-    if (m_service && m_service->queueManager) {
-        if (!m_service->queueManager->sendRawCommand(std::move(rawCmd), 10)) { // 10ms timeout
-            log_e("Failed to send raw command to queue.");
+    // A retransmitted ID is answered from the response cache without reaching the I2C task.
+    if (m_service->handleDuplicateCommand(commandId)) {
+        return;
+    }
+    
+    // Take a command object from the pool; it goes back to the pool with its handle.
+    RawCommandPtr rawCmd = m_service->queueManager->acquireRawCommand();
+    if (rawCmd) {
+        rawCmd->timestamp = millis();
+        rawCmd->length = value.length();
+        strncpy(rawCmd->jsonData, value.c_str(), sizeof(rawCmd->jsonData) - 1);
+        rawCmd->jsonData[sizeof(rawCmd->jsonData) - 1] = '\0';
+        rawCmd->lane = lane;
+        
+        // Never wait here: this is the BLE host task, and a full lane is
+        // answered at once rather than left to the client's timeout.
+        if (m_service->queueManager->sendRawCommand(std::move(rawCmd), 0)) {
+            return; // The QueueManager owns the command now.
         }
-    } else {
+    }
+    
+    // Admission refused: let the client retry this ID, and tell it when.
+    m_service->responseCache.remove(commandId);
+    m_service->sendBusyResponse(commandId, lane);
+}
+
+// =============================================================================
+// DGT3000BinaryCommandCallbacks Implementation
+// =============================================================================
+
+void DGT3000BinaryCommandCallbacks::onWrite(BLECharacteristic* characteristic) {
+    std::string value = characteristic->getValue();
+    if (value.length() == 0 || value.length() > JSON_COMMAND_BUFFER_SIZE) {
+        log_w("Received invalid binary command length: %d", value.length());
+        return;
+    }
+    
+    if (!m_service || !m_service->queueManager) {
         log_e("QueueManager not available; command dropped.");
+        return;
+    }
+    
+    char commandId[APP_MAX_COMMAND_ID_LENGTH];
+    const uint8_t* frame = reinterpret_cast<const uint8_t*>(value.data());
+    CommandLane lane = BinaryProtocol::classifyCommand(frame, value.length(), commandId, sizeof(commandId));
+    
+    // Binary IDs are cached as "#<id>", apart from the JSON ones.
+    if (m_service->handleDuplicateCommand(commandId, CommandFormat::BINARY)) {
+        return;
+    }
+    
+    RawCommandPtr rawCmd = m_service->queueManager->acquireRawCommand();
+    if (rawCmd) {
+        rawCmd->timestamp = millis();
+        rawCmd->length = value.length();
+        memcpy(rawCmd->jsonData, value.data(), value.length());
+        rawCmd->lane = lane;
+        rawCmd->format = CommandFormat::BINARY;
+        
+        if (m_service->queueManager->sendRawCommand(std::move(rawCmd), 0)) {
+            return; // The QueueManager owns the command now.
+        }
     }
+    
+    m_service->responseCache.remove(commandId, CommandFormat::BINARY);
+    m_service->sendBusyResponse(commandId, lane, CommandFormat::BINARY);
 }
 
 // =============================================================================
@@ -121,3 +182,16 @@ void DGT3000EventDescriptorCallbacks::onWrite(BLEDescriptor* pDescriptor) {
         log_i("Client unsubscribed from event notifications.");
     }
 }
+
+// =============================================================================
+// DGT3000BinaryEventDescriptorCallbacks Implementation
+// =============================================================================
+
+void DGT3000BinaryEventDescriptorCallbacks::onWrite(BLEDescriptor* pDescriptor) {
+    uint8_t* value = pDescriptor->getValue();
+    bool subscribed = pDescriptor->getLength() >= 2 && value[0] == 0x01 && value[1] == 0x00;
+    log_i("Client %s binary event notifications.", subscribed ? "subscribed to" : "unsubscribed from");
+    if (m_service) {
+        m_service->handleBinarySubscription(subscribed);
+    }
+}
@@ -0,0 +1,403 @@
+/*
+ * Binary Protocol Implementation for DGT3000 Gateway
+ *
+ * This file implements the encoding and decoding of the binary protocol
+ * frames.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "BinaryProtocol.h"
+#include "ButtonGestureEngine.h"
+#include "TimeControlEngine.h"
+#include "DGT3000.h"
+
+// =============================================================================
+// COMMAND DECODING
+// =============================================================================
+
+CommandLane BinaryProtocol::classifyCommand(const uint8_t* frame, size_t length, char* idOut, size_t idOutSize) {
+    if (idOut && idOutSize > 0) idOut[0] = '\0';
+    if (!frame || length < COMMAND_HEADER_SIZE) return CommandLane::CONTROL;
+
+    if (idOut && idOutSize > 0) formatCommandId(readUint16(frame + 1), idOut, idOutSize);
+    if (frame[0] != CMD_GENERIC) return getCommandLane(getCommandName(frame[0]));
+
+    // Only the top-level "command" is read, by walking the MessagePack map
+    // without a document: this runs in the BLE callback and must not allocate.
+    // The full decoding happens in the I2C task.
+    const uint8_t* p = frame + COMMAND_HEADER_SIZE;
+    const uint8_t* end = frame + length;
+    if (p >= end) return CommandLane::CONTROL;
+
+    uint32_t pairs;
+    if ((*p & 0xF0) == 0x80) {
+        pairs = *p & 0x0F;
+        p += 1;
+    } else if (*p == 0xDE && end - p >= 3) {
+        pairs = readBigEndian(p + 1, 2);
+        p += 3;
+    } else if (*p == 0xDF && end - p >= 5) {
+        pairs = readBigEndian(p + 1, 4);
+        p += 5;
+    } else {
+        return CommandLane::CONTROL;
+    }
+
+    for (; pairs > 0 && p; pairs--) {
+        const uint8_t* key;
+        uint32_t keyLength;
+        p = readMsgPackString(p, end, key, keyLength);
+        if (!p) break;
+
+        if (keyLength == 7 && memcmp(key, "command", 7) == 0) {
+            const uint8_t* value;
+            uint32_t valueLength;
+            if (!readMsgPackString(p, end, value, valueLength)) break;
+            char command[32];
+            size_t copied = (valueLength < sizeof(command) - 1) ? valueLength : sizeof(command) - 1;
+            memcpy(command, value, copied);
+            command[copied] = '\0';
+            return getCommandLane(command);
+        }
+        p = skipMsgPack(p, end, 0);
+    }
+    return CommandLane::CONTROL;
+}
+
+SystemErrorCode BinaryProtocol::decodeCommand(const uint8_t* frame, size_t length, JsonDocument& doc, const char*& errorMessage) {
+    doc.clear();
+    errorMessage = nullptr;
+    if (!frame || length < COMMAND_HEADER_SIZE) {
+        errorMessage = "Frame shorter than its header";
+        return SystemErrorCode::JSON_PARSE_ERROR;
+    }
+
+    char id[APP_MAX_COMMAND_ID_LENGTH];
+    formatCommandId(readUint16(frame + 1), id, sizeof(id));
+    const uint8_t* fields = frame + COMMAND_HEADER_SIZE;
+    size_t fieldsLength = length - COMMAND_HEADER_SIZE;
+    SystemErrorCode result = SystemErrorCode::SUCCESS;
+
+    if (frame[0] == CMD_GENERIC) {
+        DeserializationError error = deserializeMsgPack(doc, fields, fieldsLength);
+        if (error || !doc.is<JsonObject>()) {
+            doc.clear();
+            errorMessage = "Generic command is not a MessagePack object";
+            result = SystemErrorCode::JSON_PARSE_ERROR;
+        }
+    } else if (const char* commandName = getCommandName(frame[0])) {
+        doc["command"] = commandName;
+        JsonObject params = doc["params"].to<JsonObject>();
+
+        // Each fixed layout has an exact length, except the text of displayText.
+        bool complete;
+        switch (frame[0]) {
+            case CMD_RUN:
+                complete = (fieldsLength == 2);
+                if (!complete) break;
+                params["leftMode"] = fields[0];
+                params["rightMode"] = fields[1];
+                break;
+            case CMD_SET_TIME:
+                complete = (fieldsLength == 8);
+                if (!complete) break;
+                params["leftMode"] = fields[0];
+                params["leftHours"] = fields[1];
+                params["leftMinutes"] = fields[2];
+                params["leftSeconds"] = fields[3];
+                params["rightMode"] = fields[4];
+                params["rightHours"] = fields[5];
+                params["rightMinutes"] = fields[6];
+                params["rightSeconds"] = fields[7];
+                break;
+            case CMD_DISPLAY_TEXT: {
+                complete = (fieldsLength >= 3 && fieldsLength - 3 <= DGT3000_DISPLAY_TEXT_MAX);
+                if (!complete) break;
+                char text[DGT3000_DISPLAY_TEXT_MAX + 1];
+                memcpy(text, fields + 3, fieldsLength - 3);
+                text[fieldsLength - 3] = '\0';
+                params["beep"] = fields[0];
+                params["leftDots"] = fields[1];
+                params["rightDots"] = fields[2];
+                params["text"] = text;
+                break;
+            }
+            case CMD_INVOKE:
+                complete = (fieldsLength == 1);
+                if (!complete) break;
+                params["handle"] = fields[0];
+                break;
+            default:
+                complete = (fieldsLength == 0);
+                break;
+        }
+
+        if (!complete) {
+            doc.clear();
+            errorMessage = "Frame length does not match its opcode";
+            result = SystemErrorCode::JSON_INVALID_PARAMETERS;
+        }
+    } else {
+        errorMessage = "Unknown opcode";
+        result = SystemErrorCode::JSON_INVALID_COMMAND;
+    }
+
+    doc["id"] = id;
+    return result;
+}
+
+// =============================================================================
+// RESPONSE ENCODING
+// =============================================================================
+
+size_t BinaryProtocol::measureResponse(const CommandResponse& response) {
+    if (!response.success) return RESPONSE_HEADER_SIZE + 4;
+    return RESPONSE_HEADER_SIZE + measureMsgPack(response.result);
+}
+
+size_t BinaryProtocol::encodeResponse(const CommandResponse& response, uint8_t controlCredits, uint8_t displayCredits,
+                                      uint8_t* buffer, size_t size) {
+    if (!response.success) {
+        return encodeError(response.id, response.errorCode, 0, controlCredits, displayCredits, buffer, size);
+    }
+    if (!buffer || size < measureResponse(response)) return 0;
+
+    size_t length = writeResponseHeader(RSP_SUCCESS, response.id, controlCredits, displayCredits, buffer);
+    return length + serializeMsgPack(response.result, buffer + length, size - length);
+}
+
+size_t BinaryProtocol::encodeError(const char* id, SystemErrorCode errorCode, uint16_t retryAfterMs,
+                                   uint8_t controlCredits, uint8_t displayCredits, uint8_t* buffer, size_t size) {
+    if (!buffer || size < RESPONSE_HEADER_SIZE + 4) return 0;
+
+    size_t length = writeResponseHeader(RSP_ERROR, id, controlCredits, displayCredits, buffer);
+    writeUint16(buffer + length, static_cast<uint16_t>(errorCode));
+    writeUint16(buffer + length + 2, retryAfterMs);
+    return length + 4;
+}
+
+// =============================================================================
+// EVENT ENCODING
+// =============================================================================
+
+size_t BinaryProtocol::encodeTimeUpdate(const TimeSnapshot& snapshot, uint8_t* buffer, size_t size) {
+    if (!buffer || size < 9) return 0;
+
+    buffer[0] = EVT_TIME_UPDATE;
+    memcpy(buffer + 1, snapshot.time, 3);
+    buffer[4] = snapshot.leftMode;
+    memcpy(buffer + 5, snapshot.time + 3, 3);
+    buffer[8] = snapshot.rightMode;
+    return 9;
+}
+
+size_t BinaryProtocol::encodeEvent(const DGTEvent& event, uint8_t* buffer, size_t size) {
+    if (!buffer || size < 12) return 0;
+    JsonVariantConst data = event.data.as<JsonVariantConst>();
+
+    switch (event.type) {
+        case DGTEvent::BUTTON_EVENT:
+            buffer[0] = EVT_BUTTON;
+            buffer[1] = data["buttonCode"] | 0;
+            buffer[2] = data["repeatCount"] | 0;
+            return 3;
+
+        case DGTEvent::BUTTON_GESTURE: {
+            const char* gestureName = data["gesture"] | "";
+            uint8_t gesture = 0;
+            while (gesture <= static_cast<uint8_t>(ButtonGestureEngine::Gesture::REPEAT) &&
+                   strcmp(gestureName, getGestureString(static_cast<ButtonGestureEngine::Gesture>(gesture))) != 0) {
+                gesture++;
+            }
+            buffer[0] = EVT_BUTTON_GESTURE;
+            buffer[1] = data["buttonCode"] | 0;
+            buffer[2] = gesture;
+            writeUint16(buffer + 3, data["durationMs"] | 0);
+            return 5;
+        }
+
+        case DGTEvent::CONNECTION_STATUS:
+            buffer[0] = EVT_CONNECTION_STATUS;
+            buffer[1] = ((data["connected"] | false) ? 0x01 : 0) | ((data["configured"] | false) ? 0x02 : 0);
+            return 2;
+
+        case DGTEvent::ERROR_EVENT:
+            buffer[0] = EVT_ERROR;
+            writeUint16(buffer + 1, data["errorCode"] | 0);
+            return 3;
+
+        case DGTEvent::FLAG_FALL: {
+            const char* side = data["side"] | "";
+            const char* source = data["source"] | "";
+            uint64_t timestampUs = data["timestampUs"] | (uint64_t)0;
+            buffer[0] = EVT_FLAG_FALL;
+            buffer[1] = strcmp(side, getTimeControlSideString(TimeControlEngine::Side::LEFT)) == 0
+                ? static_cast<uint8_t>(TimeControlEngine::Side::LEFT)
+                : static_cast<uint8_t>(TimeControlEngine::Side::RIGHT);
+            buffer[2] = strcmp(source, "clock") == 0 ? 0 : 1;
+            for (uint8_t i = 0; i < 8; i++) {
+                buffer[3 + i] = (uint8_t)(timestampUs >> (8 * i));
+            }
+            return 11;
+        }
+
+        default: {
+            size_t length = 6 + measureMsgPack(event.data);
+            if (size < length) return 0;
+            buffer[0] = EVT_GENERIC;
+            buffer[1] = event.type;
+            writeUint32(buffer + 2, event.timestamp);
+            return 6 + serializeMsgPack(event.data, buffer + 6, size - 6);
+        }
+    }
+}
+
+// =============================================================================
+// COMMAND IDS
+// =============================================================================
+
+void BinaryProtocol::formatCommandId(uint16_t id, char* buffer, size_t size) {
+    snprintf(buffer, size, "#%u", id);
+}
+
+uint16_t BinaryProtocol::parseCommandId(const char* id) {
+    if (!id || id[0] != '#') return 0;
+    return (uint16_t)strtoul(id + 1, nullptr, 10);
+}
+
+// =============================================================================
+// PRIVATE HELPER METHODS
+// =============================================================================
+
+const char* BinaryProtocol::getCommandName(uint8_t opcode) {
+    switch (opcode) {
+        case CMD_GET_TIME:      return "getTime";
+        case CMD_GET_STATUS:    return "getStatus";
+        case CMD_STOP:          return "stop";
+        case CMD_RUN:           return "run";
+        case CMD_SET_TIME:      return "setTime";
+        case CMD_DISPLAY_TEXT:  return "displayText";
+        case CMD_END_DISPLAY:   return "endDisplay";
+        case CMD_INVOKE:        return "invoke";
+        default:                return nullptr;
+    }
+}
+
+size_t BinaryProtocol::writeResponseHeader(uint8_t opcode, const char* id, uint8_t controlCredits, uint8_t displayCredits, uint8_t* buffer) {
+    buffer[0] = opcode;
+    writeUint16(buffer + 1, parseCommandId(id));
+    buffer[3] = controlCredits;
+    buffer[4] = displayCredits;
+    return RESPONSE_HEADER_SIZE;
+}
+
+void BinaryProtocol::writeUint16(uint8_t* buffer, uint16_t value) {
+    buffer[0] = (uint8_t)value;
+    buffer[1] = (uint8_t)(value >> 8);
+}
+
+void BinaryProtocol::writeUint32(uint8_t* buffer, uint32_t value) {
+    writeUint16(buffer, (uint16_t)value);
+    writeUint16(buffer + 2, (uint16_t)(value >> 16));
+}
+
+uint16_t BinaryProtocol::readUint16(const uint8_t* buffer) {
+    return (uint16_t)buffer[0] | ((uint16_t)buffer[1] << 8);
+}
+
+uint32_t BinaryProtocol::readBigEndian(const uint8_t* buffer, uint8_t size) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < size; i++) {
+        value = (value << 8) | buffer[i];
+    }
+    return value;
+}
+
+const uint8_t* BinaryProtocol::readMsgPackString(const uint8_t* p, const uint8_t* end, const uint8_t*& str, uint32_t& length) {
+    if (p >= end) return nullptr;
+    uint8_t header = 1;
+    if ((*p & 0xE0) == 0xA0) {
+        length = *p & 0x1F;
+    } else if (*p >= 0xD9 && *p <= 0xDB) {
+        header = 1 + (1 << (*p - 0xD9));    // str8, str16, str32
+        if ((size_t)(end - p) < header) return nullptr;
+        length = readBigEndian(p + 1, header - 1);
+    } else {
+        return nullptr;
+    }
+    if ((size_t)(end - p) - header < length) return nullptr;
+    str = p + header;
+    return str + length;
+}
+
+const uint8_t* BinaryProtocol::skipMsgPack(const uint8_t* p, const uint8_t* end, uint8_t depth) {
+    if (p >= end || depth > MSGPACK_MAX_DEPTH) return nullptr;
+    uint8_t type = *p;
+    uint32_t elements = 0;  // Nested values following the header
+    size_t header = 1;      // Bytes of the header, length included
+    size_t payload = 0;     // Bytes following the header, for strings, binaries and extensions
+
+    if (type <= 0x7F || type >= 0xE0 || type == 0xC0 || type == 0xC2 || type == 0xC3) {
+        // Fixint, nil, boolean
+    } else if (type <= 0x8F) {
+        elements = 2 * (type & 0x0F);
+    } else if (type <= 0x9F) {
+        elements = type & 0x0F;
+    } else if (type <= 0xBF) {
+        payload = type & 0x1F;
+    } else {
+        switch (type) {
+            case 0xC4: case 0xC5: case 0xC6:    // bin8, bin16, bin32
+                header = 1 + (1 << (type - 0xC4));
+                break;
+            case 0xC7: case 0xC8: case 0xC9:    // ext8, ext16, ext32 (length, then type)
+                header = 2 + (1 << (type - 0xC7));
+                break;
+            case 0xCA: payload = 4; break;      // float32
+            case 0xCB: payload = 8; break;      // float64
+            case 0xCC: case 0xCD: case 0xCE: case 0xCF:
+                payload = 1 << (type - 0xCC);   // uint8 to uint64
+                break;
+            case 0xD0: case 0xD1: case 0xD2: case 0xD3:
+                payload = 1 << (type - 0xD0);   // int8 to int64
+                break;
+            case 0xD4: case 0xD5: case 0xD6: case 0xD7: case 0xD8:
+                payload = 1 + (1 << (type - 0xD4)); // fixext1 to fixext16, type included
+                break;
+            case 0xD9: case 0xDA: case 0xDB:    // str8, str16, str32
+                header = 1 + (1 << (type - 0xD9));
+                break;
+            case 0xDC: case 0xDD:               // array16, array32
+                header = 1 + (2 << (type - 0xDC));
+                break;
+            case 0xDE: case 0xDF:               // map16, map32
+                header = 1 + (2 << (type - 0xDE));
+                break;
+            default:                            // 0xC1 is never used
+                return nullptr;
+        }
+    }
+
+    if ((size_t)(end - p) < header) return nullptr;
+    if (header > 1) {
+        bool extension = (type >= 0xC7 && type <= 0xC9);
+        uint32_t value = readBigEndian(p + 1, header - (extension ? 2 : 1));
+        if (type == 0xDC || type == 0xDD) elements = value;
+        else if (type == 0xDE || type == 0xDF) elements = 2 * value;
+        else payload = value;
+    }
+    p += header;
+    if ((size_t)(end - p) < payload) return nullptr;
+    p += payload;
+
+    for (; elements > 0 && p; elements--) {
+        p = skipMsgPack(p, end, depth + 1);
+    }
+    return p;
+}
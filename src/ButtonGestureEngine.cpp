@@ -0,0 +1,165 @@
+/*
+ * Button Gesture Engine Implementation for DGT3000 Gateway
+ *
+ * This file implements the gesture state machine of the main buttons.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ButtonGestureEngine.h"
+
+// =============================================================================
+// BUTTON GESTURE ENGINE IMPLEMENTATION
+// =============================================================================
+
+ButtonGestureEngine::ButtonGestureEngine()
+    : _queueHead(0),
+      _queueCount(0)
+{
+    _config.longPressMs = BUTTON_LONG_PRESS_DEFAULT_MS;
+    _config.repeatDelayMs = BUTTON_REPEAT_DELAY_DEFAULT_MS;
+    _config.repeatIntervalMs = BUTTON_REPEAT_INTERVAL_DEFAULT_MS;
+    _config.doublePressMs = BUTTON_DOUBLE_PRESS_DEFAULT_MS;
+    reset();
+}
+
+void ButtonGestureEngine::reset() {
+    memset(_buttons, 0, sizeof(_buttons));
+    _queueHead = 0;
+    _queueCount = 0;
+}
+
+void ButtonGestureEngine::onStateChange(uint8_t state, uint32_t timestampMs) {
+    // Timers due before the change fire first, to keep the gestures in order.
+    update(timestampMs);
+
+    for (uint8_t i = 0; i < BUTTON_GESTURE_BUTTON_COUNT; i++) {
+        bool pressed = state & (1 << i);
+        if (pressed && !_buttons[i].pressed) press(i, timestampMs);
+        else if (!pressed && _buttons[i].pressed) release(i, timestampMs);
+    }
+}
+
+void ButtonGestureEngine::update(uint32_t now) {
+    for (uint8_t i = 0; i < BUTTON_GESTURE_BUTTON_COUNT; i++) {
+        ButtonState& button = _buttons[i];
+        if (!button.pressed) continue;
+
+        uint32_t longPressTime = button.pressTime + _config.longPressMs;
+        if (button.longPressPending && (int32_t)(now - longPressTime) >= 0) {
+            button.longPressPending = false;
+            queueGesture(i, Gesture::LONG_PRESS, longPressTime, _config.longPressMs, 0);
+        }
+
+        if (isRepeatEnabled() && (int32_t)(now - button.nextRepeatTime) >= 0) {
+            button.repeatCount++;
+            queueGesture(i, Gesture::REPEAT, button.nextRepeatTime, button.nextRepeatTime - button.pressTime, button.repeatCount);
+
+            // Scheduled from the press time, not from now; missed repeats are skipped, not burst.
+            button.nextRepeatTime += _config.repeatIntervalMs;
+            while ((int32_t)(now - button.nextRepeatTime) >= 0) {
+                button.nextRepeatTime += _config.repeatIntervalMs;
+            }
+        }
+    }
+}
+
+bool ButtonGestureEngine::nextGesture(GestureEvent& event) {
+    if (_queueCount == 0) return false;
+    event = _queue[_queueHead];
+    _queueHead = (_queueHead + 1) % BUTTON_GESTURE_QUEUE_SIZE;
+    _queueCount--;
+    return true;
+}
+
+uint32_t ButtonGestureEngine::getTimeUntilNextTimer(uint32_t now) const {
+    uint32_t earliest = UINT32_MAX;
+    for (const ButtonState& button : _buttons) {
+        if (!button.pressed) continue;
+
+        if (button.longPressPending) {
+            int32_t untilMs = (int32_t)(button.pressTime + _config.longPressMs - now);
+            uint32_t until = (untilMs > 0) ? (uint32_t)untilMs : 0;
+            if (until < earliest) earliest = until;
+        }
+        if (isRepeatEnabled()) {
+            int32_t untilMs = (int32_t)(button.nextRepeatTime - now);
+            uint32_t until = (untilMs > 0) ? (uint32_t)untilMs : 0;
+            if (until < earliest) earliest = until;
+        }
+    }
+    return earliest;
+}
+
+// =============================================================================
+// PRIVATE HELPER METHODS
+// =============================================================================
+
+void ButtonGestureEngine::press(uint8_t index, uint32_t timestampMs) {
+    ButtonState& button = _buttons[index];
+    button.pressed = true;
+    button.pressTime = timestampMs;
+    button.longPressPending = _config.longPressMs > 0;
+    button.nextRepeatTime = timestampMs + _config.repeatDelayMs;
+    button.repeatCount = 0;
+
+    queueGesture(index, Gesture::PRESS, timestampMs, 0, 0);
+
+    // The second press of a double press cannot start another one.
+    if (button.doubleCandidate && _config.doublePressMs > 0 &&
+        timestampMs - button.lastPressTime <= _config.doublePressMs) {
+        queueGesture(index, Gesture::DOUBLE_PRESS, timestampMs, timestampMs - button.lastPressTime, 0);
+        button.doubleCandidate = false;
+    } else {
+        button.doubleCandidate = true;
+    }
+    button.lastPressTime = timestampMs;
+}
+
+void ButtonGestureEngine::release(uint8_t index, uint32_t timestampMs) {
+    ButtonState& button = _buttons[index];
+    button.pressed = false;
+    queueGesture(index, Gesture::RELEASE, timestampMs, timestampMs - button.pressTime, 0);
+}
+
+void ButtonGestureEngine::queueGesture(uint8_t index, Gesture gesture, uint32_t timestampMs, uint32_t durationMs, uint16_t repeatCount) {
+    // When full, the oldest gesture is dropped, as in the DGT3000 button buffer.
+    if (_queueCount == BUTTON_GESTURE_QUEUE_SIZE) {
+        _queueHead = (_queueHead + 1) % BUTTON_GESTURE_QUEUE_SIZE;
+        _queueCount--;
+    }
+
+    GestureEvent& event = _queue[(_queueHead + _queueCount) % BUTTON_GESTURE_QUEUE_SIZE];
+    event.button = 1 << index;
+    event.gesture = gesture;
+    event.timestampMs = timestampMs;
+    event.durationMs = durationMs;
+    event.repeatCount = repeatCount;
+    _queueCount++;
+}
+
+// =============================================================================
+// UTILITY FUNCTIONS
+// =============================================================================
+
+const char* getGestureString(ButtonGestureEngine::Gesture gesture) {
+    switch (gesture) {
+        case ButtonGestureEngine::Gesture::PRESS:
+            return "press";
+        case ButtonGestureEngine::Gesture::RELEASE:
+            return "release";
+        case ButtonGestureEngine::Gesture::LONG_PRESS:
+            return "longPress";
+        case ButtonGestureEngine::Gesture::DOUBLE_PRESS:
+            return "doublePress";
+        case ButtonGestureEngine::Gesture::REPEAT:
+            return "repeat";
+        default:
+            return "unknown";
+    }
+}
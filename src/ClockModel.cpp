@@ -0,0 +1,159 @@
+/*
+ * Clock Model Implementation for DGT3000 Gateway
+ *
+ * This file implements the sub-second model of the DGT3000 timers and the
+ * estimate of the clock drift.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ClockModel.h"
+
+// =============================================================================
+// CLOCK MODEL IMPLEMENTATION
+// =============================================================================
+
+ClockModel::ClockModel() : _driftPpm(0) {
+    reset();
+}
+
+void ClockModel::reset() {
+    for (SideState& state : _sides) {
+        state.mode = DGT_MODE_STOP;
+        state.anchorMs = 0;
+        state.anchorUs = 0;
+        memset(state.lastSeconds, 0, sizeof(state.lastSeconds));
+        state.flagged = false;
+        state.clockFlag = false;
+        state.clockFlagUs = 0;
+        state.hasDriftRef = false;
+    }
+}
+
+void ClockModel::onClockSet(uint8_t leftMode, uint8_t rightMode, const uint8_t time[6], int64_t nowUs) {
+    uint8_t modes[2] = { leftMode, rightMode };
+    for (uint8_t i = 0; i < 2; i++) {
+        SideState& state = _sides[i];
+        const uint8_t* hms = &time[i * 3];
+
+        // The clock restarts the side from the whole seconds written.
+        state.mode = modes[i];
+        state.anchorMs = toSeconds(hms) * 1000;
+        state.anchorUs = nowUs;
+        memcpy(state.lastSeconds, hms, 3);
+        state.hasDriftRef = false; // The write is not a second boundary of the clock.
+        if (state.anchorMs > 0) {
+            state.flagged = false;
+            state.clockFlag = false;
+        }
+    }
+}
+
+void ClockModel::onTimeMessage(const uint8_t time[6], int64_t arrivalUs) {
+    for (uint8_t i = 0; i < 2; i++) {
+        SideState& state = _sides[i];
+        const uint8_t* hms = &time[i * 3];
+        if (memcmp(state.lastSeconds, hms, 3) == 0) continue;
+        memcpy(state.lastSeconds, hms, 3);
+
+        // The displayed second has just changed: the side is exactly at this value.
+        uint32_t seconds = toSeconds(hms);
+        state.anchorMs = seconds * 1000;
+        state.anchorUs = arrivalUs;
+        if (state.mode != DGT_MODE_STOP) updateDrift(state, state.anchorMs, arrivalUs);
+
+        if (seconds == 0 && state.mode == DGT_MODE_COUNT_DOWN && !state.clockFlag) {
+            state.clockFlag = true;
+            state.clockFlagUs = arrivalUs;
+        }
+    }
+}
+
+uint32_t ClockModel::getTimeMs(TimeControlEngine::Side side, int64_t nowUs) const {
+    const SideState& state = _sides[index(side)];
+    int64_t elapsedUs = (nowUs > state.anchorUs) ? nowUs - state.anchorUs : 0;
+    // Convert gateway time to clock time.
+    uint32_t elapsedMs = (uint32_t)(elapsedUs * 1000 / (1000000 + _driftPpm));
+
+    switch (state.mode) {
+        case DGT_MODE_COUNT_DOWN:
+            return (elapsedMs < state.anchorMs) ? state.anchorMs - elapsedMs : 0;
+        case DGT_MODE_COUNT_UP:
+            return state.anchorMs + elapsedMs;
+        default:
+            return state.anchorMs;
+    }
+}
+
+uint8_t ClockModel::getMode(TimeControlEngine::Side side) const {
+    return _sides[index(side)].mode;
+}
+
+bool ClockModel::isInterpolating() const {
+    return _sides[0].mode != DGT_MODE_STOP || _sides[1].mode != DGT_MODE_STOP;
+}
+
+bool ClockModel::checkFlagFall(int64_t nowUs, TimeControlEngine::Side& side, int64_t& flagUs, bool& fromClock) {
+    for (uint8_t i = 0; i < 2; i++) {
+        SideState& state = _sides[i];
+        if (state.flagged || state.mode != DGT_MODE_COUNT_DOWN) continue;
+
+        int64_t modelFlagUs = getFlagTimeUs(state);
+        bool modelFlag = nowUs >= modelFlagUs;
+        if (!modelFlag && !state.clockFlag) continue;
+
+        // The model gives the instant the side reached zero; the time message
+        // only confirms it once the frame has been received.
+        state.flagged = true;
+        side = (i == 0) ? TimeControlEngine::Side::LEFT : TimeControlEngine::Side::RIGHT;
+        fromClock = state.clockFlag && (!modelFlag || state.clockFlagUs <= modelFlagUs);
+        flagUs = fromClock ? state.clockFlagUs : modelFlagUs;
+        return true;
+    }
+    return false;
+}
+
+int64_t ClockModel::getTimeUntilFlagUs(int64_t nowUs) const {
+    int64_t earliest = INT64_MAX;
+    for (const SideState& state : _sides) {
+        if (state.flagged || state.mode != DGT_MODE_COUNT_DOWN) continue;
+        int64_t untilUs = getFlagTimeUs(state) - nowUs;
+        if (untilUs < earliest) earliest = (untilUs > 0) ? untilUs : 0;
+    }
+    return earliest;
+}
+
+// =============================================================================
+// PRIVATE HELPER METHODS
+// =============================================================================
+
+int64_t ClockModel::getFlagTimeUs(const SideState& state) const {
+    return state.anchorUs + (int64_t)state.anchorMs * (1000000 + _driftPpm) / 1000;
+}
+
+void ClockModel::updateDrift(SideState& state, uint32_t timeMs, int64_t arrivalUs) {
+    if (!state.hasDriftRef) {
+        state.hasDriftRef = true;
+        state.driftRefMs = timeMs;
+        state.driftRefUs = arrivalUs;
+        return;
+    }
+
+    uint32_t spanMs = (timeMs > state.driftRefMs) ? timeMs - state.driftRefMs : state.driftRefMs - timeMs;
+    if (spanMs < CLOCK_MODEL_DRIFT_MIN_SPAN_MS) return;
+
+    // Gateway time elapsed against clock time elapsed between two second changes.
+    int64_t spanUs = (int64_t)spanMs * 1000;
+    int64_t ppm = (arrivalUs - state.driftRefUs - spanUs) * 1000000 / spanUs;
+    state.driftRefMs = timeMs;
+    state.driftRefUs = arrivalUs;
+
+    // A larger deviation is a missed message or a time change, not drift.
+    if (ppm > CLOCK_MODEL_MAX_DRIFT_PPM || ppm < -CLOCK_MODEL_MAX_DRIFT_PPM) return;
+    _driftPpm += ((int32_t)ppm - _driftPpm) / 4;
+}
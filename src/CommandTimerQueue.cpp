@@ -0,0 +1,75 @@
+/*
+ * Command Timer Queue Implementation for DGT3000 Gateway
+ *
+ * This file implements the min-heap used by the I2C task to hold the
+ * commands scheduled with an "at" timestamp.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "CommandTimerQueue.h"
+
+// =============================================================================
+// COMMAND TIMER QUEUE IMPLEMENTATION
+// =============================================================================
+
+CommandTimerQueue::CommandTimerQueue() : _count(0), _sequence(0) {
+}
+
+bool CommandTimerQueue::push(RawBLECommand* command, int64_t dueTimeUs) {
+    if (isFull()) return false;
+
+    size_t i = _count++;
+    _entries[i] = { dueTimeUs, _sequence++, command };
+
+    // Sift up.
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!isBefore(_entries[i], _entries[parent])) break;
+        std::swap(_entries[i], _entries[parent]);
+        i = parent;
+    }
+    return true;
+}
+
+RawBLECommand* CommandTimerQueue::pop(int64_t& dueTimeUs) {
+    if (_count == 0) return nullptr;
+
+    Entry top = _entries[0];
+    _entries[0] = _entries[--_count];
+
+    // Sift down.
+    size_t i = 0;
+    while (true) {
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        size_t smallest = i;
+        if (left < _count && isBefore(_entries[left], _entries[smallest])) smallest = left;
+        if (right < _count && isBefore(_entries[right], _entries[smallest])) smallest = right;
+        if (smallest == i) break;
+        std::swap(_entries[i], _entries[smallest]);
+        i = smallest;
+    }
+    dueTimeUs = top.dueTimeUs;
+    return top.command;
+}
+
+bool CommandTimerQueue::isDue(int64_t nowUs) const {
+    return _count > 0 && _entries[0].dueTimeUs - nowUs <= SCHEDULER_SPIN_THRESHOLD_US;
+}
+
+int64_t CommandTimerQueue::getTimeUntilSpinUs(int64_t nowUs) const {
+    if (_count == 0) return INT64_MAX;
+    int64_t untilSpinUs = _entries[0].dueTimeUs - SCHEDULER_SPIN_THRESHOLD_US - nowUs;
+    return (untilSpinUs > 0) ? untilSpinUs : 0;
+}
+
+bool CommandTimerQueue::isBefore(const Entry& a, const Entry& b) {
+    if (a.dueTimeUs != b.dueTimeUs) return a.dueTimeUs < b.dueTimeUs;
+    return (int32_t)(a.sequence - b.sequence) < 0;
+}
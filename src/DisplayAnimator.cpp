@@ -0,0 +1,290 @@
+/*
+ * Display Animator Implementation for DGT3000 Gateway
+ *
+ * This file implements the local playback of display animations, driven
+ * by the I2C task loop.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "DisplayAnimator.h"
+
+// =============================================================================
+// DISPLAY ANIMATOR IMPLEMENTATION
+// =============================================================================
+
+DisplayAnimator::DisplayAnimator()
+    : _mode(Mode::NONE),
+      _nextFrameTime(0),
+      _durationMs(0),
+      _repeat(0),
+      _pass(0),
+      _frame(0),
+      _length(0),
+      _stepMs(0),
+      _scrollRight(false),
+      _leftDots(0),
+      _rightDots(0),
+      _timelineLength(0),
+      _loopDepth(0),
+      _timelineHasFrame(false)
+{
+    _text[0] = '\0';
+}
+
+void DisplayAnimator::startScroll(const char* text, uint16_t stepMs, bool scrollRight, uint16_t repeat,
+                                  uint8_t leftDots, uint8_t rightDots, uint32_t now) {
+    strncpy(_text, text, DISPLAY_SCROLL_TEXT_MAX);
+    _text[DISPLAY_SCROLL_TEXT_MAX] = '\0';
+    _length = strlen(_text);
+    _stepMs = stepMs;
+    _scrollRight = scrollRight;
+    _leftDots = leftDots;
+    _rightDots = rightDots;
+
+    _repeat = repeat;
+    _pass = 0;
+    _frame = 0;
+    _nextFrameTime = now;
+    _durationMs = (repeat > 0) ? (uint32_t)getScrollFrameCount() * stepMs * repeat : 0;
+    _mode = Mode::SCROLL;
+}
+
+void DisplayAnimator::beginTimeline() {
+    _mode = Mode::NONE;
+    _timelineLength = 0;
+    _loopDepth = 0;
+    _timelineHasFrame = false;
+}
+
+bool DisplayAnimator::appendFrame(const char* text, uint8_t leftDots, uint8_t rightDots, uint8_t beep,
+                                  uint16_t durationMs, const char*& err) {
+    if (_timelineLength >= DISPLAY_TIMELINE_MAX_ENTRIES) {
+        err = "Timeline is full";
+        return false;
+    }
+
+    TimelineEntry& entry = _timeline[_timelineLength++];
+    entry.type = TimelineEntry::Type::FRAME;
+    strncpy(entry.text, text, DGT3000_DISPLAY_TEXT_MAX);
+    entry.text[DGT3000_DISPLAY_TEXT_MAX] = '\0';
+    entry.leftDots = leftDots;
+    entry.rightDots = rightDots;
+    entry.beep = beep;
+    entry.durationMs = durationMs;
+    entry.loopCount = 0;
+
+    if (_loopDepth > 0) _loops[_loopDepth - 1].hasFrame = true;
+    _timelineHasFrame = true;
+    return true;
+}
+
+bool DisplayAnimator::appendLoopStart(uint16_t count, const char*& err) {
+    if (_timelineLength >= DISPLAY_TIMELINE_MAX_ENTRIES) {
+        err = "Timeline is full";
+        return false;
+    }
+    if (_loopDepth >= DISPLAY_TIMELINE_MAX_LOOP_DEPTH) {
+        err = "Loops nested too deeply";
+        return false;
+    }
+
+    TimelineEntry& entry = _timeline[_timelineLength++];
+    entry.type = TimelineEntry::Type::LOOP_START;
+    entry.text[0] = '\0';
+    entry.loopCount = count;
+
+    _loops[_loopDepth].startIndex = _timelineLength;
+    _loops[_loopDepth].hasFrame = false;
+    _loopDepth++;
+    return true;
+}
+
+bool DisplayAnimator::appendLoopEnd(const char*& err) {
+    if (_timelineLength >= DISPLAY_TIMELINE_MAX_ENTRIES) {
+        err = "Timeline is full";
+        return false;
+    }
+    if (_loopDepth == 0) {
+        err = "Loop end without loop start";
+        return false;
+    }
+    // A loop without any frame would spin the I2C task forever.
+    if (!_loops[_loopDepth - 1].hasFrame) {
+        err = "Empty loop";
+        return false;
+    }
+
+    TimelineEntry& entry = _timeline[_timelineLength++];
+    entry.type = TimelineEntry::Type::LOOP_END;
+    entry.text[0] = '\0';
+
+    _loopDepth--;
+    if (_loopDepth > 0) _loops[_loopDepth - 1].hasFrame = true;
+    return true;
+}
+
+bool DisplayAnimator::startTimeline(uint32_t now, const char*& err) {
+    if (_loopDepth > 0) {
+        err = "Unclosed loop";
+        return false;
+    }
+    if (!_timelineHasFrame) {
+        err = "Timeline has no frame";
+        return false;
+    }
+
+    _frame = 0;
+    _loopDepth = 0;
+    _nextFrameTime = now;
+    _durationMs = computeTimelineDuration();
+    _mode = Mode::TIMELINE;
+    return true;
+}
+
+void DisplayAnimator::stop() {
+    _mode = Mode::NONE;
+}
+
+bool DisplayAnimator::update(uint32_t now, DisplayFramebuffer& display) {
+    if (_mode == Mode::NONE || (int32_t)(now - _nextFrameTime) < 0) {
+        return false;
+    }
+
+    bool completed = (_mode == Mode::SCROLL) ? updateScroll(now, display) : updateTimeline(now, display);
+    if (completed) _mode = Mode::NONE;
+    return completed;
+}
+
+uint32_t DisplayAnimator::getTimeUntilNextFrame(uint32_t now) const {
+    if (_mode == Mode::NONE) return UINT32_MAX;
+    int32_t remaining = (int32_t)(_nextFrameTime - now);
+    return (remaining > 0) ? (uint32_t)remaining : 0;
+}
+
+uint32_t DisplayAnimator::getDurationMs() const {
+    return (_mode == Mode::NONE) ? 0 : _durationMs;
+}
+
+// =============================================================================
+// PRIVATE HELPER METHODS
+// =============================================================================
+
+bool DisplayAnimator::updateScroll(uint32_t now, DisplayFramebuffer& display) {
+    // End of a pass.
+    if (_frame >= getScrollFrameCount()) {
+        _frame = 0;
+        _pass++;
+        if (_repeat > 0 && _pass >= _repeat) return true;
+    }
+
+    drawScrollFrame(display);
+    _frame++;
+    advanceFrameTime(now, _stepMs);
+    return false;
+}
+
+bool DisplayAnimator::updateTimeline(uint32_t now, DisplayFramebuffer& display) {
+    // Follow the loop markers up to the next frame. Loops always contain a
+    // frame (checked at upload), so this terminates.
+    while (_frame < _timelineLength) {
+        const TimelineEntry& entry = _timeline[_frame];
+
+        if (entry.type == TimelineEntry::Type::LOOP_START) {
+            _loops[_loopDepth].startIndex = _frame + 1;
+            _loops[_loopDepth].remaining = entry.loopCount;
+            _loopDepth++;
+            _frame++;
+        } else if (entry.type == TimelineEntry::Type::LOOP_END) {
+            LoopState& loop = _loops[_loopDepth - 1];
+            if (loop.remaining == 0 || --loop.remaining > 0) {
+                _frame = loop.startIndex;
+            } else {
+                _loopDepth--;
+                _frame++;
+            }
+        } else {
+            display.setText(entry.text);
+            display.setDots(entry.leftDots, entry.rightDots);
+            if (entry.beep > 0) display.beep(entry.beep);
+            _frame++;
+            advanceFrameTime(now, entry.durationMs);
+            return false;
+        }
+    }
+    return true;
+}
+
+void DisplayAnimator::advanceFrameTime(uint32_t now, uint16_t durationMs) {
+    // Advance from the scheduled time, not from now, so the pace does not drift.
+    _nextFrameTime += durationMs;
+    if ((int32_t)(now - _nextFrameTime) >= 0) {
+        _nextFrameTime = now + durationMs; // Too late: skip instead of bursting.
+    }
+}
+
+uint32_t DisplayAnimator::computeTimelineDuration() const {
+    // Duration of each open loop body, innermost last.
+    uint32_t bodyMs[DISPLAY_TIMELINE_MAX_LOOP_DEPTH + 1] = {0};
+    uint16_t counts[DISPLAY_TIMELINE_MAX_LOOP_DEPTH + 1] = {0};
+    uint8_t depth = 0;
+
+    for (uint8_t i = 0; i < _timelineLength; i++) {
+        const TimelineEntry& entry = _timeline[i];
+        if (entry.type == TimelineEntry::Type::LOOP_START) {
+            depth++;
+            bodyMs[depth] = 0;
+            counts[depth] = entry.loopCount;
+        } else if (entry.type == TimelineEntry::Type::LOOP_END) {
+            if (counts[depth] == 0) return 0; // Infinite loop.
+            bodyMs[depth - 1] += bodyMs[depth] * counts[depth];
+            depth--;
+        } else {
+            bodyMs[depth] += entry.durationMs;
+        }
+    }
+    return bodyMs[0];
+}
+
+uint16_t DisplayAnimator::getScrollFrameCount() const {
+    // From the first character entering to the last one leaving.
+    return _length + DGT3000_DISPLAY_TEXT_MAX;
+}
+
+void DisplayAnimator::drawScrollFrame(DisplayFramebuffer& display) const {
+    uint16_t frameCount = getScrollFrameCount();
+    uint16_t offset = _scrollRight ? (frameCount - 1 - _frame) : (_frame + 1);
+
+    // Window over the text surrounded by a full display width of blanks.
+    char window[DGT3000_DISPLAY_TEXT_MAX + 1];
+    for (int i = 0; i < DGT3000_DISPLAY_TEXT_MAX; i++) {
+        int index = offset + i - DGT3000_DISPLAY_TEXT_MAX;
+        window[i] = (index >= 0 && index < _length) ? _text[index] : ' ';
+    }
+    window[DGT3000_DISPLAY_TEXT_MAX] = '\0';
+
+    display.setText(window);
+    display.setDots(_leftDots, _rightDots);
+}
+
+// =============================================================================
+// UTILITY FUNCTIONS
+// =============================================================================
+
+const char* getAnimationModeString(DisplayAnimator::Mode mode) {
+    switch (mode) {
+        case DisplayAnimator::Mode::NONE:
+            return "none";
+        case DisplayAnimator::Mode::SCROLL:
+            return "scroll";
+        case DisplayAnimator::Mode::TIMELINE:
+            return "timeline";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * Display Framebuffer Implementation for DGT3000 Gateway
+ *
+ * This file implements the gateway-side display model used to collapse
+ * display updates into as few I2C frames as possible.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "DisplayFramebuffer.h"
+
+// =============================================================================
+// DISPLAY STATE
+// =============================================================================
+
+bool DisplayState::operator==(const DisplayState& other) const {
+    if (overlayActive != other.overlayActive) return false;
+    // Without overlay, the clock shows its timers: the content does not matter.
+    if (!overlayActive) return true;
+    return leftDots == other.leftDots &&
+           rightDots == other.rightDots &&
+           memcmp(text, other.text, DGT3000_DISPLAY_TEXT_MAX) == 0;
+}
+
+// =============================================================================
+// DISPLAY FRAMEBUFFER IMPLEMENTATION
+// =============================================================================
+
+DisplayFramebuffer::DisplayFramebuffer()
+    : _pendingBeep(0),
+      _flushIntervalMs(DISPLAY_FLUSH_INTERVAL_MS),
+      _lastFlushTime(0),
+      _updateCount(0),
+      _flushCount(0)
+{
+    reset();
+}
+
+void DisplayFramebuffer::reset() {
+    memset(_desired.text, ' ', DGT3000_DISPLAY_TEXT_MAX);
+    _desired.text[DGT3000_DISPLAY_TEXT_MAX] = '\0';
+    _desired.leftDots = 0;
+    _desired.rightDots = 0;
+    _desired.overlayActive = false;
+    _shown = _desired;
+    _pendingBeep = 0;
+}
+
+void DisplayFramebuffer::setText(const char* text) {
+    size_t length = text ? strlen(text) : 0;
+    for (size_t i = 0; i < DGT3000_DISPLAY_TEXT_MAX; i++) {
+        _desired.text[i] = (i < length) ? text[i] : ' ';
+    }
+    _desired.overlayActive = true;
+    _updateCount++;
+}
+
+bool DisplayFramebuffer::setChar(uint8_t position, char c) {
+    if (position >= DGT3000_DISPLAY_TEXT_MAX) return false;
+    _desired.text[position] = c;
+    _desired.overlayActive = true;
+    _updateCount++;
+    return true;
+}
+
+void DisplayFramebuffer::setDots(uint8_t leftDots, uint8_t rightDots) {
+    _desired.leftDots = leftDots;
+    _desired.rightDots = rightDots;
+    _desired.overlayActive = true;
+    _updateCount++;
+}
+
+void DisplayFramebuffer::beep(uint8_t duration) {
+    // Collapsed beeps keep the longest one.
+    if (duration > _pendingBeep) _pendingBeep = duration;
+    _updateCount++;
+}
+
+void DisplayFramebuffer::clear() {
+    _desired.overlayActive = false;
+    _pendingBeep = 0;
+    _updateCount++;
+}
+
+bool DisplayFramebuffer::isDirty() const {
+    return _desired != _shown || (_pendingBeep > 0 && _desired.overlayActive);
+}
+
+bool DisplayFramebuffer::isFlushDue(uint32_t now) const {
+    return isDirty() && (now - _lastFlushTime >= _flushIntervalMs);
+}
+
+void DisplayFramebuffer::markFlushed(uint32_t now) {
+    _shown = _desired;
+    _pendingBeep = 0;
+    _lastFlushTime = now;
+    _flushCount++;
+}
@@ -14,10 +14,82 @@
 
 #include "I2CTaskManager.h"
 #include "00-GatewayConstants.h" // For version constants
+#include "BinaryProtocol.h"
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
+#include <base64.h>
 
 using namespace esp32m;
 
+// Commands that only manage gateway state and can run without the clock.
+static bool commandRequiresClock(const char* commandName) {
+    return strcmp(commandName, "getStatus") != 0 &&
+           strcmp(commandName, "getQueueStats") != 0 &&
+           strcmp(commandName, "defineMacro") != 0 &&
+           strcmp(commandName, "configureDisplay") != 0 &&
+           strcmp(commandName, "schedule") != 0 &&
+           strcmp(commandName, "unschedule") != 0 &&
+           strcmp(commandName, "getMoveLog") != 0 &&
+           strcmp(commandName, "clearMoveLog") != 0 &&
+           strcmp(commandName, "configureClockSync") != 0 &&
+           strcmp(commandName, "configureButtons") != 0;
+}
+
+// Commands that change the clock state and therefore end display animations.
+static bool isClockControlCommand(const char* commandName) {
+    return strcmp(commandName, "stop") == 0 ||
+           strcmp(commandName, "run") == 0 ||
+           strcmp(commandName, "setTime") == 0;
+}
+
+// 32-bit FNV-1a, used to detect changes in periodic job results.
+static constexpr uint32_t FNV_OFFSET_BASIS = 2166136261u;
+
+static uint32_t hashBytes(const void* data, size_t size, uint32_t hash = FNV_OFFSET_BASIS) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Result fields that change on every run whatever the clock does (gateway
+// timestamps, interpolated milliseconds). They are left out of the change
+// detection, or a job polling getTime would report at every period.
+static bool isVolatileResultKey(const char* key) {
+    return strcmp(key, "gatewayTime") == 0 ||
+           strcmp(key, "gatewayTimeUs") == 0 ||
+           strcmp(key, "leftTimeMs") == 0 ||
+           strcmp(key, "rightTimeMs") == 0;
+}
+
+// Hashes a job result, nested values included, without its volatile fields.
+static uint32_t hashResult(JsonVariantConst value, uint32_t hash) {
+    if (value.is<JsonObjectConst>()) {
+        for (JsonPairConst pair : value.as<JsonObjectConst>()) {
+            const char* key = pair.key().c_str();
+            if (isVolatileResultKey(key)) continue;
+            hash = hashBytes(key, strlen(key) + 1, hash);
+            hash = hashResult(pair.value(), hash);
+        }
+        return hashBytes("}", 1, hash);
+    }
+    if (value.is<JsonArrayConst>()) {
+        for (JsonVariantConst element : value.as<JsonArrayConst>()) {
+            hash = hashResult(element, hash);
+        }
+        return hashBytes("]", 1, hash);
+    }
+    if (value.is<const char*>()) {
+        const char* text = value.as<const char*>();
+        return hashBytes(text, strlen(text) + 1, hash);
+    }
+    // Numbers, booleans and null: at most 9 bytes of MessagePack.
+    uint8_t encoded[9];
+    size_t size = serializeMsgPack(value, encoded, sizeof(encoded));
+    return hashBytes(encoded, size, hash);
+}
+
 // =============================================================================
 // I2C TASK MANAGER IMPLEMENTATION
 // =============================================================================
@@ -31,12 +103,23 @@ I2CTaskManager::I2CTaskManager(QueueManager* queueMgr, SystemStatus* status)
       _dgtConnectionState(ConnectionState::DISCONNECTED),
       _dgtConfigured(false),
       _bleConnected(false),
+      _driverQueue(nullptr),
+      _dgtReleased(false),
       _lastUpdateTime(0),
       _lastRecoveryAttempt(0),
       _recoveryAttempts(0),
       _connectionStartTime(0),
       _stateMutex(nullptr),
-      _initializingDGT(false)
+      _initializingDGT(false),
+      _commandParamsDoc(&_commandParamsArena),
+      _responseResultDoc(&_responseResultArena),
+      _commandFormat(CommandFormat::JSON),
+      _animationNextChunk(0),
+      _leverInverted(false),
+      _clockSyncIntervalMs(0),
+      _lastClockSyncTime(0),
+      _timeUpdatesEnabled(true),
+      _lastTimeAnomalyEventTime(0)
 {
     // Initialize all state and monitoring structures.
     _stats = I2CTaskStats();
@@ -46,28 +129,47 @@ I2CTaskManager::I2CTaskManager(QueueManager* queueMgr, SystemStatus* status)
     _timeMonitoring.timeUpdateCount = 0;
     memset(_timeMonitoring.lastTime, 0, sizeof(_timeMonitoring.lastTime));
     
-    _buttonMonitoring.lastButtonState = 0;
-    _buttonMonitoring.lastButtonTime = 0;
-    _buttonMonitoring.buttonRepeatCount = 0;
-    _buttonMonitoring.buttonRepeatActive = false;
+    _macroCapture.active = false;
+    _macroCapture.success = false;
+    _macroCapture.errorCode = SystemErrorCode::SUCCESS;
+    _macroCapture.errorMessage[0] = '\0';
 }
 
 I2CTaskManager::~I2CTaskManager() {
     stopTask();
+    clearScheduledCommands();
     if (_stateMutex != nullptr) {
         vSemaphoreDelete(_stateMutex);
     }
+    if (_driverQueue != nullptr) {
+        vQueueDelete(_driverQueue);
+    }
     _dgt3000.reset();
 }
 
 bool I2CTaskManager::initialize() {
     // Create a mutex for thread-safe access to shared state variables.
+#if GATEWAY_STATIC_ALLOCATION
+    _stateMutex = xSemaphoreCreateMutexStatic(&_stateMutexBuffer);
+#else
     _stateMutex = xSemaphoreCreateMutex();
+#endif
     if (_stateMutex == nullptr) {
         logE("Failed to create state mutex");
         return false;
     }
     
+    // BLE callbacks hand their notifications to the I2C task, the only user of the driver.
+#if GATEWAY_STATIC_ALLOCATION
+    _driverQueue = xQueueCreateStatic(I2C_TASK_DRIVER_QUEUE_SIZE, sizeof(DriverMessage), _driverQueueStorage, &_driverQueueBuffer);
+#else
+    _driverQueue = xQueueCreate(I2C_TASK_DRIVER_QUEUE_SIZE, sizeof(DriverMessage));
+#endif
+    if (_driverQueue == nullptr) {
+        logE("Failed to create driver message queue");
+        return false;
+    }
+    
     // Create the DGT3000 driver instance, but defer hardware initialization.
     _dgt3000 = std::unique_ptr<DGT3000>(new DGT3000());
     if (!_dgt3000) {
@@ -75,6 +177,9 @@ bool I2CTaskManager::initialize() {
         return false;
     }
     
+    // Restore the macros saved in NVS by previous sessions.
+    _macroStore.begin();
+    
     resetStatistics();
     setState(I2CTaskState::INITIALIZED);
     logI("I2C Task Manager initialized");
@@ -91,6 +196,10 @@ void I2CTaskManager::cleanup() {
         vSemaphoreDelete(_stateMutex);
         _stateMutex = nullptr;
     }
+    if (_driverQueue != nullptr) {
+        vQueueDelete(_driverQueue);
+        _driverQueue = nullptr;
+    }
 
     setState(I2CTaskState::IDLE);
     logI("I2C Task Manager cleanup complete");
@@ -114,7 +223,17 @@ bool I2CTaskManager::startTask() {
         return true;
     }
     
+    // The task loop runs while the state is RUNNING: set it before the task
+    // starts, as it may run on Core 0 before xTaskCreatePinnedToCore returns.
+    setState(I2CTaskState::RUNNING);
+    
     // Create the dedicated FreeRTOS task pinned to Core 0.
+#if GATEWAY_STATIC_ALLOCATION
+    _taskHandle = xTaskCreateStaticPinnedToCore(
+        taskFunction, "I2CTask", I2C_TASK_STACK_SIZE, this, I2C_TASK_PRIORITY,
+        _taskStack, &_taskBuffer, I2C_TASK_CORE);
+    BaseType_t result = (_taskHandle != nullptr) ? pdPASS : pdFAIL;
+#else
     BaseType_t result = xTaskCreatePinnedToCore(
         taskFunction,           // Task function entry point
         "I2CTask",              // Task name
@@ -124,13 +243,14 @@ bool I2CTaskManager::startTask() {
         &_taskHandle,           // Task handle output
         I2C_TASK_CORE           // Pin to Core 0
     );
+#endif
     
     if (result != pdPASS) {
         logE("Failed to create I2C Task");
+        setState(I2CTaskState::INITIALIZED);
         return false;
     }
     
-    setState(I2CTaskState::RUNNING);
     logI("I2C Task started");
     return true;
 }
@@ -197,8 +317,18 @@ bool I2CTaskManager::initializeDGT3000() {
     generateConnectionStatusEvent(true, true);
     logI("DGT3000 initialized successfully");
     
+    // The clock shows its timers after (re)configuration, and no longer follows the game.
+    _timeControl.pause();
+    _clockModel.reset();
+    _timeAnalyzer.clearStats();
+    _timeAnalyzer.reset();
+    _buttonGestures.reset();
+    _animator.stop();
+    _animationNextChunk = 0;
+    _display.reset();
     if (_dgt3000 && !_bleConnected) {
-        _dgt3000->displayText(" BT   WA|T");
+        _display.setText(" BT   WA|T");
+        flushDisplay(true);
     }
     
     _initializingDGT = false;
@@ -239,19 +369,20 @@ bool I2CTaskManager::isDGT3000Configured() const {
 // CONNECTION STATE MANAGEMENT
 // =============================================================================
 
+// Both callbacks run in the BLE host task (core 1): they never touch the
+// driver or the task state, they only post a message to the I2C task.
 void I2CTaskManager::onBLEConnected() {
-    logI("BLE connected.");
-    _bleConnected = true;
-    
-    if (isDGT3000Connected() && _dgt3000) {
-        _dgt3000->displayText(" Connected ", 1);
+    DriverMessage message = DriverMessage::BLE_CONNECTED;
+    if (_driverQueue == nullptr || xQueueSend(_driverQueue, &message, 0) != pdTRUE) {
+        logW("Failed to post BLE connection to the I2C task");
     }
 }
 
 void I2CTaskManager::onBLEDisconnected() {
-    logI("BLE disconnected, cleaning up DGT3000 and rebooting...");
-    _bleConnected = false;
-    cleanupDGT3000();
+    DriverMessage message = DriverMessage::BLE_DISCONNECTED;
+    if (_driverQueue == nullptr || xQueueSend(_driverQueue, &message, 0) != pdTRUE) {
+        logW("Failed to post BLE disconnection to the I2C task");
+    }
 }
 
 // =============================================================================
@@ -276,12 +407,27 @@ void I2CTaskManager::runTask() {
         esp_task_wdt_reset();
         
         // Main task loop operations
-        processCommand();
+        processDriverMessages();
+        if (_queueManager) _queueManager->retryHeldEvents();
+        if (_dgtReleased) {
+            // The clock is powered off for the restart: stop driving it.
+            delayWithYield(I2C_TASK_UPDATE_INTERVAL_MS);
+            continue;
+        }
+        processScheduledCommands();
+        
+        // Close to the next scheduled command, start no I2C work that could still
+        // hold the bus at its due time: it waits for the next loops.
+        bool busReserved = isBusReserved();
+        if (!busReserved) {
+            processCommand();
+            processJobs();
+        }
         if (isDGT3000Connected()) {
             // If DGT is connected, handle events and monitor the connection.
             handleEvents();
-            monitorConnection();
-        } else {
+            if (!busReserved) monitorConnection();
+        } else if (!busReserved) {
             // try to initialize DGT3000
             if (!initializeDGT3000()) {
                 delayWithYield(1000);
@@ -289,10 +435,10 @@ void I2CTaskManager::runTask() {
         }
         updateStatistics();
         
-        // Maintain a consistent update frequency.
-        uint32_t elapsed = millis() - loopStart;
-        if (elapsed < I2C_TASK_UPDATE_INTERVAL_MS) {
-            delayWithYield(I2C_TASK_UPDATE_INTERVAL_MS - elapsed);
+        // Maintain a consistent update frequency, waking up early for a scheduled command.
+        uint32_t sleepMs = getSleepTimeMs(millis() - loopStart);
+        if (sleepMs > 0) {
+            delayWithYield(sleepMs);
         }
     }
     
@@ -304,63 +450,195 @@ void I2CTaskManager::runTask() {
 // CORE TASK OPERATIONS
 // =============================================================================
 
+void I2CTaskManager::processDriverMessages() {
+    DriverMessage message;
+    while (_driverQueue != nullptr && xQueueReceive(_driverQueue, &message, 0) == pdTRUE) {
+        switch (message) {
+            case DriverMessage::BLE_CONNECTED:
+                logI("BLE connected.");
+                _bleConnected = true;
+                if (isDGT3000Connected()) {
+                    stopAnimation("preempted");
+                    _display.setText(" Connected ");
+                    _display.beep(1);
+                }
+                break;
+                
+            case DriverMessage::BLE_DISCONNECTED:
+                logI("BLE disconnected, cleaning up DGT3000 before the restart...");
+                _bleConnected = false;
+                clearScheduledCommands();
+                _jobScheduler.clear();
+                cleanupDGT3000();
+                _dgtReleased = true;
+                break;
+        }
+    }
+}
+
 void I2CTaskManager::processCommand() {
     if (!_queueManager) return;
 
-    std::unique_ptr<RawBLECommand> rawCmd;
+    RawCommandPtr rawCmd;
 
-    // Process a single command from the queue.
+    // Process a single command per cycle. The control lane is always drained
+    // before the display lane, so stop/run never wait behind display traffic.
     if ((rawCmd = _queueManager->receiveRawCommand(0)) != nullptr) {
         _stats.commandsReceived++;
 
-        _commandParamsDoc.clear(); 
-        DeserializationError error = deserializeJson(_commandParamsDoc, rawCmd->jsonData);
-        
-        const char* id = _commandParamsDoc["id"];
-        if (error) {
-            logE("JSON parse error: %s", error.c_str());
-            if (id) sendCommandError(id, SystemErrorCode::JSON_PARSE_ERROR, error.c_str());
+        const char* id = nullptr;
+        const char* commandName = nullptr;
+        if (!parseCommand(*rawCmd, id, commandName)) {
             return; // Process only one command, so return after handling.
         }
 
-        const char* commandName = _commandParamsDoc["command"];
-        if (!id || !commandName) {
-            logW("Missing 'id' or 'command' field in JSON command");
-            if (id) sendCommandError(id, SystemErrorCode::JSON_INVALID_COMMAND, "Missing 'id' or 'command' field");
+        // Drop commands that went stale while waiting (e.g. during a recovery stall)
+        // without touching the I2C bus.
+        uint32_t ttlMs = _commandParamsDoc["deadlineMs"] | getCommandDefaultTtlMs(commandName);
+        uint32_t ageMs = millis() - rawCmd->timestamp;
+        if (ttlMs > 0 && ageMs > ttlMs) {
+            logW("Command expired: %s (ID: %s, age: %lu ms, deadline: %lu ms)", commandName, id, ageMs, ttlMs);
+            _stats.commandsExpired++;
+            sendCommandError(id, SystemErrorCode::COMMAND_EXPIRED, "Command expired before execution");
             return; // Process only one command, so return after handling.
         }
 
-        logI("Processing command: %s (ID: %s)", commandName, id);
-
-        // Check if the command requires a DGT connection.
-        bool needsDGT = (strcmp(commandName, "getStatus") != 0);
-        if (needsDGT && !isDGT3000Connected()) {
-            sendCommandError(id, SystemErrorCode::DGT_NOT_CONFIGURED, "DGT3000 not connected");
+        // Commands with an "at" field wait for their gateway timestamp.
+        JsonVariantConst at = _commandParamsDoc["at"];
+        if (!at.isNull()) {
+            if (!at.is<uint32_t>()) {
+                sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'at' must be a gateway time in milliseconds");
+                return;
+            }
+            scheduleCommand(std::move(rawCmd), id, at.as<uint32_t>());
             return; // Process only one command, so return after handling.
         }
 
-        bool success = executeCommand(id, commandName, _commandParamsDoc["params"]);
-        if (success) _stats.commandsExecuted++;
-        else _stats.commandsFailed++;
+        dispatchCommand(id, commandName);
+    }
+}
+
+void I2CTaskManager::processScheduledCommands() {
+    while (_scheduledCommands.isDue(esp_timer_get_time())) {
+        int64_t dueTimeUs;
+        RawCommandPtr rawCmd = _queueManager->adoptRawCommand(_scheduledCommands.pop(dueTimeUs));
+
+        // Parse before waiting, so that only the I2C transfer remains after the due time.
+        const char* id = nullptr;
+        const char* commandName = nullptr;
+        if (!parseCommand(*rawCmd, id, commandName)) {
+            continue;
+        }
+
+        // The tick (1 ms) is too coarse for the last fraction: busy-wait on esp_timer.
+        while (esp_timer_get_time() < dueTimeUs) {
+        }
+
+        uint32_t jitterUs = (uint32_t)(esp_timer_get_time() - dueTimeUs);
+        _stats.scheduleLastJitterUs = jitterUs;
+        if (jitterUs > _stats.scheduleMaxJitterUs) {
+            _stats.scheduleMaxJitterUs = jitterUs;
+        }
+        
+        dispatchCommand(id, commandName);
+        logD("Scheduled command %s (ID: %s) executed %lu us after its due time", commandName, id, jitterUs);
+    }
+}
+
+void I2CTaskManager::processJobs() {
+    JobScheduler::Job* job;
+    while ((job = _jobScheduler.nextDue()) != nullptr) {
+        runJob(*job);
+        _jobScheduler.reschedule(job);
+    }
+}
+
+void I2CTaskManager::runJob(JobScheduler::Job& job) {
+    char jobCommandId[APP_MAX_COMMAND_ID_LENGTH];
+    snprintf(jobCommandId, sizeof(jobCommandId), "job-%u", job.id);
+    
+    if (!_queueManager) return;
+    auto event = _queueManager->acquireEvent(DGTEvent::JOB_RESULT);
+    if (!event) return; // Run again at the next period.
+    event->data["jobId"] = job.id;
+    
+    _macroStepsDoc.clear();
+    bool loaded = (job.macroHandle >= 0)
+        ? _macroStore.load(job.macroHandle, _macroStepsDoc)
+        : !deserializeMsgPack(_macroStepsDoc, job.data, job.size);
+    
+    if (!loaded) {
+        event->data["status"] = "error";
+        event->data["errorCode"] = static_cast<uint16_t>(SystemErrorCode::MACRO_NOT_DEFINED);
+        event->data["errorMessage"] = getErrorCodeString(SystemErrorCode::MACRO_NOT_DEFINED);
+    } else if (!isDGT3000Connected()) {
+        event->data["status"] = "error";
+        event->data["errorCode"] = static_cast<uint16_t>(SystemErrorCode::DGT_NOT_CONNECTED);
+        event->data["errorMessage"] = getErrorCodeString(SystemErrorCode::DGT_NOT_CONNECTED);
+    } else {
+        runMacroSteps(jobCommandId, JsonObjectConst());
+        if (_macroCapture.success) {
+            event->data["status"] = "success";
+            event->data["result"] = _macroResultDoc;
+        } else {
+            event->data["status"] = "error";
+            event->data["errorCode"] = static_cast<uint16_t>(_macroCapture.errorCode);
+            event->data["errorMessage"] = _macroCapture.errorMessage;
+        }
+    }
+    
+    // Only report results that changed since the previous run.
+    uint32_t hash = hashResult(event->data.as<JsonVariantConst>(), FNV_OFFSET_BASIS);
+    if (job.hasResult && hash == job.lastResultHash) {
+        return;
+    }
+    job.hasResult = true;
+    job.lastResultHash = hash;
+    
+    if (_queueManager->sendEvent(std::move(event), 2)) {
+        _stats.eventsGenerated++;
     }
 }
 
 void I2CTaskManager::handleEvents() {
     if (!_dgt3000 || !isDGT3000Connected()) return;
     
-    // Check for discrete button presses/releases.
-    generateButtonEvent();
+    // These write to the clock: close to a scheduled command, they wait for it.
+    if (!isBusReserved()) {
+        // Check for discrete button presses/releases.
+        generateButtonEvent();
+        
+        // Start the side on move when its delay has elapsed.
+        serviceTimeControl();
+
+        // Write pending display changes, at most once per flush interval.
+        serviceDisplay();
+    }
 
-    // Check for button-hold-repeat events.
-    handleButtonRepeat();
+    // Check for button repeats, long presses and double presses.
+    handleButtonGestures();
 
     // Check for time updates from the clock.
     if (_dgt3000->isNewTimeAvailable()) {
         uint8_t time[6];
         if (_dgt3000->getTime(time)) {
-            generateTimeEvent(time);
+            uint32_t ageUs = micros() - _dgt3000->getLastTimeUpdateMicros();
+            int64_t arrivalUs = esp_timer_get_time() - ageUs;
+            _clockModel.onTimeMessage(time, arrivalUs);
+            
+            TimeFrameAnalyzer::Report report;
+            if (_timeAnalyzer.onFrame(time, _clockModel.getMode(TimeControlEngine::Side::LEFT),
+                                      _clockModel.getMode(TimeControlEngine::Side::RIGHT), arrivalUs, report)) {
+                generateTimeAnomalyEvent(report);
+            }
+            
+            // A flag fall is reported before the time update showing it.
+            checkFlagFall();
+            if (_timeUpdatesEnabled) generateTimeEvent(time);
         }
     }
+    checkFlagFall();
+    serviceClockSync();
 }
 
 void I2CTaskManager::monitorConnection() {
@@ -374,14 +652,86 @@ void I2CTaskManager::monitorConnection() {
 // COMMAND PROCESSING
 // =============================================================================
 
+bool I2CTaskManager::parseCommand(const RawBLECommand& rawCmd, const char*& id, const char*& commandName) {
+    _commandFormat = rawCmd.format;
+    if (rawCmd.format == CommandFormat::BINARY) {
+        // Decoded into the same document as a JSON command, for the same executors.
+        const char* errorMessage;
+        SystemErrorCode error = BinaryProtocol::decodeCommand(reinterpret_cast<const uint8_t*>(rawCmd.jsonData),
+                                                              rawCmd.length, _commandParamsDoc, errorMessage);
+        id = _commandParamsDoc["id"];
+        commandName = _commandParamsDoc["command"];
+        if (error != SystemErrorCode::SUCCESS) {
+            logW("Binary command error: %s", errorMessage);
+            if (id) sendCommandError(id, error, errorMessage);
+            return false;
+        }
+    } else {
+        _commandParamsDoc.clear(); 
+        DeserializationError error = deserializeJson(_commandParamsDoc, rawCmd.jsonData);
+        
+        id = _commandParamsDoc["id"];
+        if (error) {
+            logE("JSON parse error: %s", error.c_str());
+            if (id) sendCommandError(id, SystemErrorCode::JSON_PARSE_ERROR, error.c_str());
+            return false;
+        }
+        commandName = _commandParamsDoc["command"];
+    }
+
+    if (!id || !commandName) {
+        logW("Missing 'id' or 'command' field in JSON command");
+        if (id) sendCommandError(id, SystemErrorCode::JSON_INVALID_COMMAND, "Missing 'id' or 'command' field");
+        return false;
+    }
+    return true;
+}
+
+void I2CTaskManager::dispatchCommand(const char* id, const char* commandName) {
+    logI("Processing command: %s (ID: %s)", commandName, id);
+
+    // Check if the command requires a DGT connection.
+    if (commandRequiresClock(commandName) && !isDGT3000Connected()) {
+        sendCommandError(id, SystemErrorCode::DGT_NOT_CONFIGURED, "DGT3000 not connected");
+        return;
+    }
+
+    bool success = executeCommand(id, commandName, _commandParamsDoc["params"]);
+    if (success) _stats.commandsExecuted++;
+    else _stats.commandsFailed++;
+}
+
 bool I2CTaskManager::executeCommand(const char* id, const char* commandName, const JsonObjectConst& params) {
+    // Clock control from the client takes over from the gateway-side animation and time control.
+    if (isClockControlCommand(commandName)) {
+        if (_animator.isActive()) {
+            stopAnimation("preempted");
+            _display.clear();
+        }
+        _timeControl.pause();
+    }
+    
     if (strcmp(commandName, "setTime") == 0) return executeSetTime(id, params);
     if (strcmp(commandName, "displayText") == 0) return executeDisplayText(id, params);
     if (strcmp(commandName, "endDisplay") == 0) return executeEndDisplay(id);
+    if (strcmp(commandName, "updateDisplay") == 0) return executeUpdateDisplay(id, params);
+    if (strcmp(commandName, "configureDisplay") == 0) return executeConfigureDisplay(id, params);
+    if (strcmp(commandName, "displayScroll") == 0) return executeDisplayScroll(id, params);
+    if (strcmp(commandName, "playAnimation") == 0) return executePlayAnimation(id, params);
     if (strcmp(commandName, "stop") == 0) return executeStop(id);
     if (strcmp(commandName, "run") == 0) return executeRun(id, params);
     if (strcmp(commandName, "getTime") == 0) return executeGetTime(id);
     if (strcmp(commandName, "getStatus") == 0) return executeGetStatus(id);
+    if (strcmp(commandName, "getQueueStats") == 0) return executeGetQueueStats(id);
+    if (strcmp(commandName, "defineMacro") == 0) return executeDefineMacro(id, params);
+    if (strcmp(commandName, "invoke") == 0) return executeInvoke(id, params);
+    if (strcmp(commandName, "schedule") == 0) return executeSchedule(id, params);
+    if (strcmp(commandName, "unschedule") == 0) return executeUnschedule(id, params);
+    if (strcmp(commandName, "configureTimeControl") == 0) return executeConfigureTimeControl(id, params);
+    if (strcmp(commandName, "getMoveLog") == 0) return executeGetMoveLog(id, params);
+    if (strcmp(commandName, "clearMoveLog") == 0) return executeClearMoveLog(id);
+    if (strcmp(commandName, "configureClockSync") == 0) return executeConfigureClockSync(id, params);
+    if (strcmp(commandName, "configureButtons") == 0) return executeConfigureButtons(id, params);
     
     sendCommandError(id, SystemErrorCode::JSON_INVALID_COMMAND, "Unknown command");
     return false;
@@ -405,6 +755,7 @@ bool I2CTaskManager::executeSetTime(const char* id, const JsonObjectConst& param
     bool success = _dgt3000->setAndRun(leftMode, leftHours, leftMinutes, leftSeconds, rightMode, rightHours, rightMinutes, rightSeconds);
     
     if (success) {
+        recordClockSet(leftMode, rightMode);
         _responseResultDoc.clear();
         _responseResultDoc["status"] = "Time set successfully";
         sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
@@ -426,35 +777,192 @@ bool I2CTaskManager::executeDisplayText(const char* id, const JsonObjectConst& p
         return false;
     }
     
-    bool success = _dgt3000->displayText(text, beep, leftDots, rightDots);
+    stopAnimation("preempted");
+    _display.setText(text);
+    _display.setDots(leftDots, rightDots);
+    if (beep > 0) _display.beep(beep);
     
-    if (success) {
-        _responseResultDoc.clear();
-        _responseResultDoc["status"] = "Text displayed successfully";
-        sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
-    } else {
-        handleDGT3000Error(_dgt3000->getLastError());
-        sendCommandError(id, SystemErrorCode::I2C_COMMUNICATION_ERROR, "Failed to display text on DGT3000");
-    }
-    return success;
+    return sendDisplayResponse(id, "Text displayed successfully", "Failed to display text on DGT3000");
 }
 
 bool I2CTaskManager::executeEndDisplay(const char* id) {
-    bool success = _dgt3000->endDisplay();
-    if (success) {
-        _responseResultDoc.clear();
-        _responseResultDoc["status"] = "Display ended successfully";
+    stopAnimation("preempted");
+    _display.clear();
+    return sendDisplayResponse(id, "Display ended successfully", "Failed to end display");
+}
+
+bool I2CTaskManager::executeUpdateDisplay(const char* id, const JsonObjectConst& params) {
+    const DisplayState& state = _display.getState();
+    const char* text = params["text"];
+    const char* character = params["char"];
+    JsonVariantConst position = params["position"];
+    bool dotsChanged = !params["leftDots"].isNull() || !params["rightDots"].isNull();
+    uint8_t leftDots = params["leftDots"] | state.leftDots;
+    uint8_t rightDots = params["rightDots"] | state.rightDots;
+    uint8_t beep = params["beep"] | 0;
+    
+    if (!text && !character && !dotsChanged && beep == 0) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "Nothing to update");
+        return false;
+    }
+    if (character && (strlen(character) != 1 || !position.is<uint8_t>() || position.as<uint8_t>() >= DGT3000_DISPLAY_TEXT_MAX)) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'char' must be one character with a 'position' from 0 to 10");
+        return false;
+    }
+    if (!validateDisplayTextParameters(text ? text : state.text, beep, leftDots, rightDots)) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "Invalid display text parameters");
+        return false;
+    }
+    
+    // Unchanged fields keep their current value in the display model.
+    stopAnimation("preempted");
+    if (text) _display.setText(text);
+    if (character) _display.setChar(position.as<uint8_t>(), character[0]);
+    if (dotsChanged) _display.setDots(leftDots, rightDots);
+    if (beep > 0) _display.beep(beep);
+    
+    return sendDisplayResponse(id, "Display updated successfully", "Failed to update display on DGT3000");
+}
+
+bool I2CTaskManager::executeConfigureDisplay(const char* id, const JsonObjectConst& params) {
+    JsonVariantConst interval = params["flushIntervalMs"];
+    if (!interval.is<uint32_t>() || interval.as<uint32_t>() > DISPLAY_FLUSH_INTERVAL_MAX_MS) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'flushIntervalMs' must be from 0 to 1000");
+        return false;
+    }
+    
+    _display.setFlushInterval(interval.as<uint32_t>());
+    
+    _responseResultDoc.clear();
+    _responseResultDoc["flushIntervalMs"] = _display.getFlushInterval();
+    sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+    return true;
+}
+
+bool I2CTaskManager::executeDisplayScroll(const char* id, const JsonObjectConst& params) {
+    const char* text = params["text"];
+    uint16_t stepMs = params["stepMs"] | 250;
+    const char* direction = params["direction"] | "left";
+    uint16_t repeat = params["repeat"] | 1;
+    uint8_t leftDots = params["leftDots"] | 0;
+    uint8_t rightDots = params["rightDots"] | 0;
+    
+    if (!text || strlen(text) == 0 || strlen(text) > DISPLAY_SCROLL_TEXT_MAX) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'text' must have 1 to 64 characters");
+        return false;
+    }
+    if (stepMs < DISPLAY_ANIMATION_MIN_STEP_MS) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'stepMs' is below the minimum step");
+        return false;
+    }
+    if (strcmp(direction, "left") != 0 && strcmp(direction, "right") != 0) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'direction' must be 'left' or 'right'");
+        return false;
+    }
+    if (!validateDisplayTextParameters("", 0, leftDots, rightDots)) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "Invalid display text parameters");
+        return false;
+    }
+    
+    stopAnimation("preempted");
+    _animator.startScroll(text, stepMs, strcmp(direction, "right") == 0, repeat, leftDots, rightDots, millis());
+    
+    _responseResultDoc.clear();
+    _responseResultDoc["status"] = "Scroll started";
+    _responseResultDoc["durationMs"] = _animator.getDurationMs();
+    sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+    return true;
+}
+
+bool I2CTaskManager::executePlayAnimation(const char* id, const JsonObjectConst& params) {
+    JsonArrayConst frames = params["frames"];
+    uint8_t chunk = params["chunk"] | 0;
+    bool more = params["more"] | false;
+    
+    if (frames.isNull()) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "Missing 'frames' parameter");
+        return false;
+    }
+    if (chunk != _animationNextChunk && chunk != 0) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "Unexpected 'chunk' index");
+        return false;
+    }
+    
+    // The first chunk replaces the timeline, which is shared with the animation being played.
+    if (chunk == 0) {
+        stopAnimation("preempted");
+        _animator.beginTimeline();
+    }
+    _animationNextChunk = 0; // Any error below aborts the upload.
+    
+    const char* err = nullptr;
+    for (JsonObjectConst entry : frames) {
+        bool appended;
+        if (!entry["loop"].isNull()) {
+            appended = _animator.appendLoopStart(entry["loop"] | 0, err);
+        } else if (entry["endLoop"] | false) {
+            appended = _animator.appendLoopEnd(err);
+        } else {
+            const char* text = entry["text"] | "";
+            uint8_t leftDots = entry["leftDots"] | 0;
+            uint8_t rightDots = entry["rightDots"] | 0;
+            uint8_t beep = entry["beep"] | 0;
+            uint16_t durationMs = entry["durationMs"] | 0;
+            
+            if (!validateDisplayTextParameters(text, beep, leftDots, rightDots)) {
+                err = "Invalid frame parameters";
+                appended = false;
+            } else if (durationMs < DISPLAY_ANIMATION_MIN_STEP_MS) {
+                err = "Frame 'durationMs' is below the minimum step";
+                appended = false;
+            } else {
+                appended = _animator.appendFrame(text, leftDots, rightDots, beep, durationMs, err);
+            }
+        }
+        if (!appended) {
+            sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, err);
+            return false;
+        }
+    }
+    
+    _responseResultDoc.clear();
+    _responseResultDoc["entries"] = _animator.getTimelineLength();
+    
+    if (more) {
+        _animationNextChunk = chunk + 1;
+        _responseResultDoc["status"] = "Chunk stored";
         sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
-    } else {
-        handleDGT3000Error(_dgt3000->getLastError());
-        sendCommandError(id, SystemErrorCode::I2C_COMMUNICATION_ERROR, "Failed to end display");
+        return true;
     }
-    return success;
+    
+    stopAnimation("preempted");
+    if (!_animator.startTimeline(millis(), err)) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, err);
+        return false;
+    }
+    _responseResultDoc["status"] = "Animation started";
+    _responseResultDoc["durationMs"] = _animator.getDurationMs();
+    sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+    return true;
+}
+
+bool I2CTaskManager::sendDisplayResponse(const char* id, const char* successStatus, const char* errorMessage) {
+    if (!flushDisplay(false)) {
+        sendCommandError(id, SystemErrorCode::I2C_COMMUNICATION_ERROR, errorMessage);
+        return false;
+    }
+    
+    // A change arriving within the flush interval is written later by serviceDisplay().
+    _responseResultDoc.clear();
+    _responseResultDoc["status"] = _display.isDirty() ? "Display update pending" : successStatus;
+    sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+    return true;
 }
 
 bool I2CTaskManager::executeStop(const char* id) {
     bool success = _dgt3000->stop();
     if (success) {
+        recordClockSet(DGT_MODE_STOP, DGT_MODE_STOP);
         _responseResultDoc.clear();
         _responseResultDoc["status"] = "Timers stopped successfully";
         sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
@@ -476,6 +984,7 @@ bool I2CTaskManager::executeRun(const char* id, const JsonObjectConst& params) {
     
     bool success = _dgt3000->run(leftMode, rightMode);
     if (success) {
+        recordClockSet(leftMode, rightMode);
         _responseResultDoc.clear();
         _responseResultDoc["status"] = "Timers started successfully";
         sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
@@ -489,6 +998,8 @@ bool I2CTaskManager::executeRun(const char* id, const JsonObjectConst& params) {
 bool I2CTaskManager::executeGetTime(const char* id) {
     uint8_t time[6];
     if (_dgt3000->getTime(time)) {
+        // Whole seconds as displayed, and milliseconds from the clock model.
+        int64_t nowUs = esp_timer_get_time();
         _responseResultDoc.clear();
         auto& result = _responseResultDoc;
         result["leftHours"] = time[0];
@@ -497,6 +1008,10 @@ bool I2CTaskManager::executeGetTime(const char* id) {
         result["rightHours"] = time[3];
         result["rightMinutes"] = time[4];
         result["rightSeconds"] = time[5];
+        result["leftTimeMs"] = _clockModel.getTimeMs(TimeControlEngine::Side::LEFT, nowUs);
+        result["rightTimeMs"] = _clockModel.getTimeMs(TimeControlEngine::Side::RIGHT, nowUs);
+        result["interpolated"] = _clockModel.isInterpolating();
+        result["gatewayTimeUs"] = nowUs;
         sendCommandResponse(id, true, result.as<JsonObjectConst>());
         return true;
     } else {
@@ -507,6 +1022,7 @@ bool I2CTaskManager::executeGetTime(const char* id) {
 }
 
 bool I2CTaskManager::executeGetStatus(const char* id) {
+    // Kept within one notification: the ring and pool details are in getQueueStats.
     _responseResultDoc.clear();
     auto& result = _responseResultDoc;
     result["dgtConnected"] = isDGT3000Connected();
@@ -514,6 +1030,50 @@ bool I2CTaskManager::executeGetStatus(const char* id) {
     result["bleConnected"] = _bleConnected;
     result["lastUpdateTime"] = _lastUpdateTime;
     result["recoveryAttempts"] = _recoveryAttempts;
+    result["commandsExpired"] = _stats.commandsExpired;
+    result["gatewayTime"] = millis();
+    
+    JsonObject schedule = result["schedule"].to<JsonObject>();
+    schedule["commands"] = _scheduledCommands.size();
+    schedule["jobs"] = _jobScheduler.count();
+    schedule["lastJitterUs"] = _stats.scheduleLastJitterUs;
+    schedule["maxJitterUs"] = _stats.scheduleMaxJitterUs;
+    
+    JsonObject display = result["display"].to<JsonObject>();
+    display["updates"] = _display.getUpdateCount();
+    display["flushes"] = _display.getFlushCount();
+    display["flushIntervalMs"] = _display.getFlushInterval();
+    display["animation"] = getAnimationModeString(_animator.getMode());
+    
+    JsonObject timeControl = result["timeControl"].to<JsonObject>();
+    timeControl["mode"] = _timeControl.isEnabled() ? getTimeControlModeString(_timeControl.getMode()) : "off";
+    timeControl["moves"] = _stats.timeControlMoves;
+    timeControl["lastLatencyUs"] = _stats.timeControlLastLatencyUs;
+    timeControl["maxLatencyUs"] = _stats.timeControlMaxLatencyUs;
+    result["moveLogMoves"] = _moveLog.getTotal();
+    result["clockDriftPpm"] = _clockModel.getDriftPpm();
+    
+    const TimeFrameAnalyzer::Stats& timeStats = _timeAnalyzer.getStats();
+    JsonObject timeFrames = result["timeFrames"].to<JsonObject>();
+    timeFrames["frames"] = timeStats.frames;
+    timeFrames["missingSeconds"] = timeStats.missingSeconds;
+    timeFrames["duplicates"] = timeStats.duplicateFrames;
+    timeFrames["irregularGaps"] = timeStats.irregularGaps;
+    if (timeStats.minGapMs != UINT32_MAX) timeFrames["minGapMs"] = timeStats.minGapMs;
+    timeFrames["maxGapMs"] = timeStats.maxGapMs;
+    if (timeStats.driftSpanSeconds > 0) {
+        timeFrames["driftPpm"] = timeStats.driftPpm;
+        timeFrames["driftSpanS"] = timeStats.driftSpanSeconds;
+    }
+    if (_queueManager) {
+        timeFrames["superseded"] = _queueManager->getTimeMailbox().getSupersededCount();
+    }
+    
+    if (_systemStatus) {
+        JsonObject responseCache = result["responseCache"].to<JsonObject>();
+        responseCache["hits"] = _systemStatus->responseCacheHits;
+        responseCache["misses"] = _systemStatus->responseCacheMisses;
+    }
     
     if (_dgt3000) {
         result["lastDgtError"] = _dgt3000->getLastError();
@@ -524,18 +1084,351 @@ bool I2CTaskManager::executeGetStatus(const char* id) {
     return true;
 }
 
+bool I2CTaskManager::executeGetQueueStats(const char* id) {
+    _responseResultDoc.clear();
+    if (_queueManager) {
+        _queueManager->reportMetrics(_responseResultDoc.to<JsonObject>());
+    }
+    sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+    return true;
+}
+
+bool I2CTaskManager::executeDefineMacro(const char* id, const JsonObjectConst& params) {
+    JsonVariantConst handle = params["handle"];
+    if (!handle.is<uint8_t>()) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'handle' must be an integer from 0 to 255");
+        return false;
+    }
+    
+    const char* errorMessage = nullptr;
+    SystemErrorCode error = _macroStore.define(handle.as<uint8_t>(), params["steps"], params["persist"] | false, errorMessage);
+    if (error != SystemErrorCode::SUCCESS) {
+        sendCommandError(id, error, errorMessage);
+        return false;
+    }
+    
+    _responseResultDoc.clear();
+    _responseResultDoc["handle"] = handle.as<uint8_t>();
+    _responseResultDoc["macroCount"] = _macroStore.count();
+    sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+    return true;
+}
+
+uint8_t I2CTaskManager::runMacroSteps(const char* id, const JsonObjectConst& overrides) {
+    _macroCapture.active = true;
+    _macroCapture.success = true;
+    _macroResultDoc.clear();
+    
+    uint8_t stepsExecuted = 0;
+    for (JsonObject step : _macroStepsDoc.as<JsonArray>()) {
+        // Overrides apply to every step; parameters a command does not use are ignored.
+        if (!overrides.isNull()) {
+            JsonObject stepParams = step["params"];
+            if (stepParams.isNull()) stepParams = step["params"].to<JsonObject>();
+            for (JsonPairConst kv : overrides) {
+                stepParams[kv.key()] = kv.value();
+            }
+        }
+        
+        executeCommand(id, step["command"], step["params"].as<JsonObjectConst>());
+        stepsExecuted++;
+        if (!_macroCapture.success) break;
+    }
+    
+    _macroCapture.active = false;
+    return stepsExecuted;
+}
+
+bool I2CTaskManager::executeInvoke(const char* id, const JsonObjectConst& params) {
+    JsonVariantConst handle = params["handle"];
+    if (!handle.is<uint8_t>()) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'handle' must be an integer from 0 to 255");
+        return false;
+    }
+    
+    _macroStepsDoc.clear();
+    if (!_macroStore.load(handle.as<uint8_t>(), _macroStepsDoc)) {
+        sendCommandError(id, SystemErrorCode::MACRO_NOT_DEFINED);
+        return false;
+    }
+    
+    uint8_t stepsExecuted = runMacroSteps(id, params["overrides"]);
+    
+    if (!_macroCapture.success) {
+        char message[APP_MAX_ERROR_MESSAGE_LENGTH];
+        snprintf(message, sizeof(message), "Step %u: %.100s", stepsExecuted, _macroCapture.errorMessage);
+        sendCommandError(id, _macroCapture.errorCode, message);
+        return false;
+    }
+    
+    _responseResultDoc.clear();
+    _responseResultDoc["handle"] = handle.as<uint8_t>();
+    _responseResultDoc["steps"] = stepsExecuted;
+    _responseResultDoc["result"] = _macroResultDoc;
+    sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+    return true;
+}
+
+bool I2CTaskManager::executeSchedule(const char* id, const JsonObjectConst& params) {
+    uint32_t periodMs = params["periodMs"] | 0;
+    uint32_t count = params["count"] | 0;
+    if (periodMs < SCHEDULER_MIN_PERIOD_MS) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'periodMs' is below the minimum period");
+        return false;
+    }
+    
+    int jobId;
+    JsonVariantConst macro = params["macro"];
+    if (!macro.isNull()) {
+        if (!macro.is<uint8_t>() || !_macroStore.exists(macro.as<uint8_t>())) {
+            sendCommandError(id, SystemErrorCode::MACRO_NOT_DEFINED);
+            return false;
+        }
+        jobId = _jobScheduler.add(periodMs, count, macro.as<uint8_t>(), nullptr, 0);
+    } else {
+        // Store the command like a one-step macro, validated and encoded once.
+        _macroStepsDoc.clear();
+        JsonObject step = _macroStepsDoc.add<JsonObject>();
+        step["command"] = params["command"];
+        step["params"] = params["params"];
+        
+        const char* errorMessage = nullptr;
+        if (!_macroStore.validateStep(step, errorMessage)) {
+            sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, errorMessage);
+            return false;
+        }
+        
+        uint8_t encoded[SCHEDULER_JOB_MAX_ENCODED_SIZE];
+        size_t size = serializeMsgPack(_macroStepsDoc, encoded, sizeof(encoded));
+        if (size == 0 || size >= sizeof(encoded)) {
+            sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "Scheduled command too large");
+            return false;
+        }
+        jobId = _jobScheduler.add(periodMs, count, -1, encoded, size);
+    }
+    
+    if (jobId < 0) {
+        sendCommandError(id, SystemErrorCode::SCHEDULE_FULL, "Too many scheduled jobs");
+        return false;
+    }
+    
+    _responseResultDoc.clear();
+    _responseResultDoc["jobId"] = jobId;
+    _responseResultDoc["periodMs"] = periodMs;
+    _responseResultDoc["count"] = count;
+    sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+    return true;
+}
+
+bool I2CTaskManager::executeUnschedule(const char* id, const JsonObjectConst& params) {
+    JsonVariantConst jobId = params["jobId"];
+    if (!jobId.is<uint8_t>() || !_jobScheduler.remove(jobId.as<uint8_t>())) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "Unknown 'jobId'");
+        return false;
+    }
+    
+    _responseResultDoc.clear();
+    _responseResultDoc["jobId"] = jobId.as<uint8_t>();
+    _responseResultDoc["jobCount"] = _jobScheduler.count();
+    sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+    return true;
+}
+
+bool I2CTaskManager::executeConfigureTimeControl(const char* id, const JsonObjectConst& params) {
+    if (!(params["enabled"] | true)) {
+        _timeControl.disable();
+        _responseResultDoc.clear();
+        _responseResultDoc["status"] = "Time control disabled";
+        sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+        return true;
+    }
+    
+    TimeControlEngine::Mode mode;
+    if (!parseTimeControlMode(params["mode"] | "none", mode)) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "Invalid 'mode'");
+        return false;
+    }
+    
+    JsonArrayConst periodsArray = params["periods"];
+    if (periodsArray.isNull() || periodsArray.size() == 0 || periodsArray.size() > TIME_CONTROL_MAX_PERIODS) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'periods' must have 1 to 3 entries");
+        return false;
+    }
+    
+    TimeControlEngine::Period periods[TIME_CONTROL_MAX_PERIODS];
+    uint8_t count = 0;
+    for (JsonObjectConst period : periodsArray) {
+        periods[count].moves = period["moves"] | 0;
+        periods[count].seconds = period["seconds"] | 0;
+        periods[count].incrementSeconds = period["increment"] | 0;
+        count++;
+    }
+    
+    TimeControlEngine::ClockSetting initial;
+    const char* err = nullptr;
+    if (!_timeControl.configure(mode, periods, count, initial, err)) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, err);
+        return false;
+    }
+    _leverInverted = params["invertLever"] | false;
+    _moveLog.clear();
+    
+    // Both sides start stopped with the time of the first period; the first lever move starts the game.
+    if (!applyClockSetting(initial)) {
+        _timeControl.disable();
+        sendCommandError(id, SystemErrorCode::I2C_COMMUNICATION_ERROR, "Failed to set time on DGT3000");
+        return false;
+    }
+    
+    _responseResultDoc.clear();
+    _responseResultDoc["status"] = "Time control configured";
+    _responseResultDoc["mode"] = getTimeControlModeString(mode);
+    sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+    return true;
+}
+
+bool I2CTaskManager::executeGetMoveLog(const char* id, const JsonObjectConst& params) {
+    const char* format = params["format"] | "binary";
+    bool pgn = strcmp(format, "pgn") == 0;
+    if (!pgn && strcmp(format, "binary") != 0) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'format' must be 'binary' or 'pgn'");
+        return false;
+    }
+    
+    // Moves already overwritten in the ring are skipped.
+    uint32_t from = params["from"] | 0;
+    if (from < _moveLog.getFirstAvailable()) from = _moveLog.getFirstAvailable();
+    
+    uint32_t total = _moveLog.getTotal();
+    uint32_t maxCount = pgn ? MOVE_LOG_PGN_CHUNK_RECORDS : MOVE_LOG_BINARY_CHUNK_RECORDS;
+    uint32_t count = (from < total) ? total - from : 0;
+    if (count > maxCount) count = maxCount;
+    
+    _responseResultDoc.clear();
+    auto& result = _responseResultDoc;
+    result["format"] = format;
+    result["from"] = from;
+    result["count"] = count;
+    result["total"] = total;
+    result["more"] = from + count < total;
+    
+    MoveRecord record;
+    if (pgn) {
+        JsonArray annotations = result["annotations"].to<JsonArray>();
+        for (uint32_t ply = from; ply < from + count && _moveLog.get(ply, record); ply++) {
+            uint32_t elapsed = (record.durationMs + 500) / 1000;
+            char annotation[48];
+            snprintf(annotation, sizeof(annotation), "{[%%clk %u:%02u:%02u] [%%emt %u:%02u:%02u]}",
+                     (unsigned)(record.remainingSeconds / 3600), (unsigned)((record.remainingSeconds / 60) % 60), (unsigned)(record.remainingSeconds % 60),
+                     (unsigned)(elapsed / 3600), (unsigned)((elapsed / 60) % 60), (unsigned)(elapsed % 60));
+            annotations.add(annotation);
+        }
+    } else {
+        // Little-endian records: side (0 = left, 1 = right), remaining seconds (16 bits),
+        // move duration in ms (32 bits), lever time in ms (32 bits).
+        uint8_t buffer[MOVE_LOG_BINARY_CHUNK_RECORDS * MOVE_LOG_BINARY_RECORD_SIZE];
+        size_t size = 0;
+        for (uint32_t ply = from; ply < from + count && _moveLog.get(ply, record); ply++) {
+            buffer[size++] = (record.side == TimeControlEngine::Side::LEFT) ? 0 : 1;
+            memcpy(&buffer[size], &record.remainingSeconds, 2);
+            memcpy(&buffer[size + 2], &record.durationMs, 4);
+            memcpy(&buffer[size + 6], &record.timestampMs, 4);
+            size += MOVE_LOG_BINARY_RECORD_SIZE - 1;
+        }
+        result["data"] = base64::encode(buffer, size);
+    }
+    
+    sendCommandResponse(id, true, result.as<JsonObjectConst>());
+    return true;
+}
+
+bool I2CTaskManager::executeClearMoveLog(const char* id) {
+    _moveLog.clear();
+    _responseResultDoc.clear();
+    _responseResultDoc["status"] = "Move log cleared";
+    sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+    return true;
+}
+
+bool I2CTaskManager::executeConfigureClockSync(const char* id, const JsonObjectConst& params) {
+    uint32_t intervalMs = params["intervalMs"] | 0;
+    if (intervalMs > 0 && intervalMs < CLOCK_SYNC_MIN_INTERVAL_MS) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'intervalMs' is below the minimum interval");
+        return false;
+    }
+    
+    _clockSyncIntervalMs = intervalMs;
+    _timeUpdatesEnabled = params["timeUpdates"] | true;
+    if (_clockSyncIntervalMs > 0) generateClockSyncEvent();
+    
+    _responseResultDoc.clear();
+    _responseResultDoc["intervalMs"] = _clockSyncIntervalMs;
+    _responseResultDoc["timeUpdates"] = _timeUpdatesEnabled;
+    sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+    return true;
+}
+
+bool I2CTaskManager::executeConfigureButtons(const char* id, const JsonObjectConst& params) {
+    // Omitted thresholds keep their current value.
+    ButtonGestureEngine::Config config = _buttonGestures.getConfig();
+    uint32_t longPressMs = params["longPressMs"] | (uint32_t)config.longPressMs;
+    uint32_t repeatDelayMs = params["repeatDelayMs"] | (uint32_t)config.repeatDelayMs;
+    uint32_t repeatIntervalMs = params["repeatIntervalMs"] | (uint32_t)config.repeatIntervalMs;
+    uint32_t doublePressMs = params["doublePressMs"] | (uint32_t)config.doublePressMs;
+
+    if (longPressMs > BUTTON_GESTURE_MAX_MS || repeatDelayMs > BUTTON_GESTURE_MAX_MS ||
+        repeatIntervalMs > BUTTON_GESTURE_MAX_MS || doublePressMs > BUTTON_GESTURE_MAX_MS) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "Threshold above the maximum");
+        return false;
+    }
+    if (repeatIntervalMs < BUTTON_REPEAT_INTERVAL_MIN_MS) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'repeatIntervalMs' is below the minimum interval");
+        return false;
+    }
+
+    config.longPressMs = longPressMs;
+    config.repeatDelayMs = repeatDelayMs;
+    config.repeatIntervalMs = repeatIntervalMs;
+    config.doublePressMs = doublePressMs;
+    _buttonGestures.setConfig(config);
+
+    _responseResultDoc.clear();
+    _responseResultDoc["longPressMs"] = config.longPressMs;
+    _responseResultDoc["repeatDelayMs"] = config.repeatDelayMs;
+    _responseResultDoc["repeatIntervalMs"] = config.repeatIntervalMs;
+    _responseResultDoc["doublePressMs"] = config.doublePressMs;
+    sendCommandResponse(id, true, _responseResultDoc.as<JsonObjectConst>());
+    return true;
+}
+
 // =============================================================================
 // RESPONSE HANDLING
 // =============================================================================
 
 void I2CTaskManager::sendCommandResponse(const char* id, bool success, const JsonObjectConst& result) {
+    if (_macroCapture.active) {
+        // Keep the outcome of the macro step; executeInvoke sends the response.
+        _macroCapture.success = success;
+        if (success) {
+            _macroResultDoc.set(result);
+        } else {
+            _macroCapture.errorCode = static_cast<SystemErrorCode>(result["errorCode"].as<int>());
+            const char* msg = result["errorMessage"] | "";
+            strncpy(_macroCapture.errorMessage, msg, APP_MAX_ERROR_MESSAGE_LENGTH - 1);
+            _macroCapture.errorMessage[APP_MAX_ERROR_MESSAGE_LENGTH - 1] = '\0';
+        }
+        return;
+    }
+    
     if (!_queueManager) return;
     
-    auto response = std::unique_ptr<CommandResponse>(new CommandResponse());
+    ResponsePtr response = _queueManager->acquireResponse();
+    if (!response) return;
     strncpy(response->id, id, APP_MAX_COMMAND_ID_LENGTH - 1);
     response->id[APP_MAX_COMMAND_ID_LENGTH - 1] = '\0';
     response->success = success;
     response->timestamp = millis();
+    response->format = _commandFormat;
 
     if (success) {
         response->result = result;
@@ -572,7 +1465,13 @@ void I2CTaskManager::generateButtonEvent() {
     uint8_t button;
     // Process all discrete button events from the DGT3000's internal buffer.
     while (_dgt3000->getButtonEvent(&button)) {
-        auto event = std::unique_ptr<DGTEvent>(new DGTEvent(DGTEvent::BUTTON_EVENT));
+        // Lever moves set the clock before being reported, to keep the players' time exact.
+        if (button == DGT_EVENT_LEVER_LEFT || button == DGT_EVENT_LEVER_RIGHT) {
+            handleLeverMove(button);
+        }
+        
+        auto event = _queueManager->acquireEvent(DGTEvent::BUTTON_EVENT);
+        if (!event) continue;
         event->priority = 0; // High priority
 
         JsonDocument& buttonData = event->data;
@@ -581,11 +1480,8 @@ void I2CTaskManager::generateButtonEvent() {
         buttonData["buttonCode"] = button;
         buttonData["isRepeat"] = false;
 
-        if (_queueManager->sendPriorityEvent(std::move(event), 2)) {
+        if (_queueManager->sendEvent(std::move(event), 2)) {
             _stats.eventsGenerated++;
-            // Reset repeat tracking on any new discrete event.
-            _buttonMonitoring.buttonRepeatActive = false;
-            _buttonMonitoring.buttonRepeatCount = 0;
             logI("Button event: %s (code: 0x%02X)", buttonName, button);
 
             // Displaying firmware version on DGT screen when no client connected
@@ -593,89 +1489,85 @@ void I2CTaskManager::generateButtonEvent() {
                 logI("Displaying firmware version on DGT screen.");
                 char versionString[12];
                 snprintf(versionString, sizeof(versionString), "%s-%s", BLE_PROTOCOL_VERSION, GATEWAY_APP_VERSION);
-                _dgt3000->displayText(versionString); // Display for 2 seconds
+                _display.setText(versionString);
+                flushDisplay(true);
             }
         }
     }
 }
 
-void I2CTaskManager::handleButtonRepeat() {
+void I2CTaskManager::handleButtonGestures() {
     if (!_queueManager || !_dgt3000) return;
 
-    uint8_t currentButtonState = _dgt3000->getButtonState();
-    uint32_t now = millis();
-    uint8_t mainButtonsState = currentButtonState & 0x1F; // Only main 5 buttons repeat
-
-    if (mainButtonsState != 0) {
-        // A main button is being held down.
-        if (!_buttonMonitoring.buttonRepeatActive) {
-            // First time detecting a hold, initialize repeat state.
-            _buttonMonitoring.buttonRepeatActive = true;
-            _buttonMonitoring.lastButtonState = mainButtonsState;
-            _buttonMonitoring.lastButtonTime = now;
-            _buttonMonitoring.buttonRepeatCount = 0;
-        }
-
-        if (_buttonMonitoring.lastButtonState == mainButtonsState) {
-            uint32_t holdDuration = now - _buttonMonitoring.lastButtonTime;
-            uint32_t repeatThreshold = (_buttonMonitoring.buttonRepeatCount == 0) ? 800 : 400;
+    // Changes are timestamped on arrival, so the gestures do not depend on the loop timing.
+    uint8_t state;
+    uint32_t timestampMicros;
+    while (_dgt3000->getButtonStateChange(&state, &timestampMicros)) {
+        uint32_t ageMs = (micros() - timestampMicros) / 1000;
+        _buttonGestures.onStateChange(state, millis() - ageMs);
+    }
+    _buttonGestures.update(millis());
 
-            if (holdDuration > repeatThreshold) {
-                _buttonMonitoring.buttonRepeatCount++;
-                _buttonMonitoring.lastButtonTime = now;
+    ButtonGestureEngine::GestureEvent gesture;
+    while (_buttonGestures.nextGesture(gesture)) {
+        generateButtonGestureEvent(gesture);
+    }
+}
 
-                auto event = std::unique_ptr<DGTEvent>(new DGTEvent(DGTEvent::BUTTON_EVENT));
-                event->priority = 0;
+void I2CTaskManager::generateButtonGestureEvent(const ButtonGestureEngine::GestureEvent& gesture) {
+    // Presses are already reported by generateButtonEvent(), with the combined
+    // code when several buttons are pressed together.
+    if (gesture.gesture == ButtonGestureEngine::Gesture::PRESS) return;
 
-                JsonDocument& buttonData = event->data;
-                const char* buttonName = getButtonName(mainButtonsState);
-                buttonData["button"] = buttonName;
-                buttonData["buttonCode"] = mainButtonsState;
-                buttonData["isRepeat"] = true;
-                buttonData["repeatCount"] = _buttonMonitoring.buttonRepeatCount;
-                
-                if (_queueManager->sendPriorityEvent(std::move(event), 2)) {
-                    _stats.eventsGenerated++;
-                    logI("Button repeat: %s (count: %d)", buttonName, _buttonMonitoring.buttonRepeatCount);
-                }
-            }
-        } else {
-            // A different button is being held, reset state.
-            _buttonMonitoring.buttonRepeatActive = false;
-            _buttonMonitoring.buttonRepeatCount = 0;
-        }
+    // Repeats keep the buttonEvent format for existing clients.
+    bool isRepeat = (gesture.gesture == ButtonGestureEngine::Gesture::REPEAT);
+    EventPtr event = _queueManager->acquireEvent(isRepeat ? DGTEvent::BUTTON_EVENT : DGTEvent::BUTTON_GESTURE);
+    if (!event) return;
 
+    const char* buttonName = getButtonName(gesture.button);
+    if (isRepeat) {
+        JsonDocument& buttonData = event->data;
+        buttonData["button"] = buttonName;
+        buttonData["buttonCode"] = gesture.button;
+        buttonData["isRepeat"] = true;
+        buttonData["repeatCount"] = gesture.repeatCount;
     } else {
-        // No main buttons are pressed, reset repeat logic.
-        _buttonMonitoring.buttonRepeatActive = false;
-        _buttonMonitoring.buttonRepeatCount = 0;
+        JsonDocument& gestureData = event->data;
+        gestureData["button"] = buttonName;
+        gestureData["buttonCode"] = gesture.button;
+        gestureData["gesture"] = getGestureString(gesture.gesture);
+        gestureData["durationMs"] = gesture.durationMs;
+    }
+    event->priority = 0;
+    event->timestamp = gesture.timestampMs;
+
+    if (_queueManager->sendEvent(std::move(event), 2)) {
+        _stats.eventsGenerated++;
+        logD("Button %s: %s (count: %u)", getGestureString(gesture.gesture), buttonName, gesture.repeatCount);
     }
 }
 
 void I2CTaskManager::generateTimeEvent(const uint8_t time[6]) {
     if (!_queueManager) return;
 
-    auto event = std::unique_ptr<DGTEvent>(new DGTEvent(DGTEvent::TIME_UPDATE));
-    event->priority = 1; // Lower priority
-
-    JsonDocument& timeData = event->data;
-    timeData["leftHours"] = time[0];
-    timeData["leftMinutes"] = time[1];
-    timeData["leftSeconds"] = time[2];
-    timeData["rightHours"] = time[3];
-    timeData["rightMinutes"] = time[4];
-    timeData["rightSeconds"] = time[5];
-
-    if (_queueManager->sendEvent(std::move(event), 2)) {
-        _stats.eventsGenerated++;
-        logD("Time event sent: L %d:%02d:%02d R %d:%02d:%02d", time[0], time[1], time[2], time[3], time[4], time[5]);
-    }
+    // Times only go to the latest-value mailbox: if the link is slow, older
+    // times are superseded instead of filling the event queue.
+    TimeSnapshot snapshot;
+    memcpy(snapshot.time, time, sizeof(snapshot.time));
+    snapshot.leftMode = _clockModel.getMode(TimeControlEngine::Side::LEFT);
+    snapshot.rightMode = _clockModel.getMode(TimeControlEngine::Side::RIGHT);
+    snapshot.timestamp = millis();
+    _queueManager->getTimeMailbox().publish(snapshot);
+
+    _stats.eventsGenerated++;
+    logD("Time published: L %d:%02d:%02d R %d:%02d:%02d", time[0], time[1], time[2], time[3], time[4], time[5]);
 }
 
 void I2CTaskManager::generateConnectionStatusEvent(bool connected, bool configured) {
     if (!_queueManager) return;
     
-    auto event = std::unique_ptr<DGTEvent>(new DGTEvent(DGTEvent::CONNECTION_STATUS));
+    auto event = _queueManager->acquireEvent(DGTEvent::CONNECTION_STATUS);
+    if (!event) return;
     event->data["connected"] = connected;
     event->data["configured"] = configured;
     
@@ -685,17 +1577,115 @@ void I2CTaskManager::generateConnectionStatusEvent(bool connected, bool configur
 void I2CTaskManager::generateErrorEvent(SystemErrorCode errorCode, const char* message) {
     if (!_queueManager) return;
     
-    auto event = std::unique_ptr<DGTEvent>(new DGTEvent(DGTEvent::ERROR_EVENT));
+    auto event = _queueManager->acquireEvent(DGTEvent::ERROR_EVENT);
+    if (!event) return;
     event->data["errorCode"] = static_cast<uint16_t>(errorCode);
     event->data["errorMessage"] = message ? message : getErrorCodeString(errorCode);
     
-    if (_queueManager->sendPriorityEvent(std::move(event), 100)) {
+    if (_queueManager->sendEvent(std::move(event), 100)) {
         logI("Error event sent: %s", message ? message : getErrorCodeString(errorCode));
     } else {
         logW("Failed to send error event: %s", message ? message : getErrorCodeString(errorCode));
     }
 }
 
+void I2CTaskManager::generateAnimationEndEvent(DisplayAnimator::Mode mode, const char* reason) {
+    if (!_queueManager) return;
+    
+    auto event = _queueManager->acquireEvent(DGTEvent::ANIMATION_END);
+    if (!event) return;
+    event->data["animation"] = getAnimationModeString(mode);
+    event->data["reason"] = reason;
+    
+    if (_queueManager->sendEvent(std::move(event), 2)) {
+        _stats.eventsGenerated++;
+        logI("Animation %s ended: %s", getAnimationModeString(mode), reason);
+    }
+}
+
+void I2CTaskManager::generateTimeControlEvent(TimeControlEngine::Side movedSide, const TimeControlEngine::ClockSetting& setting) {
+    if (!_queueManager) return;
+    
+    auto event = _queueManager->acquireEvent(DGTEvent::TIME_CONTROL);
+    if (!event) return;
+    JsonDocument& data = event->data;
+    data["side"] = getTimeControlSideString(movedSide);
+    data["moves"] = _timeControl.getMoves(movedSide);
+    data["period"] = _timeControl.getPeriod(movedSide) + 1;
+    data["running"] = getTimeControlSideString(setting.running);
+    data["delayPending"] = _timeControl.isDelayPending();
+    data["leftHours"] = setting.leftSeconds / 3600;
+    data["leftMinutes"] = (setting.leftSeconds / 60) % 60;
+    data["leftSeconds"] = setting.leftSeconds % 60;
+    data["rightHours"] = setting.rightSeconds / 3600;
+    data["rightMinutes"] = (setting.rightSeconds / 60) % 60;
+    data["rightSeconds"] = setting.rightSeconds % 60;
+    
+    if (_queueManager->sendEvent(std::move(event), 2)) {
+        _stats.eventsGenerated++;
+    }
+}
+
+void I2CTaskManager::generateFlagFallEvent(TimeControlEngine::Side side, int64_t flagUs, bool fromClock) {
+    if (!_queueManager) return;
+    
+    auto event = _queueManager->acquireEvent(DGTEvent::FLAG_FALL);
+    if (!event) return;
+    event->priority = 0; // High priority
+    event->data["side"] = getTimeControlSideString(side);
+    event->data["timestampUs"] = flagUs;
+    event->data["source"] = fromClock ? "clock" : "model";
+    
+    // Alert lane: the heaviest weight, and never dropped for other events.
+    if (_queueManager->sendEvent(std::move(event), 2)) {
+        _stats.eventsGenerated++;
+        logI("Flag fall: %s side (%s)", getTimeControlSideString(side), fromClock ? "clock" : "model");
+    }
+}
+
+void I2CTaskManager::generateTimeAnomalyEvent(const TimeFrameAnalyzer::Report& report) {
+    if (!_queueManager) return;
+    
+    // Bursts (e.g. a stalled bus) are summarized by the getStatus aggregates.
+    uint32_t now = millis();
+    if (_lastTimeAnomalyEventTime != 0 && now - _lastTimeAnomalyEventTime < TIME_ANALYZER_EVENT_MIN_INTERVAL_MS) return;
+    _lastTimeAnomalyEventTime = now;
+    
+    auto event = _queueManager->acquireEvent(DGTEvent::TIME_ANOMALY);
+    if (!event) return;
+    event->priority = 1; // Lower priority
+    JsonDocument& data = event->data;
+    data["anomaly"] = getTimeAnomalyString(report.anomaly);
+    if (report.side != TimeControlEngine::Side::NONE) data["side"] = getTimeControlSideString(report.side);
+    data["value"] = report.value;
+    
+    if (_queueManager->sendEvent(std::move(event), 2)) {
+        _stats.eventsGenerated++;
+        logW("Time anomaly: %s (%d)", getTimeAnomalyString(report.anomaly), report.value);
+    }
+}
+
+void I2CTaskManager::generateClockSyncEvent() {
+    if (!_queueManager) return;
+    _lastClockSyncTime = millis();
+    
+    int64_t nowUs = esp_timer_get_time();
+    auto event = _queueManager->acquireEvent(DGTEvent::CLOCK_SYNC);
+    if (!event) return;
+    event->priority = 1; // Lower priority
+    JsonDocument& data = event->data;
+    data["gatewayTimeUs"] = nowUs;
+    data["leftTimeMs"] = _clockModel.getTimeMs(TimeControlEngine::Side::LEFT, nowUs);
+    data["rightTimeMs"] = _clockModel.getTimeMs(TimeControlEngine::Side::RIGHT, nowUs);
+    data["leftMode"] = _clockModel.getMode(TimeControlEngine::Side::LEFT);
+    data["rightMode"] = _clockModel.getMode(TimeControlEngine::Side::RIGHT);
+    data["driftPpm"] = _clockModel.getDriftPpm();
+    
+    if (_queueManager->sendEvent(std::move(event), 2)) {
+        _stats.eventsGenerated++;
+    }
+}
+
 // =============================================================================
 // DGT3000 MANAGEMENT
 // =============================================================================
@@ -737,6 +1727,207 @@ void I2CTaskManager::handleDGT3000Error(int error) {
     }
 }
 
+// =============================================================================
+// DISPLAY MANAGEMENT
+// =============================================================================
+
+bool I2CTaskManager::flushDisplay(bool force) {
+    if (!_dgt3000 || !_display.isDirty()) return true;
+    
+    uint32_t now = millis();
+    if (!force && !_display.isFlushDue(now)) return true;
+    
+    const DisplayState& state = _display.getState();
+    bool success = state.overlayActive
+        ? _dgt3000->displayText(state.text, _display.getPendingBeep(), state.leftDots, state.rightDots)
+        : _dgt3000->endDisplay();
+    
+    if (!success) {
+        handleDGT3000Error(_dgt3000->getLastError());
+        return false;
+    }
+    _display.markFlushed(now);
+    return true;
+}
+
+void I2CTaskManager::serviceDisplay() {
+    // Draw the due animation frame; the clock shows its timers again once it completes.
+    DisplayAnimator::Mode mode = _animator.getMode();
+    if (_animator.update(millis(), _display)) {
+        _display.clear();
+        generateAnimationEndEvent(mode, "completed");
+    }
+    
+    if (!flushDisplay(false)) {
+        generateErrorEvent(SystemErrorCode::I2C_COMMUNICATION_ERROR, "Failed to update display on DGT3000");
+    }
+}
+
+void I2CTaskManager::stopAnimation(const char* reason) {
+    if (!_animator.isActive()) return;
+    
+    DisplayAnimator::Mode mode = _animator.getMode();
+    _animator.stop();
+    generateAnimationEndEvent(mode, reason);
+}
+
+// =============================================================================
+// TIME CONTROL
+// =============================================================================
+
+void I2CTaskManager::handleLeverMove(uint8_t leverEvent) {
+    int64_t startUs = esp_timer_get_time();
+    uint32_t now = millis();
+    bool leftSide = (leverEvent == DGT_EVENT_LEVER_LEFT) != _leverInverted;
+    TimeControlEngine::Side side = leftSide ? TimeControlEngine::Side::LEFT : TimeControlEngine::Side::RIGHT;
+    
+    uint8_t time[6];
+    if (!_dgt3000->getTime(time)) return;
+    uint32_t leftSeconds = time[0] * 3600UL + time[1] * 60UL + time[2];
+    uint32_t rightSeconds = time[3] * 3600UL + time[4] * 60UL + time[5];
+    
+    TimeControlEngine::ClockSetting setting;
+    bool applied = _timeControl.isEnabled() &&
+                   _timeControl.onMove(side, leftSeconds, rightSeconds, now, setting) &&
+                   applyClockSetting(setting);
+    if (applied) {
+        uint32_t latencyUs = (uint32_t)(esp_timer_get_time() - startUs);
+        _stats.timeControlMoves++;
+        _stats.timeControlLastLatencyUs = latencyUs;
+        if (latencyUs > _stats.timeControlMaxLatencyUs) _stats.timeControlMaxLatencyUs = latencyUs;
+        
+        // Reported once the clock is set: the client is informed, not consulted.
+        generateTimeControlEvent(side, setting);
+        leftSeconds = setting.leftSeconds;
+        rightSeconds = setting.rightSeconds;
+    }
+    
+    // Logged with the time left after the move, bonus included.
+    _moveLog.onLever(side, leftSide ? leftSeconds : rightSeconds, now);
+}
+
+void I2CTaskManager::serviceTimeControl() {
+    TimeControlEngine::ClockSetting setting;
+    if (_timeControl.update(millis(), setting) && applyClockSetting(setting)) {
+        generateTimeControlEvent(TimeControlEngine::Side::NONE, setting);
+    }
+}
+
+bool I2CTaskManager::applyClockSetting(const TimeControlEngine::ClockSetting& setting) {
+    uint8_t leftMode = (setting.running == TimeControlEngine::Side::LEFT) ? DGT_MODE_COUNT_DOWN : DGT_MODE_STOP;
+    uint8_t rightMode = (setting.running == TimeControlEngine::Side::RIGHT) ? DGT_MODE_COUNT_DOWN : DGT_MODE_STOP;
+    
+    bool success = _dgt3000->setAndRun(leftMode, setting.leftSeconds / 3600, (setting.leftSeconds / 60) % 60, setting.leftSeconds % 60,
+                                       rightMode, setting.rightSeconds / 3600, (setting.rightSeconds / 60) % 60, setting.rightSeconds % 60);
+    if (!success) {
+        // The clock state is unknown: wait for the next lever move or a client command.
+        handleDGT3000Error(_dgt3000->getLastError());
+        _timeControl.pause();
+        generateErrorEvent(SystemErrorCode::I2C_COMMUNICATION_ERROR, "Failed to apply time control on DGT3000");
+        return false;
+    }
+    recordClockSet(leftMode, rightMode);
+    return true;
+}
+
+// =============================================================================
+// CLOCK MODEL
+// =============================================================================
+
+void I2CTaskManager::recordClockSet(uint8_t leftMode, uint8_t rightMode) {
+    // The library keeps the times it has just written.
+    uint8_t time[6];
+    if (_dgt3000->getTime(time)) {
+        _clockModel.onClockSet(leftMode, rightMode, time, esp_timer_get_time());
+        _timeAnalyzer.reset();
+        
+        // Clients interpolating locally need the new modes at once.
+        if (_clockSyncIntervalMs > 0) generateClockSyncEvent();
+    }
+}
+
+void I2CTaskManager::checkFlagFall() {
+    TimeControlEngine::Side side;
+    int64_t flagUs;
+    bool fromClock;
+    while (_clockModel.checkFlagFall(esp_timer_get_time(), side, flagUs, fromClock)) {
+        generateFlagFallEvent(side, flagUs, fromClock);
+    }
+}
+
+void I2CTaskManager::serviceClockSync() {
+    if (_clockSyncIntervalMs == 0) return;
+    if (millis() - _lastClockSyncTime >= _clockSyncIntervalMs) {
+        generateClockSyncEvent();
+    }
+}
+
+// =============================================================================
+// COMMAND SCHEDULING
+// =============================================================================
+
+bool I2CTaskManager::scheduleCommand(RawCommandPtr rawCmd, const char* id, uint32_t atMs) {
+    // millis() is derived from esp_timer, so the gateway timestamp maps exactly onto it.
+    int64_t nowUs = esp_timer_get_time();
+    int32_t delayMs = (int32_t)(atMs - (uint32_t)(nowUs / 1000));
+    
+    if (delayMs > (int32_t)SCHEDULER_MAX_DELAY_MS) {
+        sendCommandError(id, SystemErrorCode::JSON_INVALID_PARAMETERS, "'at' is too far in the future");
+        return false;
+    }
+    if (_scheduledCommands.isFull()) {
+        sendCommandError(id, SystemErrorCode::SCHEDULE_FULL);
+        return false;
+    }
+    
+    int64_t dueTimeUs;
+    if (delayMs > 0) {
+        dueTimeUs = (nowUs / 1000 + delayMs) * 1000;
+    } else {
+        // Already due: run as soon as possible.
+        logW("Command ID %s received %ld ms after its 'at' time", id, -delayMs);
+        dueTimeUs = nowUs;
+    }
+    _scheduledCommands.push(rawCmd.release(), dueTimeUs);
+    
+    _stats.commandsScheduled++;
+    logI("Command ID %s scheduled in %ld ms (%u pending)", id, delayMs > 0 ? delayMs : 0, _scheduledCommands.size());
+    return true;
+}
+
+uint32_t I2CTaskManager::getSleepTimeMs(uint32_t elapsedMs) const {
+    uint32_t sleepMs = (elapsedMs < I2C_TASK_UPDATE_INTERVAL_MS) ? (I2C_TASK_UPDATE_INTERVAL_MS - elapsedMs) : 0;
+    
+    // Wake up for the next animation frame.
+    uint32_t untilFrameMs = _animator.getTimeUntilNextFrame(millis());
+    if (untilFrameMs < sleepMs) sleepMs = untilFrameMs;
+    
+    // Wake up for the next button repeat or long press.
+    uint32_t untilButtonMs = _buttonGestures.getTimeUntilNextTimer(millis());
+    if (untilButtonMs < sleepMs) sleepMs = untilButtonMs;
+    
+    // Wake up when a flag can fall.
+    int64_t untilFlagUs = _clockModel.getTimeUntilFlagUs(esp_timer_get_time());
+    if (untilFlagUs / 1000 < sleepMs) sleepMs = (uint32_t)(untilFlagUs / 1000);
+    
+    // Wake up before the next due time; the remaining time is busy-waited.
+    int64_t untilSpinUs = _scheduledCommands.getTimeUntilSpinUs(esp_timer_get_time());
+    if (untilSpinUs / 1000 < sleepMs) sleepMs = (uint32_t)(untilSpinUs / 1000);
+    return sleepMs;
+}
+
+bool I2CTaskManager::isBusReserved() const {
+    return _scheduledCommands.getTimeUntilSpinUs(esp_timer_get_time()) < SCHEDULER_BUS_GUARD_US;
+}
+
+void I2CTaskManager::clearScheduledCommands() {
+    int64_t dueTimeUs;
+    RawBLECommand* command;
+    while ((command = _scheduledCommands.pop(dueTimeUs)) != nullptr) {
+        _queueManager->adoptRawCommand(command); // The handle returns it to its pool.
+    }
+}
+
 // =============================================================================
 // ERROR RECOVERY
 // =============================================================================
@@ -830,7 +2021,8 @@ void I2CTaskManager::printStatus() {
 void I2CTaskManager::printStatistics() {
     logI("--- I2C Task Statistics ---");
     logI("Uptime: %lu ms", _stats.uptime);
-    logI("Commands: Rcvd=%lu, Exec=%lu, Fail=%lu", _stats.commandsReceived, _stats.commandsExecuted, _stats.commandsFailed);
+    logI("Commands: Rcvd=%lu, Exec=%lu, Fail=%lu, Expired=%lu", _stats.commandsReceived, _stats.commandsExecuted, _stats.commandsFailed, _stats.commandsExpired);
+    logI("Scheduled: %lu (pending %u), Jitter: last=%lu us, max=%lu us", _stats.commandsScheduled, _scheduledCommands.size(), _stats.scheduleLastJitterUs, _stats.scheduleMaxJitterUs);
     logI("Events Generated: %lu", _stats.eventsGenerated);
     logI("DGT Errors: %lu", _stats.dgtErrors);
     logI("Recovery Attempts: %lu", _stats.recoveryAttempts);
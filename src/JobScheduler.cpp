@@ -0,0 +1,168 @@
+/*
+ * Periodic Job Scheduler Implementation for DGT3000 Gateway
+ *
+ * This file implements the hashed timer wheel used by the I2C task to run
+ * recurring jobs registered with the "schedule" command.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "JobScheduler.h"
+#include <esp_timer.h>
+
+using namespace esp32m;
+
+// =============================================================================
+// JOB SCHEDULER IMPLEMENTATION
+// =============================================================================
+
+JobScheduler::JobScheduler()
+    : SimpleLoggable("jobs"), _currentTick(0), _nextJobId(1) {
+    memset(_jobs, 0, sizeof(_jobs));
+    clear();
+}
+
+int JobScheduler::add(uint32_t periodMs, uint32_t runCount, int16_t macroHandle, const uint8_t* data, size_t size) {
+    if (macroHandle < 0 && (!data || size == 0 || size > SCHEDULER_JOB_MAX_ENCODED_SIZE)) {
+        return -1;
+    }
+
+    int8_t index = -1;
+    for (size_t i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        if (!_jobs[i].used) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) return -1;
+
+    // Job IDs are never 0 and are not reused while a job holds them.
+    uint8_t jobId;
+    bool inUse;
+    do {
+        jobId = _nextJobId++;
+        inUse = (jobId == 0);
+        for (size_t i = 0; i < SCHEDULER_MAX_JOBS && !inUse; i++) {
+            inUse = _jobs[i].used && _jobs[i].id == jobId;
+        }
+    } while (inUse);
+
+    if (count() == 0) {
+        // The wheel does not advance while empty.
+        _currentTick = getNowTick();
+    }
+
+    Job& job = _jobs[index];
+    job.used = true;
+    job.id = jobId;
+    job.macroHandle = macroHandle;
+    job.periodTicks = (periodMs >= SCHEDULER_WHEEL_TICK_MS) ? (periodMs / SCHEDULER_WHEEL_TICK_MS) : 1;
+    job.remainingRuns = runCount;
+    job.nextRunTick = _currentTick; // First run on the next loop.
+    job.hasResult = false;
+    job.lastResultHash = 0;
+    job.size = (macroHandle < 0) ? size : 0;
+    if (macroHandle < 0) {
+        memcpy(job.data, data, size);
+    }
+    link(index);
+
+    logI("Job %u added (period %lu ms, count %lu)", jobId, periodMs, runCount);
+    return jobId;
+}
+
+bool JobScheduler::remove(uint8_t jobId) {
+    for (size_t i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        if (_jobs[i].used && _jobs[i].id == jobId) {
+            unlink(i);
+            _jobs[i].used = false;
+            logI("Job %u removed", jobId);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobScheduler::clear() {
+    for (size_t i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        _jobs[i].used = false;
+        _jobs[i].nextInSlot = -1;
+    }
+    for (size_t i = 0; i < SCHEDULER_WHEEL_SLOTS; i++) {
+        _slots[i] = -1;
+    }
+}
+
+JobScheduler::Job* JobScheduler::nextDue() {
+    if (count() == 0) return nullptr;
+
+    uint32_t nowTick = getNowTick();
+    while ((int32_t)(nowTick - _currentTick) >= 0) {
+        // A slot holds the jobs of every tick congruent to it; only the due ones run.
+        for (int8_t index = _slots[_currentTick % SCHEDULER_WHEEL_SLOTS]; index >= 0; index = _jobs[index].nextInSlot) {
+            if ((int32_t)(_jobs[index].nextRunTick - _currentTick) <= 0) {
+                unlink(index);
+                return &_jobs[index];
+            }
+        }
+        _currentTick++;
+    }
+    return nullptr;
+}
+
+void JobScheduler::reschedule(Job* job) {
+    if (!job || !job->used) return;
+
+    if (job->remainingRuns > 0 && --job->remainingRuns == 0) {
+        logI("Job %u completed", job->id);
+        job->used = false;
+        return;
+    }
+
+    // Keep the period drift-free, but skip runs missed during a stall.
+    job->nextRunTick += job->periodTicks;
+    if ((int32_t)(job->nextRunTick - _currentTick) <= 0) {
+        job->nextRunTick = _currentTick + 1;
+    }
+    link(job - _jobs);
+}
+
+uint8_t JobScheduler::count() const {
+    uint8_t n = 0;
+    for (size_t i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        if (_jobs[i].used) n++;
+    }
+    return n;
+}
+
+// =============================================================================
+// PRIVATE HELPER METHODS
+// =============================================================================
+
+uint32_t JobScheduler::getNowTick() const {
+    return (uint32_t)(esp_timer_get_time() / (SCHEDULER_WHEEL_TICK_MS * 1000));
+}
+
+void JobScheduler::link(int8_t index) {
+    size_t slot = _jobs[index].nextRunTick % SCHEDULER_WHEEL_SLOTS;
+    _jobs[index].nextInSlot = _slots[slot];
+    _slots[slot] = index;
+}
+
+void JobScheduler::unlink(int8_t index) {
+    size_t slot = _jobs[index].nextRunTick % SCHEDULER_WHEEL_SLOTS;
+    int8_t* link = &_slots[slot];
+    while (*link >= 0) {
+        if (*link == index) {
+            *link = _jobs[index].nextInSlot;
+            _jobs[index].nextInSlot = -1;
+            return;
+        }
+        link = &_jobs[*link].nextInSlot;
+    }
+}
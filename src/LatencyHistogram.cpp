@@ -0,0 +1,87 @@
+/*
+ * Latency Histogram Implementation for DGT3000 Gateway
+ *
+ * This file implements the bucketing and the percentiles of the queue
+ * residency histograms.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "LatencyHistogram.h"
+
+// =============================================================================
+// LATENCY HISTOGRAM IMPLEMENTATION
+// =============================================================================
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::record(uint32_t valueUs) {
+    _buckets[bucketOf(valueUs)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    if (valueUs > _max.load(std::memory_order_relaxed)) {
+        _max.store(valueUs, std::memory_order_relaxed); // Single writer: no compare-and-swap needed.
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+uint32_t LatencyHistogram::getPercentile(uint8_t percent) const {
+    // Counted from the buckets rather than _count, so that a sample recorded
+    // during the walk cannot push the rank past the last bucket.
+    uint32_t counts[BUCKET_COUNT];
+    uint32_t total = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        counts[i] = _buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) return 0;
+
+    uint32_t rank = ((uint64_t)total * percent + 99) / 100;
+    if (rank == 0) rank = 1;
+
+    uint32_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            uint32_t bound = bucketUpperBound(i);
+            uint32_t max = getMax();
+            return (bound < max) ? bound : max;
+        }
+    }
+    return getMax();
+}
+
+// =============================================================================
+// PRIVATE HELPER METHODS
+// =============================================================================
+
+size_t LatencyHistogram::bucketOf(uint32_t valueUs) {
+    if (valueUs < SUB_BUCKETS) return valueUs; // Exact below the first power of two split.
+
+    uint32_t exponent = 31 - __builtin_clz(valueUs);
+    uint32_t shift = exponent - LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+    uint32_t sub = (valueUs >> shift) & (SUB_BUCKETS - 1);
+    return SUB_BUCKETS * (shift + 1) + sub;
+}
+
+uint32_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < SUB_BUCKETS) return index;
+
+    uint32_t shift = index / SUB_BUCKETS - 1;
+    uint32_t sub = index % SUB_BUCKETS;
+    uint32_t lower = (SUB_BUCKETS + sub) << shift;
+    return lower + ((1UL << shift) - 1);
+}
@@ -43,7 +43,12 @@ LedManager::LedManager()
 
 void LedManager::initialize() {
     if (NEOPIXEL_LED_ENABLED) {
+#if GATEWAY_STATIC_ALLOCATION
+        static Adafruit_NeoPixel neoPixel(1, LED_NEOPIXEL_PIN, NEO_GRB + NEO_KHZ800);
+        pixels = &neoPixel;
+#else
         pixels = new Adafruit_NeoPixel(1, LED_NEOPIXEL_PIN, NEO_GRB + NEO_KHZ800);
+#endif
         if (pixels) {
             pixels->begin();
             pixels->setBrightness(NEOPIXEL_GENERAL_BRIGHTNESS);
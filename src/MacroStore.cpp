@@ -0,0 +1,235 @@
+/*
+ * Command Macro Store Implementation for DGT3000 Gateway
+ *
+ * This file implements the validation, MessagePack encoding and optional
+ * NVS persistence of client-registered command macros.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "MacroStore.h"
+#include "DGT3000.h"
+#include <Preferences.h>
+
+using namespace esp32m;
+
+// NVS layout: one blob per persistent macro ("m<handle>") and a 256-bit
+// bitmap ("index") listing the handles to load at boot.
+static const char* MACRO_NVS_INDEX_KEY = "index";
+
+static void getMacroNVSKey(uint8_t handle, char* key, size_t keySize) {
+    snprintf(key, keySize, "m%u", handle);
+}
+
+// =============================================================================
+// MACRO STORE IMPLEMENTATION
+// =============================================================================
+
+MacroStore::MacroStore() : SimpleLoggable("macro") {
+    memset(_macros, 0, sizeof(_macros));
+}
+
+void MacroStore::begin() {
+    Preferences prefs;
+    if (!prefs.begin(MACRO_NVS_NAMESPACE, true)) {
+        logD("No persistent macros");
+        return;
+    }
+
+    uint8_t index[32] = {0};
+    prefs.getBytes(MACRO_NVS_INDEX_KEY, index, sizeof(index));
+
+    for (uint16_t handle = 0; handle < 256; handle++) {
+        if (!(index[handle / 8] & (1 << (handle % 8)))) continue;
+
+        char key[8];
+        getMacroNVSKey(handle, key, sizeof(key));
+        size_t size = prefs.getBytesLength(key);
+        Macro* macro = allocate();
+        if (!macro || size == 0 || size > MACRO_MAX_ENCODED_SIZE) {
+            logW("Cannot load persistent macro %u", handle);
+            continue;
+        }
+
+        macro->size = prefs.getBytes(key, macro->data, size);
+        macro->handle = handle;
+        macro->persistent = true;
+        macro->used = true;
+    }
+    prefs.end();
+
+    logI("%u persistent macro(s) loaded", count());
+}
+
+SystemErrorCode MacroStore::define(uint8_t handle, JsonArrayConst steps, bool persist, const char*& errorMessage) {
+    errorMessage = nullptr;
+
+    if (steps.isNull() || steps.size() == 0 || steps.size() > MACRO_MAX_STEPS) {
+        errorMessage = "'steps' must be an array of 1 to 8 commands";
+        return SystemErrorCode::JSON_INVALID_PARAMETERS;
+    }
+
+    // Validate every step now, so that invoke only has to apply overrides.
+    for (JsonObjectConst step : steps) {
+        if (!validateStep(step, errorMessage)) {
+            return SystemErrorCode::JSON_INVALID_PARAMETERS;
+        }
+    }
+
+    size_t size = measureMsgPack(steps);
+    if (size > MACRO_MAX_ENCODED_SIZE) {
+        errorMessage = "Macro too large";
+        return SystemErrorCode::MACRO_STORE_FULL;
+    }
+
+    Macro* macro = find(handle);
+    if (!macro) macro = allocate();
+    if (!macro) {
+        errorMessage = "No free macro slot";
+        return SystemErrorCode::MACRO_STORE_FULL;
+    }
+
+    bool wasPersistent = macro->used && macro->persistent;
+    macro->size = serializeMsgPack(steps, macro->data, sizeof(macro->data));
+    macro->handle = handle;
+    macro->persistent = persist;
+    macro->used = true;
+
+    if (persist) {
+        saveToNVS(*macro);
+    } else if (wasPersistent) {
+        removeFromNVS(handle);
+    }
+
+    logI("Macro %u defined (%u steps, %u bytes%s)", handle, steps.size(), macro->size, persist ? ", persistent" : "");
+    return SystemErrorCode::SUCCESS;
+}
+
+bool MacroStore::load(uint8_t handle, JsonDocument& doc) {
+    Macro* macro = find(handle);
+    if (!macro) return false;
+
+    DeserializationError error = deserializeMsgPack(doc, macro->data, macro->size);
+    if (error) {
+        logE("Failed to decode macro %u: %s", handle, error.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool MacroStore::exists(uint8_t handle) {
+    return find(handle) != nullptr;
+}
+
+uint8_t MacroStore::count() const {
+    uint8_t n = 0;
+    for (size_t i = 0; i < MACRO_MAX_COUNT; i++) {
+        if (_macros[i].used) n++;
+    }
+    return n;
+}
+
+// =============================================================================
+// PRIVATE HELPER METHODS
+// =============================================================================
+
+MacroStore::Macro* MacroStore::find(uint8_t handle) {
+    for (size_t i = 0; i < MACRO_MAX_COUNT; i++) {
+        if (_macros[i].used && _macros[i].handle == handle) return &_macros[i];
+    }
+    return nullptr;
+}
+
+MacroStore::Macro* MacroStore::allocate() {
+    for (size_t i = 0; i < MACRO_MAX_COUNT; i++) {
+        if (!_macros[i].used) return &_macros[i];
+    }
+    return nullptr;
+}
+
+bool MacroStore::validateStep(JsonObjectConst step, const char*& errorMessage) const {
+    const char* command = step["command"];
+    JsonObjectConst params = step["params"];
+
+    if (!command) {
+        errorMessage = "Macro step without 'command'";
+        return false;
+    }
+
+    if (strcmp(command, "setTime") == 0) {
+        if (!validateTimeParameters(params["leftMode"], params["leftHours"], params["leftMinutes"], params["leftSeconds"],
+                                    params["rightMode"], params["rightHours"], params["rightMinutes"], params["rightSeconds"])) {
+            errorMessage = "Invalid time parameters in macro step";
+            return false;
+        }
+    } else if (strcmp(command, "displayText") == 0) {
+        // The text may be supplied by the invoke overrides.
+        const char* text = params["text"];
+        if (text && !validateDisplayTextParameters(text, params["beep"] | 0, params["leftDots"] | 0, params["rightDots"] | 0)) {
+            errorMessage = "Invalid display text parameters in macro step";
+            return false;
+        }
+    } else if (strcmp(command, "run") == 0) {
+        if (!validateRunParameters(params["leftMode"], params["rightMode"])) {
+            errorMessage = "Invalid run parameters in macro step";
+            return false;
+        }
+    } else if (strcmp(command, "endDisplay") != 0 &&
+               strcmp(command, "updateDisplay") != 0 &&
+               strcmp(command, "stop") != 0 &&
+               strcmp(command, "getTime") != 0 &&
+               strcmp(command, "getStatus") != 0) {
+        // Macros cannot define or invoke other macros, nor schedule jobs.
+        errorMessage = "Command not allowed in a macro";
+        return false;
+    }
+    return true;
+}
+
+void MacroStore::saveToNVS(const Macro& macro) {
+    Preferences prefs;
+    if (!prefs.begin(MACRO_NVS_NAMESPACE, false)) {
+        logE("Failed to open NVS namespace '%s'", MACRO_NVS_NAMESPACE);
+        return;
+    }
+
+    char key[8];
+    getMacroNVSKey(macro.handle, key, sizeof(key));
+    if (prefs.putBytes(key, macro.data, macro.size) != macro.size) {
+        logE("Failed to save macro %u to NVS", macro.handle);
+    }
+    prefs.end();
+
+    writeNVSIndex();
+}
+
+void MacroStore::removeFromNVS(uint8_t handle) {
+    Preferences prefs;
+    if (!prefs.begin(MACRO_NVS_NAMESPACE, false)) return;
+
+    char key[8];
+    getMacroNVSKey(handle, key, sizeof(key));
+    prefs.remove(key);
+    prefs.end();
+
+    writeNVSIndex();
+}
+
+void MacroStore::writeNVSIndex() {
+    uint8_t index[32] = {0};
+    for (size_t i = 0; i < MACRO_MAX_COUNT; i++) {
+        if (_macros[i].used && _macros[i].persistent) {
+            index[_macros[i].handle / 8] |= (1 << (_macros[i].handle % 8));
+        }
+    }
+
+    Preferences prefs;
+    if (!prefs.begin(MACRO_NVS_NAMESPACE, false)) return;
+    prefs.putBytes(MACRO_NVS_INDEX_KEY, index, sizeof(index));
+    prefs.end();
+}
@@ -0,0 +1,58 @@
+/*
+ * Move Log Implementation for DGT3000 Gateway
+ *
+ * This file implements the ring of per-move clock records.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "MoveLog.h"
+
+// =============================================================================
+// MOVE LOG IMPLEMENTATION
+// =============================================================================
+
+MoveLog::MoveLog() {
+    clear();
+}
+
+void MoveLog::clear() {
+    _total = 0;
+    _lastSide = TimeControlEngine::Side::NONE;
+    _lastLeverTime = 0;
+}
+
+bool MoveLog::onLever(TimeControlEngine::Side side, uint32_t remainingSeconds, uint32_t now) {
+    if (side == _lastSide) return false;
+
+    TimeControlEngine::Side previousSide = _lastSide;
+    uint32_t moveStartTime = _lastLeverTime;
+    _lastSide = side;
+    _lastLeverTime = now;
+
+    // The first lever move starts the clock of the opponent: no move has been played yet.
+    if (previousSide == TimeControlEngine::Side::NONE) return false;
+
+    MoveRecord& record = _records[_total % MOVE_LOG_CAPACITY];
+    record.timestampMs = now;
+    record.durationMs = now - moveStartTime;
+    record.remainingSeconds = (remainingSeconds > UINT16_MAX) ? UINT16_MAX : remainingSeconds;
+    record.side = side;
+    _total++;
+    return true;
+}
+
+bool MoveLog::get(uint32_t ply, MoveRecord& record) const {
+    if (ply >= _total || ply < getFirstAvailable()) return false;
+    record = _records[ply % MOVE_LOG_CAPACITY];
+    return true;
+}
+
+uint32_t MoveLog::getFirstAvailable() const {
+    return (_total > MOVE_LOG_CAPACITY) ? _total - MOVE_LOG_CAPACITY : 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * Notification Packer Implementation for DGT3000 Gateway
+ *
+ * This file implements the framing and packing of the messages sent as
+ * BLE notifications.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "NotificationPacker.h"
+
+using namespace esp32m;
+
+// =============================================================================
+// NOTIFICATION PACKER IMPLEMENTATION
+// =============================================================================
+
+NotificationPacker::NotificationPacker(const char* name, Framing framing)
+    : SimpleLoggable(name),
+      _framing(framing),
+      _characteristic(nullptr),
+      _mutex(nullptr),
+      _payloadSize(BLE_DEFAULT_MTU - BLE_NOTIFY_HEADER_SIZE),
+      _packetLength(0),
+      _packetMessages(0),
+      _sequence(0),
+      _resync(false),
+      _notifyFailed(false),
+      _failedStatus(SUCCESS_NOTIFY),
+      _notifications(0),
+      _messages(0),
+      _failedNotifications(0),
+      _lostMessages(0) {
+}
+
+NotificationPacker::~NotificationPacker() {
+    if (_mutex != nullptr) {
+        vSemaphoreDelete(_mutex);
+        _mutex = nullptr;
+    }
+}
+
+bool NotificationPacker::initialize(BLECharacteristic* characteristic) {
+    if (_mutex == nullptr) {
+#if GATEWAY_STATIC_ALLOCATION
+        _mutex = xSemaphoreCreateMutexStatic(&_mutexBuffer);
+#else
+        _mutex = xSemaphoreCreateMutex();
+#endif
+    }
+    if (_mutex == nullptr) {
+        logE("Failed to create notification packer mutex");
+        return false;
+    }
+    _characteristic = characteristic;
+    if (_characteristic) {
+        _characteristic->setCallbacks(this);
+    }
+    return true;
+}
+
+void NotificationPacker::setMtu(uint16_t mtu) {
+    uint16_t payloadSize = (mtu > BLE_PREFERRED_MTU) ? BLE_PREFERRED_MTU - BLE_NOTIFY_HEADER_SIZE
+                         : (mtu < BLE_DEFAULT_MTU) ? BLE_DEFAULT_MTU - BLE_NOTIFY_HEADER_SIZE
+                         : mtu - BLE_NOTIFY_HEADER_SIZE;
+    _payloadSize.store(payloadSize, std::memory_order_relaxed);
+    logI("MTU %u, notifications of up to %u bytes", mtu, payloadSize);
+}
+
+bool NotificationPacker::send(const uint8_t* message, size_t length, bool flushNow) {
+    if (!_characteristic || !message || _mutex == nullptr) return false;
+    if (xSemaphoreTake(_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return false;
+
+    size_t headerSize = (_framing == LENGTH_PREFIXED) ? 1 : 0;
+    size_t framedLength = length + (_framing == LENGTH_PREFIXED ? 2 : 1);
+    size_t payloadSize = getPayloadSize();
+
+    // A message that fits a notification is never split: it starts the next one instead.
+    if (_packetLength > 0 && _packetLength + framedLength > payloadSize && headerSize + framedLength <= payloadSize) {
+        notifyPacket();
+    }
+
+    // If a notification carrying the message fails, the rest of it is discarded.
+    bool written;
+    if (_framing == LENGTH_PREFIXED) {
+        uint8_t prefix[2] = { (uint8_t)length, (uint8_t)(length >> 8) };
+        written = write(prefix, sizeof(prefix), payloadSize, true) &&
+                  write(message, length, payloadSize, false);
+    } else {
+        const uint8_t newline = '\n';
+        written = write(message, length, payloadSize, true) &&
+                  write(&newline, 1, payloadSize, false);
+    }
+    if (written) {
+        _messages++;
+    }
+
+    if (flushNow && _packetLength > 0) {
+        notifyPacket();
+    }
+
+    xSemaphoreGive(_mutex);
+    return true;
+}
+
+void NotificationPacker::flush() {
+    if (_mutex == nullptr) return;
+    if (xSemaphoreTake(_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return;
+
+    if (_packetLength > 0) {
+        notifyPacket();
+    }
+
+    xSemaphoreGive(_mutex);
+}
+
+void NotificationPacker::reset() {
+    if (_mutex == nullptr) return;
+    if (xSemaphoreTake(_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return;
+
+    _packetLength = 0;
+    _packetMessages = 0;
+    _sequence = 0;
+    _resync = false;
+    _payloadSize.store(BLE_DEFAULT_MTU - BLE_NOTIFY_HEADER_SIZE, std::memory_order_relaxed);
+
+    xSemaphoreGive(_mutex);
+}
+
+void NotificationPacker::onStatus(BLECharacteristic* characteristic, Status status, uint32_t code) {
+    if (status != SUCCESS_NOTIFY && status != SUCCESS_INDICATE) {
+        _notifyFailed = true;
+        _failedStatus = status;
+    }
+}
+
+// =============================================================================
+// PRIVATE HELPER METHODS
+// =============================================================================
+
+bool NotificationPacker::write(const uint8_t* data, size_t length, size_t payloadSize, bool messageStart) {
+    while (length > 0) {
+        if (_packetLength == 0) {
+            beginPacket(messageStart);
+        }
+        if (messageStart) {
+            _packetMessages++;
+            messageStart = false;
+        }
+
+        size_t room = payloadSize - _packetLength;
+        size_t chunk = (length < room) ? length : room;
+        memcpy(_packet + _packetLength, data, chunk);
+        _packetLength += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if (_packetLength == payloadSize && !notifyPacket()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void NotificationPacker::beginPacket(bool messageStart) {
+    // A packet that continues a message carries it too.
+    _packetMessages = messageStart ? 0 : 1;
+
+    if (_framing == LENGTH_PREFIXED) {
+        // The client detects a lost notification by a gap in the sequence,
+        // then waits for a notification that starts with a message.
+        _packet[_packetLength++] = (messageStart ? HEADER_START_FLAG : 0) | (_sequence & HEADER_SEQUENCE_MASK);
+        _sequence++;
+    } else if (_resync) {
+        // Ends the partial line the client may hold, so that it is dropped alone.
+        _packet[_packetLength++] = '\n';
+    }
+    _resync = false;
+}
+
+bool NotificationPacker::notifyPacket() {
+    _notifyFailed = false;
+    _characteristic->setValue(_packet, _packetLength);
+    _characteristic->notify();
+    _packetLength = 0;
+
+    if (!_notifyFailed) {
+        _notifications++;
+        _packetMessages = 0;
+        return true;
+    }
+
+    _failedNotifications.fetch_add(1, std::memory_order_relaxed);
+    _lostMessages.fetch_add(_packetMessages, std::memory_order_relaxed);
+    logW("Notification failed (status %d), %u message(s) lost", (int)_failedStatus, _packetMessages);
+    _packetMessages = 0;
+    _resync = true;
+    return false;
+}
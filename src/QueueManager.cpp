@@ -1,5 +1,5 @@
 /*
- * FreeRTOS Queue Management Utilities Implementation
+ * Queue Management Utilities Implementation
  *
  * This file implements the thread-safe queue operations for inter-task
  * communication within the DGT3000 BLE Gateway.
@@ -22,11 +22,13 @@ using namespace esp32m;
 // =============================================================================
 
 QueueManager::QueueManager()
-    : SimpleLoggable("queue"), _queueMutex(nullptr), _lastHealthCheck(0), _healthy(false) {
-    // Initialize queue handles to null.
-    _queues.rawCommandQueue = nullptr;
-    _queues.eventQueue = nullptr;
-    _queues.responseQueue = nullptr;
+    : SimpleLoggable("queue"), _initialized(false), _heldEventCount(0), _heldEventPeak(0), _receiveTimeouts(0),
+      _lastHealthCheck(0), _healthy(false) {
+    for (uint8_t type = 0; type < EVENT_TYPE_COUNT; type++) {
+        _latestEvents[type].store(nullptr, std::memory_order_relaxed);
+        _latestEventStamps[type].store(0, std::memory_order_relaxed);
+    }
+    memset(_eventLaneCredits, 0, sizeof(_eventLaneCredits));
 }
 
 QueueManager::~QueueManager() {
@@ -34,104 +36,119 @@ QueueManager::~QueueManager() {
 }
 
 bool QueueManager::initialize() {
-    // Create a mutex for thread-safe access to queue operations.
-    _queueMutex = xSemaphoreCreateMutex();
-    if (_queueMutex == nullptr) {
-        logE("Failed to create queue mutex");
-        return false;
-    }
-    
-    // Create the queue for raw commands (BLE -> I2C).
-    // The queue stores pointers to dynamically allocated RawBLECommand objects.
-    if (!createQueue(_queues.rawCommandQueue, sizeof(RawBLECommand*), QUEUE_COMMAND_SIZE, "RawCommandQueue")) {
-        logE("Failed to create raw command queue");
-        cleanup();
-        return false;
-    }
-    
-    // Create the queue for events (I2C -> BLE).
-    // The queue stores pointers to dynamically allocated DGTEvent objects.
-    if (!createQueue(_queues.eventQueue, sizeof(DGTEvent*), QUEUE_EVENT_SIZE, "EventQueue")) {
-        logE("Failed to create event queue");
-        cleanup();
-        return false;
-    }
-    
-    // Create the queue for command responses (I2C -> BLE).
-    if (!createQueue(_queues.responseQueue, sizeof(CommandResponse*), QUEUE_COMMAND_SIZE, "ResponseQueue")) {
-        logE("Failed to create response queue");
-        cleanup();
-        return false;
-    }
-    
+    // The rings are members: there is nothing to allocate, only state to reset.
     resetStatistics();
     _lastHealthCheck = millis();
     _healthy = true;
+    _initialized = true;
     
     logI("Queue Manager initialized successfully");
     return true;
 }
 
 void QueueManager::cleanup() {
+    if (!_initialized) return;
     logI("Cleaning up Queue Manager...");
     
-    // Destroying the queues also frees any items still within them.
-    flushAllQueues(); // Ensure dynamic memory is freed before deleting queues.
-    destroyQueue(_queues.rawCommandQueue);
-    destroyQueue(_queues.eventQueue);
-    destroyQueue(_queues.responseQueue);
-    
-    if (_queueMutex != nullptr) {
-        vSemaphoreDelete(_queueMutex);
-        _queueMutex = nullptr;
+    flushAllQueues(); // The rings hold owning pointers: return the items still within them to their pools.
+    for (uint8_t i = 0; i < _heldEventCount; i++) {
+        _eventPool.adopt(_heldEvents[i].event);
     }
-    
+    _heldEventCount = 0;
+    _initialized = false;
     _healthy = false;
     logI("Queue Manager cleanup complete");
 }
 
 bool QueueManager::isInitialized() const {
-    return _queues.isInitialized() && (_queueMutex != nullptr);
+    return _initialized;
+}
+
+// =============================================================================
+// MESSAGE POOLS
+// =============================================================================
+
+RawCommandPtr QueueManager::acquireRawCommand() {
+    RawCommandPtr rawCmd = _rawCommandPool.acquire();
+    if (!rawCmd) logW("Raw command pool exhausted");
+    return rawCmd;
+}
+
+EventPtr QueueManager::acquireEvent(DGTEvent::Type type) {
+    EventPtr event = _eventPool.acquire(type);
+    if (!event) logW("Event pool exhausted, dropping: %s", getEventTypeString(type));
+    return event;
+}
+
+ResponsePtr QueueManager::acquireResponse() {
+    ResponsePtr response = _responsePool.acquire("");
+    if (!response) logW("Response pool exhausted");
+    return response;
 }
 
 // =============================================================================
-// RAW COMMAND QUEUE OPERATIONS
+// RAW COMMAND LANE OPERATIONS
 // =============================================================================
 
-bool QueueManager::sendRawCommand(std::unique_ptr<RawBLECommand> rawData, uint32_t timeoutMs) {
+bool QueueManager::sendRawCommand(RawCommandPtr rawData, uint32_t timeoutMs) {
     if (!isInitialized() || !rawData) return false;
     
-    RawBLECommand* rawPtr = rawData.release(); // Release ownership to a raw pointer.
-    if (sendToQueueSafe(_queues.rawCommandQueue, &rawPtr, sizeof(RawBLECommand*), timeoutMs)) {
-        logD("Raw command sent to queue (len: %d)", rawPtr->length);
+    RawBLECommand* rawPtr = rawData.get();
+    bool success = (rawPtr->lane == CommandLane::DISPLAY)
+        ? pushEntry(_displayCommandRing, QueueId::DISPLAY_COMMAND, rawPtr, timeoutMs, micros())
+        : pushEntry(_controlCommandRing, QueueId::CONTROL_COMMAND, rawPtr, timeoutMs, micros());
+    if (success) {
+        rawData.release(); // The ring owns the command now.
+        logD("Raw command sent to %s lane (len: %d)", getCommandLaneString(rawPtr->lane), rawPtr->length);
         return true;
     } else {
-        logW("Failed to send raw command to queue (len: %d), deleting command.", rawPtr->length);
-        delete rawPtr; // Prevent memory leak if sending fails.
+        // The handle returns the command to its pool.
+        logW("Failed to send raw command to %s lane (len: %d), dropping command.", getCommandLaneString(rawPtr->lane), rawPtr->length);
         return false;
     }
 }
 
-std::unique_ptr<RawBLECommand> QueueManager::receiveRawCommand(uint32_t timeoutMs) {
+RawCommandPtr QueueManager::receiveRawCommand(uint32_t timeoutMs) {
     if (!isInitialized()) return nullptr;
     
     RawBLECommand* rawPtr = nullptr;
-    if (receiveFromQueueSafe(_queues.rawCommandQueue, &rawPtr, sizeof(RawBLECommand*), timeoutMs)) {
-        logD("Raw command received from queue (len: %d)", rawPtr->length);
-        return std::unique_ptr<RawBLECommand>(rawPtr); // Re-wrap in unique_ptr to manage lifetime.
+    
+    // The control lane is never waited on, so a pending stop/run is always
+    // picked up before any display command, whatever the display backlog.
+    if (popEntry(_controlCommandRing, QueueId::CONTROL_COMMAND, rawPtr, 0) ||
+        popEntry(_displayCommandRing, QueueId::DISPLAY_COMMAND, rawPtr, timeoutMs)) {
+        logD("Raw command received from %s lane (len: %d)", getCommandLaneString(rawPtr->lane), rawPtr->length);
+        return _rawCommandPool.adopt(rawPtr); // Re-wrap in a handle to manage lifetime.
     }
     
+    if (timeoutMs > 0) _receiveTimeouts.fetch_add(1, std::memory_order_relaxed);
     return nullptr;
 }
 
 uint16_t QueueManager::getRawCommandQueueDepth() const {
-    if (!isInitialized()) return 0;
-    return uxQueueMessagesWaiting(_queues.rawCommandQueue);
+    return getCommandLaneDepth(CommandLane::CONTROL) + getCommandLaneDepth(CommandLane::DISPLAY);
 }
 
 uint16_t QueueManager::getRawCommandQueueFreeSpace() const {
+    return getCommandLaneFreeSpace(CommandLane::CONTROL) + getCommandLaneFreeSpace(CommandLane::DISPLAY);
+}
+
+uint16_t QueueManager::getCommandLaneDepth(CommandLane lane) const {
+    if (!isInitialized()) return 0;
+    return (lane == CommandLane::DISPLAY) ? _displayCommandRing.size() : _controlCommandRing.size();
+}
+
+uint16_t QueueManager::getCommandLaneFreeSpace(CommandLane lane) const {
     if (!isInitialized()) return 0;
-    return uxQueueSpacesAvailable(_queues.rawCommandQueue);
+    return (lane == CommandLane::DISPLAY) ? _displayCommandRing.freeSpace() : _controlCommandRing.freeSpace();
+}
+
+uint32_t QueueManager::getRetryAfterMs(CommandLane lane) const {
+    QueueId id = (lane == CommandLane::DISPLAY) ? QueueId::DISPLAY_COMMAND : QueueId::CONTROL_COMMAND;
+    uint32_t waitMs = getQueueMetrics(id).residency.getPercentile(50) / 1000;
+    if (waitMs < BUSY_RETRY_AFTER_MIN_MS) return BUSY_RETRY_AFTER_MIN_MS;
+    if (waitMs > BUSY_RETRY_AFTER_MAX_MS) return BUSY_RETRY_AFTER_MAX_MS;
+    return waitMs;
 }
 
 bool QueueManager::isRawCommandQueueFull() const {
@@ -143,47 +160,120 @@ bool QueueManager::isRawCommandQueueEmpty() const {
 }
 
 // =============================================================================
-// EVENT QUEUE OPERATIONS
+// EVENT LANE OPERATIONS
 // =============================================================================
 
-bool QueueManager::sendEvent(std::unique_ptr<DGTEvent> event, uint32_t timeoutMs) {
+bool QueueManager::sendEvent(EventPtr event, uint32_t timeoutMs) {
     if (!isInitialized() || !event) return false;
 
-    DGTEvent* rawPtr = event.release();
-    bool success = sendToQueueSafe(_queues.eventQueue, &rawPtr, sizeof(DGTEvent*), timeoutMs);
-    updateQueueStats(true, success, false);
+    DGTEvent* rawPtr = event.get();
+    EventLane lane = getEventLane(rawPtr->type);
+    bool success;
+    if (getEventDropPolicy(lane) == EventDropPolicy::NEVER) {
+        // The events of the lane already held go first, so the order is kept.
+        retryHeldEvents();
+        success = (!hasHeldEvents(lane) && pushEventLane(lane, rawPtr, micros(), timeoutMs, false)) ||
+                  holdEvent(rawPtr);
+    } else {
+        success = pushEventLane(lane, rawPtr, micros(), timeoutMs, true);
+    }
 
     if (success) {
-        logD("Event sent: %s", getEventTypeString(rawPtr->type));
+        event.release();
+        logD("Event sent to %s lane: %s", getEventLaneString(lane), getEventTypeString(rawPtr->type));
+    } else if (getEventDropPolicy(lane) == EventDropPolicy::NEVER) {
+        // Only happens when the client stopped reading: the lane and the held events are full.
+        _metrics[(uint8_t)getEventQueueId(lane)].dropped.fetch_add(1, std::memory_order_relaxed);
+        logE("%s lane and held events full, dropping: %s", getEventLaneString(lane), getEventTypeString(rawPtr->type));
     } else {
-        logW("Failed to send event, deleting: %s", getEventTypeString(rawPtr->type));
-        delete rawPtr;
+        logW("%s lane full, dropping: %s", getEventLaneString(lane), getEventTypeString(rawPtr->type));
     }
     return success;
 }
 
-std::unique_ptr<DGTEvent> QueueManager::receiveEvent(uint32_t timeoutMs) {
+void QueueManager::retryHeldEvents() {
+    if (!isInitialized() || _heldEventCount == 0) return;
+
+    // Push the held events in order; once an event of a lane stays held, the
+    // following events of that lane stay behind it.
+    bool blocked[(uint8_t)EventLane::COUNT] = {};
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < _heldEventCount; i++) {
+        HeldEvent held = _heldEvents[i];
+        EventLane lane = getEventLane(held.event->type);
+        if (!blocked[(uint8_t)lane] && pushEventLane(lane, held.event, held.heldUs, 0, false)) {
+            continue;
+        }
+        blocked[(uint8_t)lane] = true;
+        _heldEvents[kept++] = held;
+    }
+    _heldEventCount = kept;
+}
+
+EventPtr QueueManager::receiveEvent() {
     if (!isInitialized()) return nullptr;
 
+    // Smooth weighted round robin over the lanes holding events: each of them
+    // gains its weight, the one with the most credit is served and pays the
+    // total. A busy lane gets its share without starving the others, and the
+    // order is interleaved rather than in bursts.
+    int16_t totalWeight = 0;
+    int8_t selected = -1;
+    for (uint8_t i = 0; i < (uint8_t)EventLane::COUNT; i++) {
+        if (getEventLaneDepth((EventLane)i) == 0) {
+            _eventLaneCredits[i] = 0;
+            continue;
+        }
+        uint8_t weight = getEventLaneWeight((EventLane)i);
+        _eventLaneCredits[i] += weight;
+        totalWeight += weight;
+        if (selected < 0 || _eventLaneCredits[i] > _eventLaneCredits[selected]) {
+            selected = i;
+        }
+    }
+    if (selected < 0) return nullptr;
+    _eventLaneCredits[selected] -= totalWeight;
+
     DGTEvent* rawPtr = nullptr;
-    bool success = receiveFromQueueSafe(_queues.eventQueue, &rawPtr, sizeof(DGTEvent*), timeoutMs);
-    updateQueueStats(false, success, false);
+    if (!popEventLane((EventLane)selected, rawPtr)) return nullptr;
 
-    if (success) {
-        logD("Event received: %s", getEventTypeString(rawPtr->type));
-        return std::unique_ptr<DGTEvent>(rawPtr);
+    logD("Event received from %s lane: %s", getEventLaneString((EventLane)selected), getEventTypeString(rawPtr->type));
+    return _eventPool.adopt(rawPtr);
+}
+
+uint16_t QueueManager::getEventLaneDepth(EventLane lane) const {
+    if (!isInitialized()) return 0;
+    switch (lane) {
+        case EventLane::ALERT:
+            return _alertEventRing.size();
+        case EventLane::BUTTON:
+            return _buttonEventRing.size();
+        case EventLane::RESULT:
+            return _resultEventRing.size();
+        default: {
+            uint16_t pending = 0;
+            for (uint8_t type = 0; type < EVENT_TYPE_COUNT; type++) {
+                if (getEventLane((DGTEvent::Type)type) == lane && _latestEvents[type].load(std::memory_order_acquire)) {
+                    pending++;
+                }
+            }
+            return pending;
+        }
     }
-    return nullptr;
 }
 
 uint16_t QueueManager::getEventQueueDepth() const {
-    if (!isInitialized()) return 0;
-    return uxQueueMessagesWaiting(_queues.eventQueue);
+    uint16_t depth = 0;
+    for (uint8_t i = 0; i < (uint8_t)EventLane::COUNT; i++) {
+        depth += getEventLaneDepth((EventLane)i);
+    }
+    return depth;
 }
 
 uint16_t QueueManager::getEventQueueFreeSpace() const {
     if (!isInitialized()) return 0;
-    return uxQueueSpacesAvailable(_queues.eventQueue);
+    // The KEEP_LATEST lanes always accept an event.
+    return _alertEventRing.freeSpace() + _buttonEventRing.freeSpace() + _resultEventRing.freeSpace();
 }
 
 bool QueueManager::isEventQueueFull() const {
@@ -198,42 +288,43 @@ bool QueueManager::isEventQueueEmpty() const {
 // RESPONSE QUEUE OPERATIONS
 // =============================================================================
 
-bool QueueManager::sendResponse(std::unique_ptr<CommandResponse> response, uint32_t timeoutMs) {
+bool QueueManager::sendResponse(ResponsePtr response, uint32_t timeoutMs) {
     if (!isInitialized() || !response) return false;
 
-    CommandResponse* rawPtr = response.release();
-    bool success = sendToQueueSafe(_queues.responseQueue, &rawPtr, sizeof(CommandResponse*), timeoutMs);
+    CommandResponse* rawPtr = response.get();
+    bool success = pushEntry(_responseRing, QueueId::RESPONSE, rawPtr, timeoutMs, micros());
     
     if (success) {
+        response.release();
         logD("Response sent for ID: %s", rawPtr->id);
     } else {
-        logW("Failed to send response, deleting for ID: %s", rawPtr->id);
-        delete rawPtr;
+        logW("Failed to send response, dropping for ID: %s", rawPtr->id);
     }
     return success;
 }
 
-std::unique_ptr<CommandResponse> QueueManager::receiveResponse(uint32_t timeoutMs) {
+ResponsePtr QueueManager::receiveResponse(uint32_t timeoutMs) {
     if (!isInitialized()) return nullptr;
 
     CommandResponse* rawPtr = nullptr;
-    bool success = receiveFromQueueSafe(_queues.responseQueue, &rawPtr, sizeof(CommandResponse*), timeoutMs);
+    bool success = popEntry(_responseRing, QueueId::RESPONSE, rawPtr, timeoutMs);
     
     if (success) {
         logD("Response received for ID: %s", rawPtr->id);
-        return std::unique_ptr<CommandResponse>(rawPtr);
+        return _responsePool.adopt(rawPtr);
     }
+    if (timeoutMs > 0) _receiveTimeouts.fetch_add(1, std::memory_order_relaxed);
     return nullptr;
 }
 
 uint16_t QueueManager::getResponseQueueDepth() const {
     if (!isInitialized()) return 0;
-    return uxQueueMessagesWaiting(_queues.responseQueue);
+    return _responseRing.size();
 }
 
 uint16_t QueueManager::getResponseQueueFreeSpace() const {
     if (!isInitialized()) return 0;
-    return uxQueueSpacesAvailable(_queues.responseQueue);
+    return _responseRing.freeSpace();
 }
 
 bool QueueManager::isResponseQueueFull() const {
@@ -245,45 +336,92 @@ bool QueueManager::isResponseQueueEmpty() const {
 }
 
 // =============================================================================
-// PRIORITY OPERATIONS
+// STATISTICS AND MONITORING
 // =============================================================================
 
-bool QueueManager::sendPriorityEvent(std::unique_ptr<DGTEvent> event, uint32_t timeoutMs) {
-    if (!isInitialized() || !event) return false;
-    
-    DGTEvent* rawPtr = event.release();
-    if (xQueueSendToFront(_queues.eventQueue, &rawPtr, pdMS_TO_TICKS(timeoutMs)) == pdTRUE) {
-        logI("Priority event queued: %s", getEventTypeString(rawPtr->type));
-        updateQueueStats(true, true, false);
-        return true;
+void QueueManager::QueueMetrics::reset() {
+    enqueued.store(0, std::memory_order_relaxed);
+    dequeued.store(0, std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+    highWater.store(0, std::memory_order_relaxed);
+    residency.reset();
+}
+
+QueueStats QueueManager::getStatistics() const {
+    const QueueMetrics& control = getQueueMetrics(QueueId::CONTROL_COMMAND);
+    const QueueMetrics& display = getQueueMetrics(QueueId::DISPLAY_COMMAND);
+
+    QueueStats stats;
+    stats.commandsQueued = control.enqueued.load(std::memory_order_relaxed) + display.enqueued.load(std::memory_order_relaxed);
+    stats.commandsProcessed = control.dequeued.load(std::memory_order_relaxed) + display.dequeued.load(std::memory_order_relaxed);
+    // The lanes fill independently: the deepest lane is the one worth watching.
+    uint32_t controlHighWater = control.highWater.load(std::memory_order_relaxed);
+    uint32_t displayHighWater = display.highWater.load(std::memory_order_relaxed);
+    stats.maxCommandQueueDepth = (controlHighWater > displayHighWater) ? controlHighWater : displayHighWater;
+
+    stats.eventsQueued = 0;
+    stats.eventsProcessed = 0;
+    stats.maxEventQueueDepth = 0;
+    for (uint8_t i = 0; i < (uint8_t)EventLane::COUNT; i++) {
+        const QueueMetrics& lane = getQueueMetrics(getEventQueueId((EventLane)i));
+        stats.eventsQueued += lane.enqueued.load(std::memory_order_relaxed);
+        stats.eventsProcessed += lane.dequeued.load(std::memory_order_relaxed);
+        uint32_t highWater = lane.highWater.load(std::memory_order_relaxed);
+        if (highWater > stats.maxEventQueueDepth) stats.maxEventQueueDepth = highWater;
     }
-    
-    logW("Failed to queue priority event, deleting: %s", getEventTypeString(rawPtr->type));
-    delete rawPtr;
-    updateQueueStats(true, false, false);
-    return false;
-}
 
-// =============================================================================
-// STATISTICS AND MONITORING
-// =============================================================================
-
-const QueueStats& QueueManager::getStatistics() const {
-    return _stats;
+    stats.queueOverflows = 0;
+    for (uint8_t i = 0; i < (uint8_t)QueueId::COUNT; i++) {
+        stats.queueOverflows += _metrics[i].dropped.load(std::memory_order_relaxed);
+    }
+    stats.queueTimeouts = _receiveTimeouts.load(std::memory_order_relaxed);
+    return stats;
 }
 
 void QueueManager::resetStatistics() {
-    _stats = QueueStats();
+    for (uint8_t i = 0; i < (uint8_t)QueueId::COUNT; i++) {
+        _metrics[i].reset();
+    }
+    _receiveTimeouts.store(0, std::memory_order_relaxed);
     logD("Queue statistics reset");
 }
 
-void QueueManager::updateStatistics() {
-    if (!isInitialized()) return;
-    
-    uint16_t evtDepth = getEventQueueDepth();
-    if (evtDepth > _stats.maxEventQueueDepth) {
-        _stats.maxEventQueueDepth = evtDepth;
+uint32_t QueueManager::getWorstResidencyP99() const {
+    uint32_t worst = 0;
+    for (uint8_t i = 0; i < (uint8_t)QueueId::COUNT; i++) {
+        uint32_t p99 = _metrics[i].residency.getPercentile(99);
+        if (p99 > worst) worst = p99;
     }
+    return worst;
+}
+
+void QueueManager::reportMetrics(JsonObject stats) const {
+    JsonObject rings = stats["rings"].to<JsonObject>();
+    for (uint8_t i = 0; i < (uint8_t)QueueId::COUNT; i++) {
+        const QueueMetrics& metrics = _metrics[i];
+        JsonObject ring = rings[getQueueIdString((QueueId)i)].to<JsonObject>();
+        ring["enq"] = metrics.enqueued.load(std::memory_order_relaxed);
+        ring["drop"] = metrics.dropped.load(std::memory_order_relaxed);
+        ring["hw"] = metrics.highWater.load(std::memory_order_relaxed);
+        ring["p50"] = metrics.residency.getPercentile(50);
+        ring["p99"] = metrics.residency.getPercentile(99);
+        ring["max"] = metrics.residency.getMax();
+    }
+
+    JsonObject pools = stats["pools"].to<JsonObject>();
+    const ObjectPoolStats poolStats[] = { getRawCommandPoolStats(), getEventPoolStats(), getResponsePoolStats() };
+    const char* const poolNames[] = { "cmd", "evt", "resp" };
+    uint32_t heapFallbacks = 0;
+    for (size_t i = 0; i < 3; i++) {
+        JsonObject pool = pools[poolNames[i]].to<JsonObject>();
+        pool["use"] = poolStats[i].inUse;
+        pool["peak"] = poolStats[i].peakInUse;
+        pool["exh"] = poolStats[i].exhausted;
+        heapFallbacks += poolStats[i].heapFallbacks;
+    }
+    stats["heapFallbacks"] = heapFallbacks;
+    stats["held"] = _heldEventCount;
+    stats["heldPeak"] = _heldEventPeak;
 }
 
 bool QueueManager::isHealthy() {
@@ -313,17 +451,17 @@ bool QueueManager::isHealthy() {
 
 float QueueManager::getRawCommandQueueUtilization() const {
     if (!isInitialized()) return 0.0f;
-    return (float)getRawCommandQueueDepth() / QUEUE_COMMAND_SIZE;
+    return (float)getRawCommandQueueDepth() / (QUEUE_CONTROL_COMMAND_SIZE + QUEUE_DISPLAY_COMMAND_SIZE);
 }
 
 float QueueManager::getEventQueueUtilization() const {
     if (!isInitialized()) return 0.0f;
-    return (float)getEventQueueDepth() / QUEUE_EVENT_SIZE;
+    return (float)getEventQueueDepth() / (QUEUE_ALERT_EVENT_SIZE + QUEUE_BUTTON_EVENT_SIZE + QUEUE_RESULT_EVENT_SIZE);
 }
 
 float QueueManager::getResponseQueueUtilization() const {
     if (!isInitialized()) return 0.0f;
-    return (float)getResponseQueueDepth() / QUEUE_COMMAND_SIZE;
+    return (float)getResponseQueueDepth() / QUEUE_RESPONSE_SIZE;
 }
 
 // =============================================================================
@@ -340,19 +478,19 @@ void QueueManager::flushAllQueues() {
 void QueueManager::flushRawCommandQueue() {
     if (!isInitialized()) return;
     
-    std::unique_ptr<RawBLECommand> rawCmd;
+    RawCommandPtr rawCmd;
     while ((rawCmd = receiveRawCommand(0)) != nullptr) {
-        // unique_ptr automatically deletes the object.
+        // The handle returns the object to its pool.
     }
-    logW("Raw command queue flushed.");
+    logW("Raw command lanes flushed.");
 }
 
 void QueueManager::flushEventQueue() {
     if (!isInitialized()) return;
     
-    std::unique_ptr<DGTEvent> event;
-    while ((event = receiveEvent(0)) != nullptr) {
-        // unique_ptr automatically deletes the object.
+    EventPtr event;
+    while ((event = receiveEvent()) != nullptr) {
+        // The handle returns the object to its pool.
     }
     logW("Event queue flushed.");
 }
@@ -360,9 +498,9 @@ void QueueManager::flushEventQueue() {
 void QueueManager::flushResponseQueue() {
     if (!isInitialized()) return;
     
-    std::unique_ptr<CommandResponse> response;
+    ResponsePtr response;
     while ((response = receiveResponse(0)) != nullptr) {
-        // unique_ptr automatically deletes the object.
+        // The handle returns the object to its pool.
     }
     logW("Response queue flushed.");
 }
@@ -378,58 +516,186 @@ void QueueManager::printQueueStatus() {
     }
     
     logI("--- Queue Status ---");
-    logI("Raw Command: %d/%d (%.1f%%)", getRawCommandQueueDepth(), QUEUE_COMMAND_SIZE, getRawCommandQueueUtilization() * 100);
-    logI("Event: %d/%d (%.1f%%)", getEventQueueDepth(), QUEUE_EVENT_SIZE, getEventQueueUtilization() * 100);
-    logI("Response: %d/%d (%.1f%%)", getResponseQueueDepth(), QUEUE_COMMAND_SIZE, getResponseQueueUtilization() * 100);
+    logI("Control Command: %d/%d", getCommandLaneDepth(CommandLane::CONTROL), QUEUE_CONTROL_COMMAND_SIZE);
+    logI("Display Command: %d/%d", getCommandLaneDepth(CommandLane::DISPLAY), QUEUE_DISPLAY_COMMAND_SIZE);
+    logI("Event lanes: Alert %d/%d, Button %d/%d, Result %d/%d, Time %d, Status %d",
+         getEventLaneDepth(EventLane::ALERT), QUEUE_ALERT_EVENT_SIZE, getEventLaneDepth(EventLane::BUTTON), QUEUE_BUTTON_EVENT_SIZE,
+         getEventLaneDepth(EventLane::RESULT), QUEUE_RESULT_EVENT_SIZE, getEventLaneDepth(EventLane::TIME), getEventLaneDepth(EventLane::STATUS));
+    logI("Response: %d/%d (%.1f%%)", getResponseQueueDepth(), QUEUE_RESPONSE_SIZE, getResponseQueueUtilization() * 100);
+    ObjectPoolStats cmdPool = getRawCommandPoolStats();
+    ObjectPoolStats evtPool = getEventPoolStats();
+    ObjectPoolStats respPool = getResponsePoolStats();
+    logI("Pools in use: Command %u/%u, Event %u/%u, Response %u/%u",
+         cmdPool.inUse, cmdPool.capacity, evtPool.inUse, evtPool.capacity, respPool.inUse, respPool.capacity);
     logI("Health: %s", _healthy ? "HEALTHY" : "UNHEALTHY");
 }
 
 void QueueManager::printStatistics() {
+    QueueStats stats = getStatistics();
     logI("--- Queue Statistics ---");
-    logI("Events: Queued=%lu, Processed=%lu", _stats.eventsQueued, _stats.eventsProcessed);
-    logI("Errors: Overflows=%lu, Timeouts=%lu", _stats.queueOverflows, _stats.queueTimeouts);
-    logI("Max Event Queue Depth: %d", _stats.maxEventQueueDepth);
+    logI("Commands: Queued=%lu, Processed=%lu", stats.commandsQueued, stats.commandsProcessed);
+    logI("Events: Queued=%lu, Processed=%lu", stats.eventsQueued, stats.eventsProcessed);
+    logI("Errors: Overflows=%lu, Timeouts=%lu", stats.queueOverflows, stats.queueTimeouts);
+    logI("Max Queue Depth: Command=%d, Event=%d", stats.maxCommandQueueDepth, stats.maxEventQueueDepth);
+    for (uint8_t i = 0; i < (uint8_t)QueueId::COUNT; i++) {
+        const LatencyHistogram& residency = _metrics[i].residency;
+        logI("Residency %s: p50=%luus, p99=%luus, max=%luus (%lu samples)", getQueueIdString((QueueId)i),
+             residency.getPercentile(50), residency.getPercentile(99), residency.getMax(), residency.getCount());
+    }
 }
 
 // =============================================================================
 // PRIVATE HELPER METHODS
 // =============================================================================
 
-bool QueueManager::createQueue(QueueHandle_t& queue, size_t itemSize, size_t queueLength, const char* name) {
-    queue = xQueueCreate(queueLength, itemSize);
-    if (queue == nullptr) {
-        logE("Failed to create queue: %s", name);
+template <typename T, size_t Capacity>
+bool QueueManager::pushEntry(SpscRing<Entry<T>, Capacity>& ring, QueueId id, T* item, uint32_t timeoutMs,
+                             uint32_t enqueuedUs, bool countDrop) {
+    QueueMetrics& metrics = _metrics[(uint8_t)id];
+    Entry<T> entry = {item, enqueuedUs};
+    if (!ring.push(entry, timeoutMs)) {
+        if (countDrop) metrics.dropped.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
-    logD("Created queue: %s (%d items, %d bytes each)", name, queueLength, itemSize);
+
+    // Only the producer raises the high-water mark of its ring.
+    metrics.enqueued.fetch_add(1, std::memory_order_relaxed);
+    uint32_t depth = ring.size();
+    if (depth > metrics.highWater.load(std::memory_order_relaxed)) {
+        metrics.highWater.store(depth, std::memory_order_relaxed);
+    }
     return true;
 }
 
-void QueueManager::destroyQueue(QueueHandle_t& queue) {
-    if (queue != nullptr) {
-        vQueueDelete(queue);
-        queue = nullptr;
+template <typename T, size_t Capacity>
+bool QueueManager::popEntry(SpscRing<Entry<T>, Capacity>& ring, QueueId id, T*& item, uint32_t timeoutMs) {
+    Entry<T> entry;
+    if (!ring.pop(entry, timeoutMs)) return false;
+
+    QueueMetrics& metrics = _metrics[(uint8_t)id];
+    metrics.dequeued.fetch_add(1, std::memory_order_relaxed);
+    metrics.residency.record(micros() - entry.enqueuedUs);
+    item = entry.item;
+    return true;
+}
+
+bool QueueManager::pushEventLane(EventLane lane, DGTEvent* event, uint32_t enqueuedUs, uint32_t timeoutMs, bool countDrop) {
+    switch (lane) {
+        case EventLane::ALERT:
+            return pushEntry(_alertEventRing, QueueId::ALERT_EVENT, event, timeoutMs, enqueuedUs, countDrop);
+        case EventLane::BUTTON:
+            return pushEntry(_buttonEventRing, QueueId::BUTTON_EVENT, event, timeoutMs, enqueuedUs, countDrop);
+        case EventLane::RESULT:
+            return pushEntry(_resultEventRing, QueueId::RESULT_EVENT, event, timeoutMs, enqueuedUs, countDrop);
+        default:
+            storeLatestEvent(event);
+            return true;
     }
 }
 
-bool QueueManager::sendToQueueSafe(QueueHandle_t queue, const void* item, size_t itemSize, uint32_t timeoutMs) {
-    if (queue == nullptr) return false;
-    return (xQueueSend(queue, item, pdMS_TO_TICKS(timeoutMs)) == pdTRUE);
+bool QueueManager::hasHeldEvents(EventLane lane) const {
+    for (uint8_t i = 0; i < _heldEventCount; i++) {
+        if (getEventLane(_heldEvents[i].event->type) == lane) return true;
+    }
+    return false;
 }
 
-bool QueueManager::receiveFromQueueSafe(QueueHandle_t queue, void* item, size_t itemSize, uint32_t timeoutMs) {
-    if (queue == nullptr) return false;
-    return (xQueueReceive(queue, item, pdMS_TO_TICKS(timeoutMs)) == pdTRUE);
+bool QueueManager::holdEvent(DGTEvent* event) {
+    if (_heldEventCount >= QUEUE_HELD_EVENT_SLOTS) return false;
+
+    // The time it is held counts in the residency of its lane.
+    _heldEvents[_heldEventCount++] = {event, micros()};
+    if (_heldEventCount > _heldEventPeak) _heldEventPeak = _heldEventCount;
+    logD("%s lane full, event held: %s", getEventLaneString(getEventLane(event->type)), getEventTypeString(event->type));
+    return true;
 }
 
-void QueueManager::updateQueueStats(bool isSend, bool success, bool isCommand) {
-    // This logic is simplified as raw command stats are not tracked here.
-    if (isSend) {
-        if (!isCommand) _stats.eventsQueued++;
-        if (!success) _stats.queueOverflows++;
-    } else {
-        if (!isCommand && success) _stats.eventsProcessed++;
-        if (!success) _stats.queueTimeouts++;
+void QueueManager::storeLatestEvent(DGTEvent* event) {
+    QueueId id = getEventQueueId(getEventLane(event->type));
+    QueueMetrics& metrics = _metrics[(uint8_t)id];
+
+    // The stamp is written first: if the main loop takes the previous event in
+    // between, its residency is only slightly underestimated.
+    _latestEventStamps[event->type].store(micros(), std::memory_order_relaxed);
+    DGTEvent* previous = _latestEvents[event->type].exchange(event, std::memory_order_acq_rel);
+    metrics.enqueued.fetch_add(1, std::memory_order_relaxed);
+    if (previous) {
+        metrics.dropped.fetch_add(1, std::memory_order_relaxed);
+        _eventPool.adopt(previous); // The handle returns the superseded event to its pool.
+    }
+
+    uint32_t depth = getEventLaneDepth(getEventLane(event->type));
+    if (depth > metrics.highWater.load(std::memory_order_relaxed)) {
+        metrics.highWater.store(depth, std::memory_order_relaxed);
+    }
+}
+
+bool QueueManager::takeLatestEvent(EventLane lane, DGTEvent*& event) {
+    for (uint8_t type = 0; type < EVENT_TYPE_COUNT; type++) {
+        if (getEventLane((DGTEvent::Type)type) != lane) continue;
+        DGTEvent* pending = _latestEvents[type].exchange(nullptr, std::memory_order_acq_rel);
+        if (!pending) continue;
+
+        QueueMetrics& metrics = _metrics[(uint8_t)getEventQueueId(lane)];
+        metrics.dequeued.fetch_add(1, std::memory_order_relaxed);
+        metrics.residency.record(micros() - _latestEventStamps[type].load(std::memory_order_relaxed));
+        event = pending;
+        return true;
+    }
+    return false;
+}
+
+bool QueueManager::popEventLane(EventLane lane, DGTEvent*& event) {
+    switch (lane) {
+        case EventLane::ALERT:
+            return popEntry(_alertEventRing, QueueId::ALERT_EVENT, event, 0);
+        case EventLane::BUTTON:
+            return popEntry(_buttonEventRing, QueueId::BUTTON_EVENT, event, 0);
+        case EventLane::RESULT:
+            return popEntry(_resultEventRing, QueueId::RESULT_EVENT, event, 0);
+        default:
+            return takeLatestEvent(lane, event);
+    }
+}
+
+uint8_t QueueManager::getEventLaneWeight(EventLane lane) {
+    switch (lane) {
+        case EventLane::ALERT:
+            return EVENT_LANE_WEIGHT_ALERT;
+        case EventLane::BUTTON:
+            return EVENT_LANE_WEIGHT_BUTTON;
+        case EventLane::RESULT:
+            return EVENT_LANE_WEIGHT_RESULT;
+        case EventLane::TIME:
+            return EVENT_LANE_WEIGHT_TIME;
+        default:
+            return EVENT_LANE_WEIGHT_STATUS;
+    }
+}
+
+// =============================================================================
+// UTILITY FUNCTIONS
+// =============================================================================
+
+const char* getQueueIdString(QueueManager::QueueId id) {
+    switch (id) {
+        case QueueManager::QueueId::CONTROL_COMMAND:
+            return "controlCmdQueue";
+        case QueueManager::QueueId::DISPLAY_COMMAND:
+            return "displayCmdQueue";
+        case QueueManager::QueueId::ALERT_EVENT:
+            return "alertEvtQueue";
+        case QueueManager::QueueId::BUTTON_EVENT:
+            return "buttonEvtQueue";
+        case QueueManager::QueueId::RESULT_EVENT:
+            return "resultEvtQueue";
+        case QueueManager::QueueId::TIME_EVENT:
+            return "timeEvtQueue";
+        case QueueManager::QueueId::STATUS_EVENT:
+            return "statusEvtQueue";
+        case QueueManager::QueueId::RESPONSE:
+            return "respQueue";
+        default:
+            return "unknown";
     }
-    updateStatistics();
 }
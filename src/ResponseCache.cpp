@@ -0,0 +1,186 @@
+/*
+ * Command Response Cache Implementation for DGT3000 Gateway
+ *
+ * This file implements the LRU cache used to answer retransmitted
+ * commands (same ID) without executing them a second time.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ResponseCache.h"
+
+using namespace esp32m;
+
+// =============================================================================
+// RESPONSE CACHE IMPLEMENTATION
+// =============================================================================
+
+ResponseCache::ResponseCache()
+    : SimpleLoggable("cache"), _mutex(nullptr), _hits(0), _misses(0) {
+    memset(_entries, 0, sizeof(_entries));
+}
+
+ResponseCache::~ResponseCache() {
+    if (_mutex != nullptr) {
+        vSemaphoreDelete(_mutex);
+        _mutex = nullptr;
+    }
+}
+
+bool ResponseCache::initialize() {
+#if GATEWAY_STATIC_ALLOCATION
+    _mutex = xSemaphoreCreateMutexStatic(&_mutexBuffer);
+#else
+    _mutex = xSemaphoreCreateMutex();
+#endif
+    if (_mutex == nullptr) {
+        logE("Failed to create response cache mutex");
+        return false;
+    }
+    clear();
+    logD("Response cache initialized (%d entries, %lu ms window)", RESPONSE_CACHE_SIZE, RESPONSE_CACHE_WINDOW_MS);
+    return true;
+}
+
+ResponseCache::LookupResult ResponseCache::lookup(const char* id, char* response, size_t responseSize) {
+    // JSON responses are stored with their terminator.
+    size_t length = 0;
+    return lookup(id, CommandFormat::JSON, reinterpret_cast<uint8_t*>(response), responseSize, length);
+}
+
+ResponseCache::LookupResult ResponseCache::lookupBinary(const char* id, uint8_t* frame, size_t frameSize, size_t& length) {
+    return lookup(id, CommandFormat::BINARY, frame, frameSize, length);
+}
+
+void ResponseCache::complete(const char* id, const char* response) {
+    if (!response) return;
+    complete(id, CommandFormat::JSON, reinterpret_cast<const uint8_t*>(response), strlen(response) + 1);
+}
+
+void ResponseCache::completeBinary(const char* id, const uint8_t* frame, size_t length) {
+    complete(id, CommandFormat::BINARY, frame, length);
+}
+
+void ResponseCache::remove(const char* id, CommandFormat format) {
+    if (!id || _mutex == nullptr) return;
+    if (xSemaphoreTake(_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return;
+
+    Entry* entry = find(id, format, millis());
+    if (entry) {
+        entry->used = false;
+    }
+
+    xSemaphoreGive(_mutex);
+}
+
+void ResponseCache::clear() {
+    for (size_t i = 0; i < RESPONSE_CACHE_SIZE; i++) {
+        _entries[i].used = false;
+        _entries[i].completed = false;
+    }
+}
+
+// =============================================================================
+// PRIVATE HELPER METHODS
+// =============================================================================
+
+ResponseCache::LookupResult ResponseCache::lookup(const char* id, CommandFormat format,
+                                                  uint8_t* response, size_t responseSize, size_t& length) {
+    length = 0;
+    if (!id || id[0] == '\0' || _mutex == nullptr) return MISS;
+    if (xSemaphoreTake(_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return MISS;
+
+    uint32_t now = millis();
+    LookupResult result = MISS;
+    Entry* entry = find(id, format, now);
+
+    if (entry) {
+        entry->lastUseTime = now;
+        if (entry->completed && response && entry->responseLength <= responseSize) {
+            memcpy(response, entry->response, entry->responseLength);
+            length = entry->responseLength;
+            result = HIT;
+        } else {
+            result = PENDING;
+        }
+        _hits++;
+    } else {
+        // Register the ID so that a retransmit arriving before the response is ignored.
+        entry = allocate(now);
+        strncpy(entry->id, id, APP_MAX_COMMAND_ID_LENGTH - 1);
+        entry->id[APP_MAX_COMMAND_ID_LENGTH - 1] = '\0';
+        entry->format = format;
+        _misses++;
+    }
+
+    xSemaphoreGive(_mutex);
+    return result;
+}
+
+void ResponseCache::complete(const char* id, CommandFormat format, const uint8_t* response, size_t length) {
+    if (!id || !response || _mutex == nullptr) return;
+    if (xSemaphoreTake(_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return;
+
+    uint32_t now = millis();
+    Entry* entry = find(id, format, now);
+    if (entry) {
+        if (length <= sizeof(entry->response)) {
+            memcpy(entry->response, response, length);
+            entry->responseLength = length;
+            entry->completed = true;
+            entry->lastUseTime = now;
+        } else {
+            // Too large to be replayed; let a retransmit execute the command again.
+            logW("Response for ID %s too large to cache (%d bytes)", id, length);
+            entry->used = false;
+        }
+    }
+
+    xSemaphoreGive(_mutex);
+}
+
+ResponseCache::Entry* ResponseCache::find(const char* id, CommandFormat format, uint32_t now) {
+    for (size_t i = 0; i < RESPONSE_CACHE_SIZE; i++) {
+        Entry& entry = _entries[i];
+        if (!entry.used) continue;
+        if (isExpired(entry, now)) {
+            entry.used = false;
+            continue;
+        }
+        if (entry.format == format && strncmp(entry.id, id, APP_MAX_COMMAND_ID_LENGTH) == 0) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+ResponseCache::Entry* ResponseCache::allocate(uint32_t now) {
+    // Prefer a free slot, otherwise evict the least recently used entry.
+    Entry* victim = &_entries[0];
+    for (size_t i = 0; i < RESPONSE_CACHE_SIZE; i++) {
+        Entry& entry = _entries[i];
+        if (!entry.used || isExpired(entry, now)) {
+            victim = &entry;
+            break;
+        }
+        if (entry.lastUseTime < victim->lastUseTime) {
+            victim = &entry;
+        }
+    }
+
+    victim->used = true;
+    victim->completed = false;
+    victim->responseLength = 0;
+    victim->createdTime = now;
+    victim->lastUseTime = now;
+    return victim;
+}
+
+bool ResponseCache::isExpired(const Entry& entry, uint32_t now) const {
+    return (now - entry.createdTime) > RESPONSE_CACHE_WINDOW_MS;
+}
@@ -0,0 +1,216 @@
+/*
+ * Time Control Engine Implementation for DGT3000 Gateway
+ *
+ * This file implements the time control arithmetic applied by the gateway
+ * on each lever move.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "TimeControlEngine.h"
+
+// =============================================================================
+// TIME CONTROL ENGINE IMPLEMENTATION
+// =============================================================================
+
+TimeControlEngine::TimeControlEngine()
+    : _enabled(false),
+      _mode(Mode::NONE),
+      _periodCount(0),
+      _running(Side::NONE),
+      _delayPending(false),
+      _delayEndTime(0),
+      _moveStartSeconds(0)
+{
+    _delayTimes[0] = _delayTimes[1] = 0;
+    _moves[0] = _moves[1] = 0;
+    _period[0] = _period[1] = 0;
+    _periodEndMove[0] = _periodEndMove[1] = 0;
+}
+
+bool TimeControlEngine::configure(Mode mode, const Period* periods, uint8_t count, ClockSetting& initial, const char*& err) {
+    if (count == 0 || count > TIME_CONTROL_MAX_PERIODS) {
+        err = "Invalid number of periods";
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (periods[i].seconds > TIME_CONTROL_MAX_SECONDS || periods[i].incrementSeconds > TIME_CONTROL_MAX_INCREMENT_SECONDS) {
+            err = "Period time or increment out of range";
+            return false;
+        }
+        // Only the last period may last until the end of the game.
+        if (i < count - 1 && periods[i].moves == 0) {
+            err = "Only the last period can have no move count";
+            return false;
+        }
+    }
+    if (periods[0].seconds == 0) {
+        err = "The first period has no time";
+        return false;
+    }
+
+    _mode = mode;
+    memcpy(_periods, periods, count * sizeof(Period));
+    _periodCount = count;
+
+    for (uint8_t i = 0; i < 2; i++) {
+        _moves[i] = 0;
+        _period[i] = 0;
+        _periodEndMove[i] = (count > 1) ? periods[0].moves : 0;
+    }
+    _running = Side::NONE;
+    _delayPending = false;
+    _enabled = true;
+
+    initial.leftSeconds = periods[0].seconds;
+    initial.rightSeconds = periods[0].seconds;
+    initial.running = Side::NONE;
+    return true;
+}
+
+void TimeControlEngine::disable() {
+    pause();
+    _enabled = false;
+}
+
+void TimeControlEngine::pause() {
+    _running = Side::NONE;
+    _delayPending = false;
+}
+
+bool TimeControlEngine::onMove(Side side, uint32_t leftSeconds, uint32_t rightSeconds, uint32_t now, ClockSetting& setting) {
+    if (!_enabled || side == Side::NONE) return false;
+
+    uint32_t times[2] = { leftSeconds, rightSeconds };
+    if (_running == side) {
+        // The player on move completed it.
+        times[index(side)] = applyMove(side, times[index(side)]);
+    } else if (_running != Side::NONE) {
+        // The player not on move pressed the lever again: nothing changes.
+        return false;
+    }
+    // Otherwise the game starts (or resumes): the opponent of the player who pressed is on move.
+
+    Side next = opponent(side);
+    startMove(next, times[index(next)], now);
+
+    setting.leftSeconds = times[0];
+    setting.rightSeconds = times[1];
+    setting.running = _delayPending ? Side::NONE : next;
+    if (_delayPending) {
+        _delayTimes[0] = times[0];
+        _delayTimes[1] = times[1];
+    }
+    return true;
+}
+
+bool TimeControlEngine::update(uint32_t now, ClockSetting& setting) {
+    if (!_enabled || !_delayPending || (int32_t)(now - _delayEndTime) < 0) {
+        return false;
+    }
+
+    _delayPending = false;
+    setting.leftSeconds = _delayTimes[0];
+    setting.rightSeconds = _delayTimes[1];
+    setting.running = _running;
+    return true;
+}
+
+uint16_t TimeControlEngine::getMoves(Side side) const {
+    return (side == Side::NONE) ? 0 : _moves[index(side)];
+}
+
+uint8_t TimeControlEngine::getPeriod(Side side) const {
+    return (side == Side::NONE) ? 0 : _period[index(side)];
+}
+
+// =============================================================================
+// PRIVATE HELPER METHODS
+// =============================================================================
+
+uint32_t TimeControlEngine::applyMove(Side side, uint32_t remainingSeconds) {
+    uint8_t i = index(side);
+    uint16_t increment = _periods[_period[i]].incrementSeconds;
+    _moves[i]++;
+
+    switch (_mode) {
+        case Mode::FISCHER:
+            remainingSeconds += increment;
+            break;
+        case Mode::BRONSTEIN: {
+            // Give back the time used for the move, up to the increment.
+            uint32_t used = (_moveStartSeconds > remainingSeconds) ? _moveStartSeconds - remainingSeconds : 0;
+            remainingSeconds += (used < increment) ? used : increment;
+            break;
+        }
+        default:
+            break; // The delay is applied when the move starts.
+    }
+
+    // Entering the next period adds its time.
+    if (_periodEndMove[i] != 0 && _moves[i] >= _periodEndMove[i]) {
+        _period[i]++;
+        const Period& period = _periods[_period[i]];
+        remainingSeconds += period.seconds;
+        _periodEndMove[i] = (_period[i] + 1 < _periodCount) ? _periodEndMove[i] + period.moves : 0;
+    }
+
+    return (remainingSeconds > TIME_CONTROL_MAX_SECONDS) ? TIME_CONTROL_MAX_SECONDS : remainingSeconds;
+}
+
+void TimeControlEngine::startMove(Side side, uint32_t remainingSeconds, uint32_t now) {
+    _running = side;
+    _moveStartSeconds = remainingSeconds;
+
+    // US delay: the clock stays stopped during the delay.
+    uint16_t delay = _periods[_period[index(side)]].incrementSeconds;
+    _delayPending = (_mode == Mode::DELAY && delay > 0);
+    if (_delayPending) {
+        _delayEndTime = now + (uint32_t)delay * 1000;
+    }
+}
+
+// =============================================================================
+// UTILITY FUNCTIONS
+// =============================================================================
+
+bool parseTimeControlMode(const char* name, TimeControlEngine::Mode& mode) {
+    if (!name) return false;
+    if (strcmp(name, "none") == 0) mode = TimeControlEngine::Mode::NONE;
+    else if (strcmp(name, "fischer") == 0) mode = TimeControlEngine::Mode::FISCHER;
+    else if (strcmp(name, "bronstein") == 0) mode = TimeControlEngine::Mode::BRONSTEIN;
+    else if (strcmp(name, "delay") == 0) mode = TimeControlEngine::Mode::DELAY;
+    else return false;
+    return true;
+}
+
+const char* getTimeControlModeString(TimeControlEngine::Mode mode) {
+    switch (mode) {
+        case TimeControlEngine::Mode::NONE:
+            return "none";
+        case TimeControlEngine::Mode::FISCHER:
+            return "fischer";
+        case TimeControlEngine::Mode::BRONSTEIN:
+            return "bronstein";
+        case TimeControlEngine::Mode::DELAY:
+            return "delay";
+        default:
+            return "unknown";
+    }
+}
+
+const char* getTimeControlSideString(TimeControlEngine::Side side) {
+    switch (side) {
+        case TimeControlEngine::Side::LEFT:
+            return "left";
+        case TimeControlEngine::Side::RIGHT:
+            return "right";
+        default:
+            return "none";
+    }
+}
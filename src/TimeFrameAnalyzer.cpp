@@ -0,0 +1,191 @@
+/*
+ * Time Frame Analyzer Implementation for DGT3000 Gateway
+ *
+ * This file implements the quality checks of the clock time messages.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "TimeFrameAnalyzer.h"
+
+// =============================================================================
+// TIME FRAME ANALYZER IMPLEMENTATION
+// =============================================================================
+
+TimeFrameAnalyzer::TimeFrameAnalyzer() {
+    memset(_sides, 0, sizeof(_sides));
+    clearStats();
+    reset();
+}
+
+void TimeFrameAnalyzer::reset() {
+    endRuns();
+    _lastModes[0] = DGT_MODE_STOP;
+    _lastModes[1] = DGT_MODE_STOP;
+    _lastArrivalUs = 0;
+    _hasLast = false;
+}
+
+void TimeFrameAnalyzer::clearStats() {
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.minGapMs = UINT32_MAX;
+    memset(_sides, 0, sizeof(_sides));
+    _driftSeconds = 0;
+    _driftUs = 0;
+    _driftReported = false;
+}
+
+bool TimeFrameAnalyzer::onFrame(const uint8_t time[6], uint8_t leftMode, uint8_t rightMode,
+                                int64_t arrivalUs, Report& report) {
+    uint32_t leftSeconds = time[0] * 3600UL + time[1] * 60UL + time[2];
+    uint32_t rightSeconds = time[3] * 3600UL + time[4] * 60UL + time[5];
+
+    report.anomaly = Anomaly::NONE;
+    report.side = TimeControlEngine::Side::NONE;
+    report.value = 0;
+
+    // A change of modes is a new run: compare from the next message.
+    bool comparable = _hasLast && _lastModes[0] == leftMode && _lastModes[1] == rightMode &&
+                      (leftMode != DGT_MODE_STOP || rightMode != DGT_MODE_STOP);
+
+    if (comparable) {
+        _stats.frames++;
+
+        // Seconds advanced by the running sides; one report per message, the left side first.
+        uint32_t advanced = 0;
+        analyzeSide(0, leftSeconds, leftMode, arrivalUs, advanced, report);
+        analyzeSide(1, rightSeconds, rightMode, arrivalUs, advanced, report);
+
+        uint32_t gapMs = (uint32_t)((arrivalUs - _lastArrivalUs) / 1000);
+        if (gapMs > _stats.maxGapMs) _stats.maxGapMs = gapMs;
+
+        // Lost seconds already explain a long gap; only check plain steps.
+        if (advanced == 1) {
+            if (gapMs < _stats.minGapMs) _stats.minGapMs = gapMs;
+            if (abs((int32_t)gapMs - 1000) > (int32_t)TIME_ANALYZER_GAP_TOLERANCE_MS) {
+                _stats.irregularGaps++;
+                if (report.anomaly == Anomaly::NONE) {
+                    report.anomaly = Anomaly::IRREGULAR_GAP;
+                    report.value = gapMs;
+                }
+            }
+        }
+    } else {
+        endRuns();
+    }
+
+    _sides[0].lastSeconds = leftSeconds;
+    _sides[1].lastSeconds = rightSeconds;
+    _lastModes[0] = leftMode;
+    _lastModes[1] = rightMode;
+    _lastArrivalUs = arrivalUs;
+    _hasLast = true;
+    return report.anomaly != Anomaly::NONE;
+}
+
+// =============================================================================
+// PRIVATE HELPER METHODS
+// =============================================================================
+
+void TimeFrameAnalyzer::analyzeSide(uint8_t index, uint32_t seconds, uint8_t mode, int64_t arrivalUs,
+                                    uint32_t& advanced, Report& report) {
+    if (mode == DGT_MODE_STOP) return;
+
+    SideState& state = _sides[index];
+    TimeControlEngine::Side side = (index == 0) ? TimeControlEngine::Side::LEFT : TimeControlEngine::Side::RIGHT;
+    int32_t step = (mode == DGT_MODE_COUNT_DOWN) ? (int32_t)state.lastSeconds - (int32_t)seconds
+                                                 : (int32_t)seconds - (int32_t)state.lastSeconds;
+
+    if (step == 0) {
+        // A side counting down stays at zero once its flag has fallen.
+        if (mode == DGT_MODE_COUNT_DOWN && seconds == 0) return;
+        _stats.duplicateFrames++;
+        if (report.anomaly == Anomaly::NONE) {
+            report.anomaly = Anomaly::DUPLICATE_SECOND;
+            report.side = side;
+            report.value = seconds;
+        }
+        return;
+    }
+    if (step < 0) {
+        // Moving backwards: the clock was set from its own buttons. New baseline.
+        endRuns();
+        return;
+    }
+
+    if ((uint32_t)step > advanced) advanced = step;
+    if (step > 1) {
+        _stats.missingSeconds += step - 1;
+        if (report.anomaly == Anomaly::NONE) {
+            report.anomaly = Anomaly::MISSING_SECONDS;
+            report.side = side;
+            report.value = step - 1;
+        }
+    }
+
+    // The first second change of a run is the anchor: its instant is exact,
+    // unlike the start of the run.
+    if (!state.anchored) {
+        state.anchorSeconds = seconds;
+        state.anchorUs = arrivalUs;
+        state.anchored = true;
+        return;
+    }
+    state.runSeconds = (uint32_t)abs((int32_t)seconds - (int32_t)state.anchorSeconds);
+    state.runUs = arrivalUs - state.anchorUs;
+    updateDrift(side, report);
+}
+
+void TimeFrameAnalyzer::endRuns() {
+    for (SideState& state : _sides) {
+        _driftSeconds += state.runSeconds;
+        _driftUs += state.runUs;
+        state.runSeconds = 0;
+        state.runUs = 0;
+        state.anchored = false;
+    }
+}
+
+void TimeFrameAnalyzer::updateDrift(TimeControlEngine::Side side, Report& report) {
+    uint32_t spanSeconds = _driftSeconds + _sides[0].runSeconds + _sides[1].runSeconds;
+    if (spanSeconds < TIME_ANALYZER_DRIFT_MIN_SPAN_S) return;
+
+    int64_t spanUs = _driftUs + _sides[0].runUs + _sides[1].runUs;
+    _stats.driftPpm = (int32_t)((spanUs - (int64_t)spanSeconds * 1000000) / spanSeconds);
+    _stats.driftSpanSeconds = spanSeconds;
+
+    // Reported once, when the span is long enough for the value to be reliable.
+    if (!_driftReported && spanSeconds >= TIME_ANALYZER_DRIFT_ALERT_SPAN_S &&
+        abs(_stats.driftPpm) > TIME_ANALYZER_DRIFT_ALERT_PPM && report.anomaly == Anomaly::NONE) {
+        _driftReported = true;
+        report.anomaly = Anomaly::DRIFT;
+        report.side = side;
+        report.value = _stats.driftPpm;
+    }
+}
+
+// =============================================================================
+// UTILITY FUNCTIONS
+// =============================================================================
+
+const char* getTimeAnomalyString(TimeFrameAnalyzer::Anomaly anomaly) {
+    switch (anomaly) {
+        case TimeFrameAnalyzer::Anomaly::NONE:
+            return "none";
+        case TimeFrameAnalyzer::Anomaly::MISSING_SECONDS:
+            return "missingSeconds";
+        case TimeFrameAnalyzer::Anomaly::DUPLICATE_SECOND:
+            return "duplicateSecond";
+        case TimeFrameAnalyzer::Anomaly::IRREGULAR_GAP:
+            return "irregularGap";
+        case TimeFrameAnalyzer::Anomaly::DRIFT:
+            return "drift";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * Time Mailbox Implementation for DGT3000 Gateway
+ *
+ * This file implements the sequence-locked latest-value time mailbox.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "TimeMailbox.h"
+
+// =============================================================================
+// TIME MAILBOX IMPLEMENTATION
+// =============================================================================
+
+TimeMailbox::TimeMailbox()
+    : _sequence(0),
+      _taken(0),
+      _superseded(0)
+{
+    memset(&_slot, 0, sizeof(_slot));
+}
+
+void TimeMailbox::publish(const TimeSnapshot& snapshot) {
+    uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+
+    // The previous value was never read.
+    if (sequence != 0 && _taken.load(std::memory_order_relaxed) != sequence) {
+        _superseded.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    _sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _slot = snapshot;
+    _sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool TimeMailbox::take(TimeSnapshot& snapshot) {
+    uint32_t before;
+    uint32_t after;
+    do {
+        before = _sequence.load(std::memory_order_acquire);
+        if (before == _taken.load(std::memory_order_relaxed)) return false;
+        if (before & 1) continue; // Write in progress on the other core.
+
+        snapshot = _slot;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = _sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    _taken.store(before, std::memory_order_relaxed);
+    return true;
+}
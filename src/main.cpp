@@ -41,6 +41,11 @@ std::unique_ptr<DGT3000BLEService> g_bleService;
 std::unique_ptr<I2CTaskManager> g_i2cTaskManager;
 std::unique_ptr<LedManager> g_ledManager;
 
+// Set by the BLE disconnection callback; the restart is done by the main loop
+// once the I2C task has powered the clock off.
+volatile bool g_restartPending = false;
+uint32_t g_restartRequestTime = 0;
+
 // =============================================================================
 // FORWARD DECLARATIONS
 // =============================================================================
@@ -178,8 +183,9 @@ void onBLEDisconnected() {
     g_systemStatus.systemState = SystemState::IDLE;
     g_systemStatus.updateActivity();
 
-    // Restart the ESP32 to ensure a clean state for the next connection.
-    ESP.restart(); 
+    // The ESP32 is restarted by the main loop to ensure a clean state for the next connection.
+    g_restartRequestTime = millis();
+    g_restartPending = true;
 }
 
 // =============================================================================
@@ -192,6 +198,16 @@ void onBLEDisconnected() {
 void processSystemTasks() {
     g_systemStatus.updateUptime();
     
+    // Restart after a BLE disconnection, once the clock is powered off.
+    if (g_restartPending) {
+        bool released = !g_i2cTaskManager || g_i2cTaskManager->isDGT3000Released();
+        if (released || millis() - g_restartRequestTime > I2C_TASK_RELEASE_TIMEOUT_MS) {
+            if (!released) log_w("WARNING: DGT3000 not released in time, restarting anyway.");
+            ESP.restart();
+        }
+        return;
+    }
+    
     if (g_bleService) g_bleService->processEvents();
 
     // Control BLE advertising based on DGT connection status.
@@ -252,10 +268,13 @@ void printSystemStatus() {
     log_i("Commands: %lu, Events: %lu", g_systemStatus.commandsProcessed, g_systemStatus.eventsGenerated);
     
     if (g_queueManager) {
-        log_i("Queues (Used/Size): RawCmd=%d/%d, Event=%d/%d, Resp=%d/%d",
-              g_queueManager->getRawCommandQueueDepth(), QUEUE_COMMAND_SIZE,
-              g_queueManager->getEventQueueDepth(), QUEUE_EVENT_SIZE,
-              g_queueManager->getResponseQueueDepth(), QUEUE_COMMAND_SIZE);
+        log_i("Queues (Used/Size): CtrlCmd=%d/%d, DispCmd=%d/%d, AlertEvt=%d/%d, ButtonEvt=%d/%d, ResultEvt=%d/%d, Resp=%d/%d",
+              g_queueManager->getCommandLaneDepth(CommandLane::CONTROL), QUEUE_CONTROL_COMMAND_SIZE,
+              g_queueManager->getCommandLaneDepth(CommandLane::DISPLAY), QUEUE_DISPLAY_COMMAND_SIZE,
+              g_queueManager->getEventLaneDepth(EventLane::ALERT), QUEUE_ALERT_EVENT_SIZE,
+              g_queueManager->getEventLaneDepth(EventLane::BUTTON), QUEUE_BUTTON_EVENT_SIZE,
+              g_queueManager->getEventLaneDepth(EventLane::RESULT), QUEUE_RESULT_EVENT_SIZE,
+              g_queueManager->getResponseQueueDepth(), QUEUE_RESPONSE_SIZE);
     }
     log_i("---------------------");
 }
@@ -0,0 +1,33 @@
+/*
+ * Host Stand-in for the Arduino Core
+ *
+ * This header provides the few Arduino calls used by the gateway modules
+ * built in the native test environment.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+
+inline uint32_t millis() { return (uint32_t)(esp_timer_get_time() / 1000); }
+inline uint32_t micros() { return (uint32_t)esp_timer_get_time(); }
+inline void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,235 @@
+/*
+ * Fake DGT3000 Driver for the Host Tests
+ *
+ * This file implements the methods of the DGT3000 class used by the gateway
+ * without any bus: every call succeeds, at once or after the cost given to
+ * its method, and is recorded with the thread that made it. The clock shows
+ * 0:05:00 on both sides.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "DGT3000.h"
+#include "DGT3000Fake.h"
+#include <esp_timer.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+
+// =============================================================================
+// CALL RECORDING
+// =============================================================================
+
+namespace {
+
+std::mutex fakeMutex;
+std::vector<std::thread::id> callerThreads;
+std::map<std::string, uint32_t> callCounts;
+uint32_t totalCalls = 0;
+std::deque<uint8_t> buttonEvents;
+std::map<std::string, uint32_t> callCosts;
+std::vector<DGT3000Fake::Transaction> transactions;
+
+void record(const char* method) {
+    uint32_t costUs = 0;
+    {
+        std::lock_guard<std::mutex> lock(fakeMutex);
+        std::thread::id caller = std::this_thread::get_id();
+        if (std::find(callerThreads.begin(), callerThreads.end(), caller) == callerThreads.end()) {
+            callerThreads.push_back(caller);
+        }
+        callCounts[method]++;
+        totalCalls++;
+        auto it = callCosts.find(method);
+        if (it != callCosts.end()) costUs = it->second;
+    }
+    if (costUs == 0) return;
+
+    // The bus is held for the whole transaction, without the lock.
+    int64_t startUs = esp_timer_get_time();
+    std::this_thread::sleep_for(std::chrono::microseconds(costUs));
+    int64_t endUs = esp_timer_get_time();
+
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    transactions.push_back({ method, startUs, endUs });
+}
+
+} // namespace
+
+namespace DGT3000Fake {
+
+std::vector<std::thread::id> getCallerThreads() {
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    return callerThreads;
+}
+
+uint32_t getCallCount() {
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    return totalCalls;
+}
+
+uint32_t getCallCount(const char* method) {
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    auto it = callCounts.find(method);
+    return (it != callCounts.end()) ? it->second : 0;
+}
+
+void setCallCost(const char* method, uint32_t costUs) {
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    callCosts[method] = costUs;
+}
+
+std::vector<Transaction> getTransactions() {
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    return transactions;
+}
+
+void pushButtonEvent(uint8_t button) {
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    buttonEvents.push_back(button);
+}
+
+void reset() {
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    callerThreads.clear();
+    callCounts.clear();
+    totalCalls = 0;
+    buttonEvents.clear();
+    callCosts.clear();
+    transactions.clear();
+}
+
+} // namespace DGT3000Fake
+
+// =============================================================================
+// DGT3000 METHODS
+// =============================================================================
+
+DGT3000::DGT3000() {
+    _initialized = false;
+    _connected = false;
+    _configured = false;
+    _lastError = DGT_SUCCESS;
+}
+
+bool DGT3000::begin(int masterSDA, int masterSCL, int slaveSDA, int slaveSCL) {
+    record("begin");
+    _masterSDA = masterSDA;
+    _masterSCL = masterSCL;
+    _slaveSDA = slaveSDA;
+    _slaveSCL = slaveSCL;
+    _initialized = true;
+    return true;
+}
+
+void DGT3000::end() {
+    record("end");
+    _initialized = false;
+    _connected = false;
+    _configured = false;
+}
+
+bool DGT3000::configure() {
+    record("configure");
+    _connected = true;
+    _configured = true;
+    return true;
+}
+
+bool DGT3000::displayText(const char* text, uint8_t beep, uint8_t leftDots, uint8_t rightDots) {
+    record("displayText");
+    return validateDisplayTextParameters(text, beep, leftDots, rightDots);
+}
+
+bool DGT3000::endDisplay() {
+    record("endDisplay");
+    return true;
+}
+
+bool DGT3000::setAndRun(uint8_t leftMode, uint8_t leftHours, uint8_t leftMinutes, uint8_t leftSeconds,
+                        uint8_t rightMode, uint8_t rightHours, uint8_t rightMinutes, uint8_t rightSeconds) {
+    record("setAndRun");
+    return validateTimeParameters(leftMode, leftHours, leftMinutes, leftSeconds,
+                                  rightMode, rightHours, rightMinutes, rightSeconds);
+}
+
+bool DGT3000::stop() {
+    record("stop");
+    return true;
+}
+
+bool DGT3000::run(uint8_t leftMode, uint8_t rightMode) {
+    record("run");
+    return validateRunParameters(leftMode, rightMode);
+}
+
+bool DGT3000::getTime(uint8_t time[6]) {
+    record("getTime");
+    const uint8_t fiveMinutes[6] = { 0, 5, 0, 0, 5, 0 };
+    memcpy(time, fiveMinutes, sizeof(fiveMinutes));
+    return true;
+}
+
+bool DGT3000::isNewTimeAvailable() {
+    record("isNewTimeAvailable");
+    return false;
+}
+
+uint32_t DGT3000::getLastTimeUpdateMicros() const {
+    record("getLastTimeUpdateMicros");
+    return 0;
+}
+
+bool DGT3000::getButtonEvent(uint8_t* button) {
+    record("getButtonEvent");
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    if (buttonEvents.empty()) return false;
+    *button = buttonEvents.front();
+    buttonEvents.pop_front();
+    return true;
+}
+
+bool DGT3000::getButtonStateChange(uint8_t* state, uint32_t* timestampMicros) {
+    record("getButtonStateChange");
+    (void)state;
+    (void)timestampMicros;
+    return false;
+}
+
+int DGT3000::getLastError() {
+    record("getLastError");
+    return _lastError;
+}
+
+const char* DGT3000::getErrorString(int error) {
+    record("getErrorString");
+    return (error == DGT_SUCCESS) ? "Success" : "Fake error";
+}
+
+// =============================================================================
+// PARAMETER VALIDATION (same checks as the library)
+// =============================================================================
+
+bool validateDisplayTextParameters(const char* text, uint8_t beep, uint8_t leftDots, uint8_t rightDots) {
+    const uint8_t validLeftDots = DGT_DOT_FLAG | DGT_DOT_WHITE_KING | DGT_DOT_BLACK_KING | DGT_DOT_COLON | DGT_DOT_DOT | DGT_DOT_EXTRA;
+    const uint8_t validRightDots = DGT_DOT_FLAG | DGT_DOT_WHITE_KING | DGT_DOT_BLACK_KING | DGT_DOT_COLON | DGT_DOT_DOT;
+    return text && strlen(text) <= DGT3000_DISPLAY_TEXT_MAX && beep <= 48 &&
+           (leftDots & ~validLeftDots) == 0 && (rightDots & ~validRightDots) == 0;
+}
+
+bool validateTimeParameters(uint8_t leftMode, uint8_t leftHours, uint8_t leftMinutes, uint8_t leftSeconds,
+                            uint8_t rightMode, uint8_t rightHours, uint8_t rightMinutes, uint8_t rightSeconds) {
+    return leftMode <= 2 && rightMode <= 2 && leftHours <= 9 && rightHours <= 9 &&
+           leftMinutes <= 59 && rightMinutes <= 59 && leftSeconds <= 59 && rightSeconds <= 59;
+}
+
+bool validateRunParameters(uint8_t leftMode, uint8_t rightMode) {
+    return leftMode <= 2 && rightMode <= 2;
+}
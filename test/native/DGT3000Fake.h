@@ -0,0 +1,75 @@
+/*
+ * Fake DGT3000 Driver for the Host Tests
+ *
+ * This header gives the tests access to the fake driver built in place of
+ * the DGT3000 library: the threads that called it, the duration of its I2C
+ * transactions, and the button events it reports.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef DGT3000_FAKE_H
+#define DGT3000_FAKE_H
+
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DGT3000Fake {
+
+/**
+ * @brief A call of a method given a cost, with its esp_timer start and end times.
+ */
+struct Transaction {
+    std::string method;
+    int64_t startUs;
+    int64_t endUs;
+};
+
+/**
+ * @brief Gets the threads that called a driver method since the last reset(),
+ * in the order of their first call.
+ */
+std::vector<std::thread::id> getCallerThreads();
+
+/**
+ * @brief Gets the number of driver calls since the last reset().
+ */
+uint32_t getCallCount();
+
+/**
+ * @brief Gets the number of driver calls of a method since the last reset().
+ * @param method Name of the method, e.g. "displayText".
+ */
+uint32_t getCallCount(const char* method);
+
+/**
+ * @brief Makes every later call of a method last costUs, like its I2C
+ * transaction on the clock bus. The calling thread sleeps meanwhile.
+ */
+void setCallCost(const char* method, uint32_t costUs);
+
+/**
+ * @brief Gets the calls of the methods given a cost since the last reset(), in order.
+ */
+std::vector<Transaction> getTransactions();
+
+/**
+ * @brief Queues a button event, returned by the next getButtonEvent().
+ */
+void pushButtonEvent(uint8_t button);
+
+/**
+ * @brief Forgets the calls, the call costs and the pending button events.
+ */
+void reset();
+
+} // namespace DGT3000Fake
+
+#endif // DGT3000_FAKE_H
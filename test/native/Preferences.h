@@ -0,0 +1,69 @@
+/*
+ * Host Stand-in for the Arduino Preferences Library
+ *
+ * This header keeps the NVS namespaces in memory, for the lifetime of the
+ * test program.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false) {
+        _values = &storage()[name];
+        _readOnly = readOnly;
+        return true;
+    }
+
+    void end() { _values = nullptr; }
+
+    size_t getBytesLength(const char* key) {
+        auto it = _values ? _values->find(key) : Values::iterator();
+        return (_values && it != _values->end()) ? it->second.size() : 0;
+    }
+
+    size_t getBytes(const char* key, void* buffer, size_t maxLength) {
+        if (!_values) return 0;
+        auto it = _values->find(key);
+        if (it == _values->end() || it->second.size() > maxLength) return 0;
+        memcpy(buffer, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+
+    size_t putBytes(const char* key, const void* value, size_t length) {
+        if (!_values || _readOnly) return 0;
+        const uint8_t* bytes = static_cast<const uint8_t*>(value);
+        (*_values)[key].assign(bytes, bytes + length);
+        return length;
+    }
+
+    bool remove(const char* key) {
+        return _values && !_readOnly && _values->erase(key) > 0;
+    }
+
+private:
+    typedef std::map<std::string, std::vector<uint8_t>> Values;
+
+    static std::map<std::string, Values>& storage() {
+        static std::map<std::string, Values> namespaces;
+        return namespaces;
+    }
+
+    Values* _values = nullptr;
+    bool _readOnly = false;
+};
+
+#endif // NATIVE_PREFERENCES_H
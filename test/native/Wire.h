@@ -0,0 +1,20 @@
+/*
+ * Host Stand-in for the Arduino Wire Library
+ *
+ * The native test environment does not build the DGT3000 driver: its header
+ * only needs the bus type to be declared.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef NATIVE_WIRE_H
+#define NATIVE_WIRE_H
+
+class TwoWire;
+
+#endif // NATIVE_WIRE_H
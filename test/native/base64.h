@@ -0,0 +1,40 @@
+/*
+ * Host Stand-in for the Arduino base64 Encoder
+ *
+ * encode() returns a std::string instead of an Arduino String; ArduinoJson
+ * stores both the same way.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef NATIVE_BASE64_H
+#define NATIVE_BASE64_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class base64 {
+public:
+    static std::string encode(const uint8_t* data, size_t length) {
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string out;
+        for (size_t i = 0; i < length; i += 3) {
+            uint32_t block = (uint32_t)data[i] << 16;
+            if (i + 1 < length) block |= (uint32_t)data[i + 1] << 8;
+            if (i + 2 < length) block |= data[i + 2];
+            out += alphabet[(block >> 18) & 0x3F];
+            out += alphabet[(block >> 12) & 0x3F];
+            out += (i + 1 < length) ? alphabet[(block >> 6) & 0x3F] : '=';
+            out += (i + 2 < length) ? alphabet[block & 0x3F] : '=';
+        }
+        return out;
+    }
+};
+
+#endif // NATIVE_BASE64_H
@@ -0,0 +1,20 @@
+/*
+ * Host Stand-in for esp_heap_caps
+ *
+ * The gateway modules built on the host include this header but call none
+ * of its functions.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef NATIVE_ESP_HEAP_CAPS_H
+#define NATIVE_ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+
+#endif // NATIVE_ESP_HEAP_CAPS_H
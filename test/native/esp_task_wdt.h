@@ -0,0 +1,26 @@
+/*
+ * Host Stand-in for the ESP32 Task Watchdog
+ *
+ * The host has no task watchdog: subscribing and feeding it do nothing.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef NATIVE_ESP_TASK_WDT_H
+#define NATIVE_ESP_TASK_WDT_H
+
+#include "freertos/task.h"
+
+typedef int esp_err_t;
+#define ESP_OK 0
+
+inline esp_err_t esp_task_wdt_add(TaskHandle_t) { return ESP_OK; }
+inline esp_err_t esp_task_wdt_reset() { return ESP_OK; }
+inline esp_err_t esp_task_wdt_delete(TaskHandle_t) { return ESP_OK; }
+
+#endif // NATIVE_ESP_TASK_WDT_H
@@ -0,0 +1,26 @@
+/*
+ * Host Stand-in for esp_timer
+ *
+ * esp_timer_get_time() counts microseconds from the start of the test
+ * program, like esp_timer counts them from boot.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef NATIVE_ESP_TIMER_H
+#define NATIVE_ESP_TIMER_H
+
+#include <stdint.h>
+#include <chrono>
+
+inline int64_t esp_timer_get_time() {
+    static const std::chrono::steady_clock::time_point boot = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - boot).count();
+}
+
+#endif // NATIVE_ESP_TIMER_H
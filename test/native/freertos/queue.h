@@ -0,0 +1,102 @@
+/*
+ * Host Stand-in for FreeRTOS Queues
+ *
+ * This header provides FreeRTOS queues of fixed-size items copied in and
+ * out, like the originals, on a host mutex and condition variable.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef NATIVE_FREERTOS_QUEUE_H
+#define NATIVE_FREERTOS_QUEUE_H
+
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "FreeRTOS.h"
+
+struct QueueDefinition {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::vector<uint8_t>> items;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+};
+typedef QueueDefinition* QueueHandle_t;
+struct StaticQueue_t {};
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    QueueHandle_t queue = new QueueDefinition();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+inline void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+// Waits up to ticksToWait for the condition, with the queue locked.
+template <typename Condition>
+inline bool queueWait(QueueHandle_t queue, std::unique_lock<std::mutex>& lock, TickType_t ticksToWait, Condition condition) {
+    if (ticksToWait == portMAX_DELAY) {
+        queue->changed.wait(lock, condition);
+        return true;
+    }
+    return queue->changed.wait_for(lock, std::chrono::milliseconds(ticksToWait), condition);
+}
+
+// Copies the item in at the back, or at the front for xQueueSendToFront().
+inline BaseType_t queueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait, bool toFront) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!queueWait(queue, lock, ticksToWait, [queue] { return queue->items.size() < queue->length; })) {
+        return pdFALSE;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    if (toFront) {
+        queue->items.emplace_front(bytes, bytes + queue->itemSize);
+    } else {
+        queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    }
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return queueSend(queue, item, ticksToWait, false);
+}
+
+inline BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return queueSend(queue, item, ticksToWait, true);
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!queueWait(queue, lock, ticksToWait, [queue] { return !queue->items.empty(); })) {
+        return pdFALSE;
+    }
+    memcpy(buffer, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->items.size();
+}
+
+inline UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->length - queue->items.size();
+}
+
+#endif // NATIVE_FREERTOS_QUEUE_H
@@ -0,0 +1,45 @@
+/*
+ * Host Stand-in for FreeRTOS Semaphores
+ *
+ * This header provides the FreeRTOS mutexes on a host timed mutex.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef NATIVE_FREERTOS_SEMPHR_H
+#define NATIVE_FREERTOS_SEMPHR_H
+
+#include <chrono>
+#include <mutex>
+#include "FreeRTOS.h"
+
+typedef std::timed_mutex* SemaphoreHandle_t;
+struct StaticSemaphore_t {};
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new std::timed_mutex();
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    if (ticksToWait == portMAX_DELAY) {
+        semaphore->lock();
+        return pdTRUE;
+    }
+    return semaphore->try_lock_for(std::chrono::milliseconds(ticksToWait)) ? pdTRUE : pdFALSE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    semaphore->unlock();
+    return pdTRUE;
+}
+
+#endif // NATIVE_FREERTOS_SEMPHR_H
@@ -0,0 +1,105 @@
+/*
+ * Host Stand-in for FreeRTOS Tasks
+ *
+ * This header runs each FreeRTOS task on its own host thread. Every thread
+ * gets a task control block holding its notification count, so the rings
+ * can wait on task notifications.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef NATIVE_FREERTOS_TASK_H
+#define NATIVE_FREERTOS_TASK_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+typedef uint8_t StackType_t;
+struct StaticTask_t {};
+
+struct tskTaskControlBlock {
+    std::mutex mutex;
+    std::condition_variable notified;
+    uint32_t notifications = 0;
+    std::thread thread;  ///< Not joinable for the threads not created by xTaskCreatePinnedToCore().
+};
+typedef tskTaskControlBlock* TaskHandle_t;
+
+inline TaskHandle_t& currentTaskHandle() {
+    thread_local TaskHandle_t handle = nullptr;
+    return handle;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+    TaskHandle_t& handle = currentTaskHandle();
+    if (handle == nullptr) {
+        thread_local tskTaskControlBlock block;
+        handle = &block;
+    }
+    return handle;
+}
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                          void* parameter, UBaseType_t priority, TaskHandle_t* createdTask,
+                                          BaseType_t coreId) {
+    (void)name;
+    (void)stackDepth;
+    (void)priority;
+    (void)coreId;
+    TaskHandle_t task = new tskTaskControlBlock();
+    if (createdTask) *createdTask = task;
+    task->thread = std::thread([task, function, parameter] {
+        currentTaskHandle() = task;
+        function(parameter);
+    });
+    return pdPASS;
+}
+
+/**
+ * A host thread cannot be killed: deleting another task waits for its
+ * function to return, so the task must be told to stop first. A task
+ * deleting itself only returns, and its function ends.
+ */
+inline void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr || task == currentTaskHandle()) return;
+    if (task->thread.joinable()) task->thread.join();
+    delete task;
+}
+
+inline void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    auto pending = [task] { return task->notifications > 0; };
+    if (ticksToWait == portMAX_DELAY) {
+        task->notified.wait(lock, pending);
+    } else {
+        task->notified.wait_for(lock, std::chrono::milliseconds(ticksToWait), pending);
+    }
+    uint32_t count = task->notifications;
+    if (count > 0) task->notifications = clearCountOnExit ? 0 : count - 1;
+    return count;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notifications++;
+    }
+    task->notified.notify_one();
+    return pdPASS;
+}
+
+#endif // NATIVE_FREERTOS_TASK_H
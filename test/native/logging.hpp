@@ -0,0 +1,94 @@
+/*
+ * Host Stand-in for the ESP32 Logger
+ *
+ * This header provides the context logging of the esp32m logger. Errors and
+ * warnings are printed with the name of the object, the other levels are
+ * discarded so that benchmarks do not measure the console.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef NATIVE_LOGGING_HPP
+#define NATIVE_LOGGING_HPP
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <memory>
+
+#define logE(format, ...) this->logger().logf(LogLevel::Error, format, ##__VA_ARGS__)
+#define logW(format, ...) this->logger().logf(LogLevel::Warning, format, ##__VA_ARGS__)
+#define logI(format, ...) this->logger().logf(LogLevel::Info, format, ##__VA_ARGS__)
+#define logD(format, ...) this->logger().logf(LogLevel::Debug, format, ##__VA_ARGS__)
+#define logV(format, ...) this->logger().logf(LogLevel::Verbose, format, ##__VA_ARGS__)
+
+namespace esp32m
+{
+  enum LogLevel
+  {
+    None,
+    Default,
+    Error,
+    Warning,
+    Info,
+    Debug,
+    Verbose
+  };
+
+  class Logger
+  {
+  public:
+    explicit Logger(const char *name) : _name(name) {}
+
+    void logf(LogLevel level, const char *format, ...)
+    {
+      if (level > Warning)
+        return;
+      va_list args;
+      va_start(args, format);
+      fprintf(stderr, "[%s] %s: ", _name, level == Error ? "E" : "W");
+      vfprintf(stderr, format, args);
+      fputc('\n', stderr);
+      va_end(args);
+    }
+
+  private:
+    const char *_name;
+  };
+
+  class Loggable
+  {
+  public:
+    Logger &logger()
+    {
+      if (!_logger)
+        _logger.reset(new Logger(logName()));
+      return *_logger;
+    }
+    virtual ~Loggable() = default;
+
+  protected:
+    virtual const char *logName() const = 0;
+
+  private:
+    std::unique_ptr<Logger> _logger;
+  };
+
+  class SimpleLoggable : public Loggable
+  {
+  public:
+    SimpleLoggable(const char *name) : _name(name) {}
+
+  protected:
+    virtual const char *logName() const { return _name; };
+
+  private:
+    const char *_name;
+  };
+} // namespace esp32m
+
+#endif // NATIVE_LOGGING_HPP
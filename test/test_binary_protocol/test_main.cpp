@@ -0,0 +1,239 @@
+/*
+ * Binary Protocol Tests for DGT3000 Gateway
+ *
+ * These host tests check the frames of the binary protocol, and compare
+ * their size on air and their encode/decode cost with the JSON text
+ * notifications and commands they stand for.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <unity.h>
+#include <chrono>
+#include "BinaryProtocol.h"
+#include "ButtonGestureEngine.h"
+#include "DGT3000.h"
+#include "ResponseCache.h"
+#include "TimeControlEngine.h"
+
+static char text[BLE_NOTIFICATION_BUFFER_SIZE];
+static uint8_t frame[BLE_NOTIFICATION_BUFFER_SIZE];
+static JsonDocument doc;
+
+static const TimeSnapshot TIME = { { 1, 29, 59, 0, 58, 7 }, 1, 0, 123456 };
+
+// A client command ID of the longest accepted length.
+static const char* const LONG_ID = "0123456789abcdef0123456789abcde";
+
+// Builds the JSON notification of a time update with both sides, like the BLE service.
+static size_t serializeTimeUpdate(const TimeSnapshot& snapshot) {
+    doc.clear();
+    doc["type"] = getEventTypeString(DGTEvent::TIME_UPDATE);
+    doc["timestamp"] = snapshot.timestamp;
+    JsonObject data = doc["data"].to<JsonObject>();
+    data["leftHours"] = snapshot.time[0];
+    data["leftMinutes"] = snapshot.time[1];
+    data["leftSeconds"] = snapshot.time[2];
+    data["leftMode"] = snapshot.leftMode;
+    data["rightHours"] = snapshot.time[3];
+    data["rightMinutes"] = snapshot.time[4];
+    data["rightSeconds"] = snapshot.time[5];
+    data["rightMode"] = snapshot.rightMode;
+    return serializeJson(doc, text, sizeof(text));
+}
+
+// Builds the JSON notification of an event, like the BLE service.
+static size_t serializeEvent(const DGTEvent& event) {
+    doc.clear();
+    doc["type"] = getEventTypeString(event.type);
+    doc["timestamp"] = event.timestamp;
+    doc["data"] = event.data;
+    return serializeJson(doc, text, sizeof(text));
+}
+
+// The events of a game, with the data the I2C task gives them.
+static std::vector<DGTEvent> makeEvents() {
+    std::vector<DGTEvent> events;
+
+    DGTEvent press(DGTEvent::BUTTON_EVENT);
+    press.data["button"] = "lever_right";
+    press.data["buttonCode"] = DGT_EVENT_LEVER_RIGHT;
+    press.data["isRepeat"] = false;
+    events.push_back(press);
+
+    DGTEvent repeat(DGTEvent::BUTTON_EVENT);
+    repeat.data["button"] = "plus";
+    repeat.data["buttonCode"] = DGT_BUTTON_PLUS;
+    repeat.data["isRepeat"] = true;
+    repeat.data["repeatCount"] = 3;
+    events.push_back(repeat);
+
+    DGTEvent gesture(DGTEvent::BUTTON_GESTURE);
+    gesture.data["button"] = "play_pause";
+    gesture.data["buttonCode"] = DGT_BUTTON_PLAY_PAUSE;
+    gesture.data["gesture"] = getGestureString(ButtonGestureEngine::Gesture::LONG_PRESS);
+    gesture.data["durationMs"] = 1200;
+    events.push_back(gesture);
+
+    DGTEvent connection(DGTEvent::CONNECTION_STATUS);
+    connection.data["connected"] = true;
+    connection.data["configured"] = true;
+    events.push_back(connection);
+
+    DGTEvent error(DGTEvent::ERROR_EVENT);
+    error.data["errorCode"] = static_cast<uint16_t>(SystemErrorCode::DGT_NOT_CONNECTED);
+    error.data["errorMessage"] = getErrorCodeString(SystemErrorCode::DGT_NOT_CONNECTED);
+    events.push_back(error);
+
+    DGTEvent flagFall(DGTEvent::FLAG_FALL);
+    flagFall.data["side"] = getTimeControlSideString(TimeControlEngine::Side::LEFT);
+    flagFall.data["timestampUs"] = (uint64_t)5400123456ULL;
+    flagFall.data["source"] = "clock";
+    events.push_back(flagFall);
+
+    return events;
+}
+
+// Runs operation count times and returns its mean cost in nanoseconds.
+template <typename Operation>
+static double measureNs(uint32_t count, Operation operation) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; i++) operation();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / count;
+}
+
+// =============================================================================
+// TESTS
+// =============================================================================
+
+void setUp() {}
+void tearDown() {}
+
+void test_time_update_frame() {
+    TEST_ASSERT_EQUAL_UINT32(9, BinaryProtocol::encodeTimeUpdate(TIME, frame, sizeof(frame)));
+    const uint8_t expected[] = { BinaryProtocol::EVT_TIME_UPDATE, 1, 29, 59, 1, 0, 58, 7, 0 };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, sizeof(expected));
+    TEST_ASSERT_EQUAL_UINT32(0, BinaryProtocol::encodeTimeUpdate(TIME, frame, 8));
+}
+
+void test_set_time_command_decodes_like_its_json() {
+    const uint8_t command[] = { BinaryProtocol::CMD_SET_TIME, 0x34, 0x12, 1, 0, 5, 0, 1, 0, 5, 0 };
+    const char* errorMessage;
+    TEST_ASSERT_TRUE(BinaryProtocol::decodeCommand(command, sizeof(command), doc, errorMessage) == SystemErrorCode::SUCCESS);
+    TEST_ASSERT_EQUAL_STRING("#4660", doc["id"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("setTime", doc["command"].as<const char*>());
+    TEST_ASSERT_EQUAL_INT(5, doc["params"]["rightMinutes"].as<int>());
+
+    // One byte short.
+    TEST_ASSERT_TRUE(BinaryProtocol::decodeCommand(command, sizeof(command) - 1, doc, errorMessage) == SystemErrorCode::JSON_INVALID_PARAMETERS);
+    TEST_ASSERT_EQUAL_STRING("#4660", doc["id"].as<const char*>());
+}
+
+void test_retransmitted_command_replays_its_frame() {
+    ResponseCache cache;
+    TEST_ASSERT_TRUE(cache.initialize());
+
+    const uint8_t setTime[] = { BinaryProtocol::CMD_SET_TIME, 0x34, 0x12, 1, 0, 5, 0, 1, 0, 5, 0 };
+    char id[APP_MAX_COMMAND_ID_LENGTH];
+    BinaryProtocol::classifyCommand(setTime, sizeof(setTime), id, sizeof(id));
+    uint8_t cached[RESPONSE_CACHE_ENTRY_SIZE];
+    size_t cachedLength = 0;
+    TEST_ASSERT_EQUAL(ResponseCache::MISS, cache.lookupBinary(id, cached, sizeof(cached), cachedLength));
+    TEST_ASSERT_EQUAL(ResponseCache::PENDING, cache.lookupBinary(id, cached, sizeof(cached), cachedLength));
+
+    // The response frame, as the BLE service sends it.
+    CommandResponse response(id);
+    response.success = true;
+    response.format = CommandFormat::BINARY;
+    size_t length = BinaryProtocol::encodeResponse(response, 5, 3, frame, sizeof(frame));
+    TEST_ASSERT_GREATER_THAN_UINT32(0, length);
+    cache.completeBinary(response.id, frame, length);
+
+    TEST_ASSERT_EQUAL(ResponseCache::HIT, cache.lookupBinary(id, cached, sizeof(cached), cachedLength));
+    TEST_ASSERT_EQUAL_UINT32(length, cachedLength);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, cached, length);
+
+    // A JSON command with the same ID string is another command.
+    TEST_ASSERT_EQUAL(ResponseCache::MISS, cache.lookup(id, text, sizeof(text)));
+}
+
+void test_bytes_on_air() {
+    size_t binaryTime = BinaryProtocol::encodeTimeUpdate(TIME, frame, sizeof(frame));
+    size_t jsonTime = serializeTimeUpdate(TIME);
+    printf("%-16s binary %3u bytes, JSON %3u bytes\n", "timeUpdate", (unsigned)binaryTime, (unsigned)jsonTime);
+    TEST_ASSERT_LESS_THAN_UINT32(jsonTime / 10, binaryTime);
+
+    for (const DGTEvent& event : makeEvents()) {
+        size_t binary = BinaryProtocol::encodeEvent(event, frame, sizeof(frame));
+        size_t json = serializeEvent(event);
+        printf("%-16s binary %3u bytes, JSON %3u bytes\n", getEventTypeString(event.type), (unsigned)binary, (unsigned)json);
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT32(2, binary);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(12, binary);
+        TEST_ASSERT_LESS_THAN_UINT32(json, binary);
+    }
+
+    // A command: the ID takes 2 bytes instead of up to 31 characters.
+    const uint8_t setTime[] = { BinaryProtocol::CMD_SET_TIME, 0x34, 0x12, 1, 0, 5, 0, 1, 0, 5, 0 };
+    size_t jsonCommand = snprintf(text, sizeof(text),
+        "{\"id\":\"%s\",\"command\":\"setTime\",\"params\":{\"leftMode\":1,\"leftHours\":0,\"leftMinutes\":5,"
+        "\"leftSeconds\":0,\"rightMode\":1,\"rightHours\":0,\"rightMinutes\":5,\"rightSeconds\":0}}", LONG_ID);
+    printf("%-16s binary %3u bytes, JSON %3u bytes\n", "setTime", (unsigned)sizeof(setTime), (unsigned)jsonCommand);
+    TEST_ASSERT_LESS_THAN_UINT32(jsonCommand / 10, sizeof(setTime));
+}
+
+void test_encode_and_decode_cost() {
+    const uint32_t count = 20000;
+    volatile size_t sink = 0;
+
+    // Gateway side: notifications are encoded, the client decodes them.
+    double binaryEncode = measureNs(count, [&] { sink = sink + BinaryProtocol::encodeTimeUpdate(TIME, frame, sizeof(frame)); });
+    double jsonEncode = measureNs(count, [&] { sink = sink + serializeTimeUpdate(TIME); });
+    size_t jsonLength = serializeTimeUpdate(TIME);
+    double binaryDecode = measureNs(count, [&] {
+        TimeSnapshot snapshot;
+        memcpy(snapshot.time, frame + 1, 3);
+        snapshot.leftMode = frame[4];
+        memcpy(snapshot.time + 3, frame + 5, 3);
+        snapshot.rightMode = frame[8];
+        sink = sink + snapshot.time[2];
+    });
+    double jsonDecode = measureNs(count, [&] {
+        deserializeJson(doc, text, jsonLength);
+        sink = sink + (doc["data"]["leftSeconds"] | 0);
+    });
+    printf("timeUpdate encode: binary %8.1f ns, JSON %8.1f ns\n", binaryEncode, jsonEncode);
+    printf("timeUpdate decode: binary %8.1f ns, JSON %8.1f ns\n", binaryDecode, jsonDecode);
+
+    // Client side: commands are encoded, the gateway decodes them into the same document.
+    const uint8_t setTime[] = { BinaryProtocol::CMD_SET_TIME, 0x34, 0x12, 1, 0, 5, 0, 1, 0, 5, 0 };
+    size_t jsonCommand = snprintf(text, sizeof(text),
+        "{\"id\":\"%s\",\"command\":\"setTime\",\"params\":{\"leftMode\":1,\"leftHours\":0,\"leftMinutes\":5,"
+        "\"leftSeconds\":0,\"rightMode\":1,\"rightHours\":0,\"rightMinutes\":5,\"rightSeconds\":0}}", LONG_ID);
+    const char* errorMessage;
+    double binaryCommand = measureNs(count, [&] {
+        sink = sink + (int)BinaryProtocol::decodeCommand(setTime, sizeof(setTime), doc, errorMessage);
+    });
+    double jsonCommandCost = measureNs(count, [&] {
+        sink = sink + (deserializeJson(doc, text, jsonCommand) ? 1 : 0);
+    });
+    printf("setTime decode:    binary %8.1f ns, JSON %8.1f ns\n", binaryCommand, jsonCommandCost);
+
+    TEST_ASSERT_TRUE(binaryEncode < jsonEncode);
+    TEST_ASSERT_TRUE(binaryDecode < jsonDecode);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_time_update_frame);
+    RUN_TEST(test_set_time_command_decodes_like_its_json);
+    RUN_TEST(test_retransmitted_command_replays_its_frame);
+    RUN_TEST(test_bytes_on_air);
+    RUN_TEST(test_encode_and_decode_cost);
+    return UNITY_END();
+}
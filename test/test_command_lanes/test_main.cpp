@@ -0,0 +1,202 @@
+/*
+ * Command Lane Tests for DGT3000 Gateway
+ *
+ * These host tests run the command lanes of the QueueManager against a
+ * simulated I2C task and measure how long a stop waits behind display
+ * traffic, compared with the single FIFO the lanes replaced.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <unity.h>
+#include <deque>
+#include <vector>
+#include "QueueManager.h"
+
+// =============================================================================
+// SIMULATED I2C TASK
+// =============================================================================
+
+// Bus time of one DGT3000 transaction (write and acknowledge), and the
+// transactions each command needs: a text is written then shown.
+static constexpr int64_t I2C_TRANSACTION_US = 1000;
+static constexpr int64_t DISPLAY_COST_US = 2 * I2C_TRANSACTION_US;
+static constexpr int64_t STOP_COST_US = I2C_TRANSACTION_US;
+
+// Resolution of the simulation, and the interval between two display commands
+// of the client: faster than the bus, so the display lane stays full.
+static constexpr int64_t STEP_US = 50;
+static constexpr int64_t DISPLAY_INTERVAL_US = 500;
+
+static const char* const DISPLAY_COMMAND = "{\"id\":\"d\",\"command\":\"displayText\",\"params\":{\"text\":\"e2e4\"}}";
+static const char* const STOP_COMMAND = "{\"id\":\"s\",\"command\":\"stop\"}";
+
+static QueueManager queues;
+
+/**
+ * The command lanes, fed like the BLE callback feeds them: each command is
+ * classified from its text and refused when its lane is full.
+ */
+struct LaneQueue {
+    bool send(const char* json) {
+        CommandLane lane = classifyRawCommand(json);
+        if (queues.getCommandLaneFreeSpace(lane) == 0) return false; // BUSY, the client retries later.
+        RawCommandPtr rawCmd = queues.acquireRawCommand();
+        if (!rawCmd) return false;
+        strncpy(rawCmd->jsonData, json, sizeof(rawCmd->jsonData) - 1);
+        rawCmd->length = strlen(rawCmd->jsonData);
+        rawCmd->lane = lane;
+        return queues.sendRawCommand(std::move(rawCmd), 0);
+    }
+
+    // Returns the lane of the next command, false if there is none.
+    bool receive(CommandLane& lane) {
+        RawCommandPtr rawCmd = queues.receiveRawCommand(0);
+        if (!rawCmd) return false;
+        lane = rawCmd->lane;
+        return true;
+    }
+
+    void clear() {
+        while (queues.receiveRawCommand(0) != nullptr) {}
+    }
+};
+
+/**
+ * The single command queue used before the lanes, with the depth of the display lane.
+ */
+struct FifoQueue {
+    std::deque<CommandLane> commands;
+
+    bool send(const char* json) {
+        if (commands.size() >= QUEUE_DISPLAY_COMMAND_SIZE) return false;
+        commands.push_back(classifyRawCommand(json));
+        return true;
+    }
+
+    bool receive(CommandLane& lane) {
+        if (commands.empty()) return false;
+        lane = commands.front();
+        commands.pop_front();
+        return true;
+    }
+
+    void clear() { commands.clear(); }
+};
+
+struct LatencyStats {
+    int64_t meanUs;
+    int64_t p99Us;
+    int64_t maxUs;
+};
+
+/**
+ * Loads the bus with display commands, sends a stop at stopAtUs, and returns
+ * the time from then to the end of its I2C transaction. A refused stop is sent
+ * again at each step. The task takes one command per cycle and is busy on the
+ * bus while it runs.
+ */
+template <typename Queue>
+static int64_t measureStopLatency(Queue& queue, int64_t stopAtUs) {
+    queue.clear();
+    int64_t nextDisplayUs = 0;
+    int64_t busyUntilUs = 0;
+    bool stopSent = false;
+
+    for (int64_t nowUs = 0; nowUs < stopAtUs + 1000000; nowUs += STEP_US) {
+        while (nextDisplayUs <= nowUs) {
+            queue.send(DISPLAY_COMMAND);
+            nextDisplayUs += DISPLAY_INTERVAL_US;
+        }
+        if (!stopSent && nowUs >= stopAtUs) {
+            stopSent = queue.send(STOP_COMMAND);
+        }
+
+        CommandLane lane;
+        if (nowUs >= busyUntilUs && queue.receive(lane)) {
+            busyUntilUs = nowUs + (lane == CommandLane::CONTROL ? STOP_COST_US : DISPLAY_COST_US);
+            if (lane == CommandLane::CONTROL) return busyUntilUs - stopAtUs;
+        }
+    }
+    return -1;
+}
+
+// Sends the stop at every phase of the display traffic, once the lanes are full.
+template <typename Queue>
+static LatencyStats benchmarkStopLatency(Queue& queue) {
+    std::vector<int64_t> latencies;
+    for (int64_t stopAtUs = 100000; stopAtUs < 100000 + 4 * DISPLAY_COST_US; stopAtUs += STEP_US) {
+        latencies.push_back(measureStopLatency(queue, stopAtUs));
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    int64_t sum = 0;
+    for (int64_t latency : latencies) sum += latency;
+    return { sum / (int64_t)latencies.size(), latencies[latencies.size() * 99 / 100], latencies.back() };
+}
+
+// =============================================================================
+// TESTS
+// =============================================================================
+
+void setUp() {
+    if (!queues.isInitialized()) queues.initialize();
+}
+
+void tearDown() {
+    LaneQueue().clear();
+}
+
+void test_stop_is_received_before_pending_display_commands() {
+    LaneQueue lanes;
+    for (int i = 0; i < 5; i++) TEST_ASSERT_TRUE(lanes.send(DISPLAY_COMMAND));
+    TEST_ASSERT_TRUE(lanes.send(STOP_COMMAND));
+
+    CommandLane lane;
+    TEST_ASSERT_TRUE(lanes.receive(lane));
+    TEST_ASSERT_TRUE(lane == CommandLane::CONTROL);
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(lanes.receive(lane));
+        TEST_ASSERT_TRUE(lane == CommandLane::DISPLAY);
+    }
+    TEST_ASSERT_FALSE(lanes.receive(lane));
+}
+
+void test_full_display_lane_does_not_refuse_a_stop() {
+    LaneQueue lanes;
+    for (uint32_t i = 0; i < QUEUE_DISPLAY_COMMAND_SIZE; i++) TEST_ASSERT_TRUE(lanes.send(DISPLAY_COMMAND));
+    TEST_ASSERT_FALSE(lanes.send(DISPLAY_COMMAND));
+    TEST_ASSERT_TRUE(lanes.send(STOP_COMMAND));
+    TEST_ASSERT_EQUAL_UINT16(QUEUE_DISPLAY_COMMAND_SIZE, queues.getCommandLaneDepth(CommandLane::DISPLAY));
+    TEST_ASSERT_EQUAL_UINT16(1, queues.getCommandLaneDepth(CommandLane::CONTROL));
+}
+
+void test_stop_latency_under_display_load() {
+    LaneQueue lanes;
+    FifoQueue fifo;
+    LatencyStats laneStats = benchmarkStopLatency(lanes);
+    LatencyStats fifoStats = benchmarkStopLatency(fifo);
+
+    printf("Stop latency under display load (us): lanes mean %lld p99 %lld max %lld, "
+           "single FIFO mean %lld p99 %lld max %lld\n",
+           (long long)laneStats.meanUs, (long long)laneStats.p99Us, (long long)laneStats.maxUs,
+           (long long)fifoStats.meanUs, (long long)fifoStats.p99Us, (long long)fifoStats.maxUs);
+
+    // With the lanes a stop only waits for the display command already on the bus.
+    TEST_ASSERT_LESS_OR_EQUAL_INT64(DISPLAY_COST_US + STOP_COST_US + STEP_US, laneStats.maxUs);
+    // Behind a single FIFO it waits for the whole display backlog.
+    TEST_ASSERT_GREATER_OR_EQUAL_INT64((int64_t)(QUEUE_DISPLAY_COMMAND_SIZE - 1) * DISPLAY_COST_US, fifoStats.meanUs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_stop_is_received_before_pending_display_commands);
+    RUN_TEST(test_full_display_lane_does_not_refuse_a_stop);
+    RUN_TEST(test_stop_latency_under_display_load);
+    return UNITY_END();
+}
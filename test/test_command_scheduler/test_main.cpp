@@ -0,0 +1,210 @@
+/*
+ * Command Scheduler Tests for DGT3000 Gateway
+ *
+ * These host tests check the order in which scheduled commands come out of
+ * the timer queue, and that the I2C task starts them on time while display
+ * updates keep a fake clock bus busy.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <unity.h>
+#include <algorithm>
+#include <vector>
+#include "BLEGatewayTypes.h"
+#include "CommandTimerQueue.h"
+#include "DGT3000Fake.h"
+#include "I2CTaskManager.h"
+
+static RawBLECommand commands[SCHEDULER_MAX_PENDING_COMMANDS];
+
+// =============================================================================
+// I2C TASK AGAINST THE FAKE DRIVER
+// =============================================================================
+
+// An acknowledged clock command (display write, setAndRun, stop) switches the
+// listen address twice (2 x 10 ms) and polls for the ACK in 5 ms steps.
+static constexpr uint32_t ACKED_COMMAND_US = 25000;
+
+static constexpr int ROUNDS = 8;
+
+static QueueManager queues;
+static SystemStatus status;
+
+// Reads the responses and events, like the BLE service notifying them.
+static void drainNotifications() {
+    while (queues.receiveResponse(0) != nullptr) {}
+    while (queues.receiveEvent() != nullptr) {}
+}
+
+// Sends a command like the BLE write callback does, retrying while its lane is full.
+static bool sendCommand(const char* json) {
+    CommandLane lane = classifyRawCommand(json);
+    uint32_t start = millis();
+    while (queues.getCommandLaneFreeSpace(lane) == 0) {
+        if (millis() - start > 2000) return false;
+        drainNotifications();
+        delay(1);
+    }
+    RawCommandPtr rawCmd = queues.acquireRawCommand();
+    if (!rawCmd) return false;
+    strncpy(rawCmd->jsonData, json, sizeof(rawCmd->jsonData) - 1);
+    rawCmd->length = strlen(rawCmd->jsonData);
+    rawCmd->lane = lane;
+    return queues.sendRawCommand(std::move(rawCmd), 0);
+}
+
+// Sends a setTime or stop command due at atMs, with a new ID.
+static bool sendScheduled(const char* command, uint32_t atMs) {
+    static uint32_t sequence = 0;
+    char json[192];
+    if (strcmp(command, "setTime") == 0) {
+        snprintf(json, sizeof(json), "{\"id\":\"s%u\",\"command\":\"setTime\",\"at\":%u,\"params\":"
+                 "{\"leftMode\":1,\"leftMinutes\":5,\"rightMode\":0,\"rightMinutes\":5}}", ++sequence, atMs);
+    } else {
+        snprintf(json, sizeof(json), "{\"id\":\"s%u\",\"command\":\"%s\",\"at\":%u}", ++sequence, command, atMs);
+    }
+    return sendCommand(json);
+}
+
+// =============================================================================
+// TESTS
+// =============================================================================
+
+void setUp() {}
+void tearDown() {}
+
+void test_commands_come_out_by_due_time() {
+    CommandTimerQueue queue;
+    const int64_t dueTimesUs[] = { 5000, 1000, 3000, 1000, 8000, 2000, 3000, 1000 };
+    for (size_t i = 0; i < SCHEDULER_MAX_PENDING_COMMANDS; i++) {
+        TEST_ASSERT_TRUE(queue.push(&commands[i], dueTimesUs[i]));
+    }
+
+    // Equal due times keep the push order.
+    const size_t expected[] = { 1, 3, 7, 5, 2, 6, 0, 4 };
+    for (size_t i = 0; i < SCHEDULER_MAX_PENDING_COMMANDS; i++) {
+        int64_t dueTimeUs;
+        TEST_ASSERT_TRUE(queue.pop(dueTimeUs) == &commands[expected[i]]);
+        TEST_ASSERT_EQUAL_INT64(dueTimesUs[expected[i]], dueTimeUs);
+    }
+    int64_t dueTimeUs;
+    TEST_ASSERT_NULL(queue.pop(dueTimeUs));
+}
+
+void test_push_order_survives_interleaved_pops() {
+    CommandTimerQueue queue;
+    int64_t dueTimeUs;
+    TEST_ASSERT_TRUE(queue.push(&commands[0], 1000));
+    TEST_ASSERT_TRUE(queue.push(&commands[1], 1000));
+    TEST_ASSERT_TRUE(queue.pop(dueTimeUs) == &commands[0]);
+    TEST_ASSERT_TRUE(queue.push(&commands[2], 1000));
+    TEST_ASSERT_TRUE(queue.push(&commands[3], 500));
+    TEST_ASSERT_TRUE(queue.pop(dueTimeUs) == &commands[3]);
+    TEST_ASSERT_TRUE(queue.pop(dueTimeUs) == &commands[1]);
+    TEST_ASSERT_TRUE(queue.pop(dueTimeUs) == &commands[2]);
+}
+
+void test_full_queue_refuses_a_command() {
+    CommandTimerQueue queue;
+    for (size_t i = 0; i < SCHEDULER_MAX_PENDING_COMMANDS; i++) {
+        TEST_ASSERT_TRUE(queue.push(&commands[i], 1000));
+    }
+    TEST_ASSERT_TRUE(queue.isFull());
+    TEST_ASSERT_FALSE(queue.push(&commands[0], 0));
+    TEST_ASSERT_EQUAL_UINT8(SCHEDULER_MAX_PENDING_COMMANDS, queue.size());
+}
+
+void test_sleep_ends_before_the_due_time() {
+    CommandTimerQueue queue;
+    TEST_ASSERT_EQUAL_INT64(INT64_MAX, queue.getTimeUntilSpinUs(0));
+    TEST_ASSERT_FALSE(queue.isDue(0));
+
+    queue.push(&commands[0], 10000);
+    TEST_ASSERT_EQUAL_INT64(10000 - SCHEDULER_SPIN_THRESHOLD_US, queue.getTimeUntilSpinUs(0));
+    TEST_ASSERT_FALSE(queue.isDue(10000 - SCHEDULER_SPIN_THRESHOLD_US - 1));
+    TEST_ASSERT_TRUE(queue.isDue(10000 - SCHEDULER_SPIN_THRESHOLD_US));
+    TEST_ASSERT_EQUAL_INT64(0, queue.getTimeUntilSpinUs(20000));
+}
+
+void test_commands_start_on_time_amid_i2c_work() {
+    DGT3000Fake::reset();
+    queues.initialize();
+    I2CTaskManager manager(&queues, &status);
+    TEST_ASSERT_TRUE(manager.initialize());
+    TEST_ASSERT_TRUE(manager.startTask());
+    manager.onBLEConnected();
+    uint32_t start = millis();
+    while (DGT3000Fake::getCallCount("configure") == 0 && millis() - start < 2000) delay(1);
+
+    DGT3000Fake::setCallCost("displayText", ACKED_COMMAND_US);
+    DGT3000Fake::setCallCost("setAndRun", ACKED_COMMAND_US);
+    DGT3000Fake::setCallCost("stop", ACKED_COMMAND_US);
+
+    // Each round: two commands due together, one due 10 ms later (within the
+    // first transaction), one alone, and display updates all along.
+    std::vector<int64_t> dueTimesUs;
+    for (int round = 0; round < ROUNDS; round++) {
+        uint32_t baseMs = millis() + 200;
+        TEST_ASSERT_TRUE(sendScheduled("setTime", baseMs));
+        TEST_ASSERT_TRUE(sendScheduled("stop", baseMs));
+        TEST_ASSERT_TRUE(sendScheduled("setTime", baseMs + 10));
+        TEST_ASSERT_TRUE(sendScheduled("stop", baseMs + 100));
+        dueTimesUs.push_back(baseMs * 1000LL);
+        dueTimesUs.push_back(baseMs * 1000LL);
+        dueTimesUs.push_back((baseMs + 10) * 1000LL);
+        dueTimesUs.push_back((baseMs + 100) * 1000LL);
+
+        for (int i = 0; millis() < baseMs + 150; i++) {
+            char json[96];
+            snprintf(json, sizeof(json), "{\"id\":\"d\",\"command\":\"displayText\",\"params\":{\"text\":\"%d\"}}", i);
+            TEST_ASSERT_TRUE(sendCommand(json));
+            drainNotifications();
+            delay(5);
+        }
+    }
+
+    manager.stopTask();
+    manager.cleanup();
+
+    // Only the scheduled commands call setAndRun and stop.
+    std::vector<DGT3000Fake::Transaction> scheduled;
+    uint32_t displayWrites = 0;
+    for (const DGT3000Fake::Transaction& transaction : DGT3000Fake::getTransactions()) {
+        if (transaction.method == "displayText") {
+            displayWrites++;
+        } else {
+            scheduled.push_back(transaction);
+        }
+    }
+    TEST_ASSERT_EQUAL(dueTimesUs.size(), scheduled.size());
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(ROUNDS, displayWrites);
+
+    // A command starts at its due time, or right after the command before it
+    // when that one still holds the bus: never after other I2C work.
+    int64_t maxDelayUs = 0;
+    for (size_t i = 0; i < scheduled.size(); i++) {
+        int64_t expectedUs = dueTimesUs[i];
+        if (i > 0) expectedUs = std::max(expectedUs, scheduled[i - 1].endUs);
+        TEST_ASSERT_GREATER_OR_EQUAL_INT64(dueTimesUs[i], scheduled[i].startUs);
+        maxDelayUs = std::max(maxDelayUs, scheduled[i].startUs - expectedUs);
+    }
+    printf("Scheduled commands: %u executed amid %u display writes, started at most %lld us late\n",
+           (unsigned)scheduled.size(), (unsigned)displayWrites, (long long)maxDelayUs);
+    TEST_ASSERT_LESS_THAN_INT64(1000, maxDelayUs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_commands_come_out_by_due_time);
+    RUN_TEST(test_push_order_survives_interleaved_pops);
+    RUN_TEST(test_full_queue_refuses_a_command);
+    RUN_TEST(test_sleep_ends_before_the_due_time);
+    RUN_TEST(test_commands_start_on_time_amid_i2c_work);
+    return UNITY_END();
+}
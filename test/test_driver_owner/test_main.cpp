@@ -0,0 +1,183 @@
+/*
+ * Driver Ownership Tests for DGT3000 Gateway
+ *
+ * These host tests run the I2C task manager on a thread, with a fake DGT3000
+ * driver, while the main thread plays the BLE host task: it connects,
+ * sends commands and disconnects. They check that only the I2C task ever
+ * calls the driver, and that the BLE callbacks return without waiting for it.
+ * They also check that a routine getStatus fits in one notification.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <unity.h>
+#include "DGT3000Fake.h"
+#include "I2CTaskManager.h"
+
+static QueueManager queues;
+static SystemStatus status;
+
+// Reads the responses and events, like the BLE service notifying them.
+static void drainNotifications() {
+    while (queues.receiveResponse(0) != nullptr) {}
+    while (queues.receiveEvent() != nullptr) {}
+}
+
+// Sends a command like the BLE write callback does, retrying while its lane is full.
+static bool sendCommand(const char* json) {
+    CommandLane lane = classifyRawCommand(json);
+    uint32_t start = millis();
+    while (queues.getCommandLaneFreeSpace(lane) == 0) {
+        if (millis() - start > 2000) return false;
+        drainNotifications();
+        delay(1);
+    }
+    RawCommandPtr rawCmd = queues.acquireRawCommand();
+    if (!rawCmd) return false;
+    strncpy(rawCmd->jsonData, json, sizeof(rawCmd->jsonData) - 1);
+    rawCmd->length = strlen(rawCmd->jsonData);
+    rawCmd->lane = lane;
+    return queues.sendRawCommand(std::move(rawCmd), 0);
+}
+
+// Waits up to timeoutMs for the response to a command ID, dropping the other messages.
+static ResponsePtr waitForResponse(const char* id, uint32_t timeoutMs = 2000) {
+    uint32_t start = millis();
+    while (millis() - start < timeoutMs) {
+        ResponsePtr response = queues.receiveResponse(10);
+        if (response && strcmp(response->id, id) == 0) return response;
+        while (queues.receiveEvent() != nullptr) {}
+    }
+    return nullptr;
+}
+
+// Waits up to timeoutMs for a driver method to have been called count times.
+static bool waitForCalls(const char* method, uint32_t count, uint32_t timeoutMs = 2000) {
+    uint32_t start = millis();
+    while (DGT3000Fake::getCallCount(method) < count) {
+        if (millis() - start > timeoutMs) return false;
+        drainNotifications();
+        delay(1);
+    }
+    return true;
+}
+
+// =============================================================================
+// TESTS
+// =============================================================================
+
+void setUp() {
+    DGT3000Fake::reset();
+    queues.initialize();
+}
+
+void tearDown() {
+    drainNotifications();
+}
+
+void test_only_the_i2c_task_calls_the_driver() {
+    I2CTaskManager manager(&queues, &status);
+    TEST_ASSERT_TRUE(manager.initialize());
+    TEST_ASSERT_TRUE(manager.startTask());
+
+    // The task brings the clock up on its own.
+    TEST_ASSERT_TRUE(waitForCalls("configure", 1));
+
+    // The BLE host task: callbacks and commands, some of them in bursts.
+    int64_t maxCallbackUs = 0;
+    int64_t startUs = esp_timer_get_time();
+    manager.onBLEConnected();
+    maxCallbackUs = std::max(maxCallbackUs, esp_timer_get_time() - startUs);
+    for (int i = 0; i < 20; i++) {
+        TEST_ASSERT_TRUE(sendCommand("{\"id\":\"d\",\"command\":\"displayText\",\"params\":{\"text\":\"e2e4\"}}"));
+        TEST_ASSERT_TRUE(sendCommand("{\"id\":\"t\",\"command\":\"getTime\"}"));
+        if (i % 5 == 0) TEST_ASSERT_TRUE(sendCommand("{\"id\":\"s\",\"command\":\"stop\"}"));
+        drainNotifications();
+    }
+    TEST_ASSERT_TRUE(waitForCalls("stop", 4));
+    DGT3000Fake::pushButtonEvent(DGT_EVENT_LEVER_RIGHT);
+    TEST_ASSERT_TRUE(waitForCalls("getButtonEvent", DGT3000Fake::getCallCount("getButtonEvent") + 2));
+
+    startUs = esp_timer_get_time();
+    manager.onBLEDisconnected();
+    maxCallbackUs = std::max(maxCallbackUs, esp_timer_get_time() - startUs);
+    TEST_ASSERT_TRUE(waitForCalls("end", 1));
+
+    manager.stopTask();
+    manager.cleanup();
+
+    std::vector<std::thread::id> callers = DGT3000Fake::getCallerThreads();
+    printf("Driver: %u calls from %u thread(s), BLE callbacks returned in at most %lld us\n",
+           (unsigned)DGT3000Fake::getCallCount(), (unsigned)callers.size(), (long long)maxCallbackUs);
+
+    TEST_ASSERT_GREATER_THAN_UINT32(0, DGT3000Fake::getCallCount("displayText"));
+    TEST_ASSERT_EQUAL_UINT32(1, callers.size());
+    TEST_ASSERT_TRUE(callers[0] != std::this_thread::get_id());
+    // The callbacks only post a message: they never wait for an I2C transaction.
+    TEST_ASSERT_LESS_THAN_INT64(I2C_TASK_UPDATE_INTERVAL_MS * 1000, maxCallbackUs);
+}
+
+void test_callbacks_without_a_task_do_not_touch_the_driver() {
+    I2CTaskManager manager(&queues, &status);
+    TEST_ASSERT_TRUE(manager.initialize());
+
+    manager.onBLEConnected();
+    manager.onBLEDisconnected();
+    manager.cleanup();
+
+    TEST_ASSERT_EQUAL_UINT32(0, DGT3000Fake::getCallCount());
+}
+
+void test_routine_status_fits_one_notification() {
+    I2CTaskManager manager(&queues, &status);
+    TEST_ASSERT_TRUE(manager.initialize());
+    TEST_ASSERT_TRUE(manager.startTask());
+    TEST_ASSERT_TRUE(waitForCalls("configure", 1));
+
+    // The longest accepted ID, so the whole notification is measured.
+    const char* const id = "0123456789abcdef0123456789abcde";
+    uint32_t heapFallbacks = queues.getResponsePoolStats().heapFallbacks;
+    char command[96];
+    snprintf(command, sizeof(command), "{\"id\":\"%s\",\"command\":\"getStatus\"}", id);
+    TEST_ASSERT_TRUE(sendCommand(command));
+    ResponsePtr response = waitForResponse(id);
+    TEST_ASSERT_NOT_NULL(response.get());
+    TEST_ASSERT_TRUE(response->success);
+
+    // The notification, as the BLE service builds it.
+    JsonDocument notification;
+    notification["type"] = "command_response";
+    notification["id"] = response->id;
+    notification["status"] = "success";
+    notification["result"] = response->result;
+    notification["credits"] = QUEUE_CONTROL_COMMAND_SIZE;
+    notification["displayCredits"] = QUEUE_DISPLAY_COMMAND_SIZE;
+    size_t length = measureJson(notification);
+    printf("getStatus: %u bytes of %u\n", (unsigned)length, (unsigned)BLE_NOTIFICATION_BUFFER_SIZE);
+    TEST_ASSERT_LESS_THAN_UINT32(BLE_NOTIFICATION_BUFFER_SIZE, length);
+    TEST_ASSERT_EQUAL_UINT32(heapFallbacks, queues.getResponsePoolStats().heapFallbacks);
+
+    // The ring and pool details are asked for separately.
+    TEST_ASSERT_TRUE(sendCommand("{\"id\":\"q\",\"command\":\"getQueueStats\"}"));
+    response = waitForResponse("q");
+    TEST_ASSERT_NOT_NULL(response.get());
+    TEST_ASSERT_EQUAL_UINT32(8, response->result["rings"].size());
+    TEST_ASSERT_EQUAL_UINT32(3, response->result["pools"].size());
+    TEST_ASSERT_TRUE(response->result["rings"]["controlCmdQueue"]["enq"].as<uint32_t>() >= 2);
+
+    manager.stopTask();
+    manager.cleanup();
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_only_the_i2c_task_calls_the_driver);
+    RUN_TEST(test_callbacks_without_a_task_do_not_touch_the_driver);
+    RUN_TEST(test_routine_status_fits_one_notification);
+    return UNITY_END();
+}
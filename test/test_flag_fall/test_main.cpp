@@ -0,0 +1,276 @@
+/*
+ * Flag Fall Tests for DGT3000 Gateway
+ *
+ * These host tests run simulated clocks down to zero and check that the
+ * clock model finds the flag-fall instant, as the I2C task polls it.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <unity.h>
+#include "ClockModel.h"
+#include "TimeControlEngine.h"
+
+using Side = TimeControlEngine::Side;
+
+// =============================================================================
+// SIMULATED CLOCK
+// =============================================================================
+
+// Longest sleep of the I2C task between two cycles, and the time a cycle takes.
+static constexpr int64_t TASK_PERIOD_US = 10000;
+static constexpr int64_t TASK_CYCLE_US = 50;
+
+/**
+ * A DGT3000 with one side counting down. Its oscillator runs driftPpm slower
+ * than the gateway, and each time message reaches the gateway latencyUs after
+ * the displayed second changed. The display shows the remaining time rounded
+ * up to the second, so a change to S happens when exactly S seconds remain.
+ * The messages below silentBelowSeconds are lost.
+ */
+struct SimulatedClock {
+    Side running;
+    uint32_t startSeconds;
+    int64_t startUs;
+    int32_t driftPpm;
+    int64_t latencyUs;
+    uint32_t silentBelowSeconds;
+
+    int64_t getFlagUs() const {
+        return startUs + (int64_t)startSeconds * (1000000 + driftPpm);
+    }
+
+    // Gateway time at which the running side starts to display `seconds`.
+    int64_t getChangeUs(uint32_t seconds) const {
+        return startUs + (int64_t)(startSeconds - seconds) * (1000000 + driftPpm);
+    }
+
+    void fillTime(uint32_t seconds, uint8_t time[6]) const {
+        uint8_t* running = (this->running == Side::LEFT) ? &time[0] : &time[3];
+        uint8_t* stopped = (this->running == Side::LEFT) ? &time[3] : &time[0];
+        running[0] = seconds / 3600;
+        running[1] = (seconds / 60) % 60;
+        running[2] = seconds % 60;
+        memset(stopped, 0, 3);
+    }
+
+    // Sets the clock, as the gateway does when it writes a time and run modes.
+    void start(ClockModel& model) const {
+        uint8_t time[6];
+        fillTime(startSeconds, time);
+        uint8_t leftMode = (running == Side::LEFT) ? DGT_MODE_COUNT_DOWN : DGT_MODE_STOP;
+        uint8_t rightMode = (running == Side::RIGHT) ? DGT_MODE_COUNT_DOWN : DGT_MODE_STOP;
+        model.onClockSet(leftMode, rightMode, time, startUs);
+    }
+};
+
+struct FlagResult {
+    int flags;           ///< Flag falls reported.
+    Side side;
+    int64_t flagUs;      ///< Instant reported by the model.
+    int64_t detectedUs;  ///< Gateway time of the cycle that reported it.
+    bool fromClock;
+};
+
+/**
+ * Runs the I2C task loop against the simulated clock until endUs: each cycle
+ * decodes the time messages received so far, polls checkFlagFall(), then
+ * sleeps like getSleepTimeMs() does, waking up early when a flag can fall.
+ */
+static FlagResult runDown(ClockModel& model, const SimulatedClock& clock, int64_t endUs) {
+    FlagResult result = { 0, Side::NONE, 0, 0, false };
+    uint32_t nextSeconds = clock.startSeconds - 1;
+    bool messagesLeft = clock.startSeconds > 0;
+
+    int64_t nowUs = clock.startUs;
+    while (nowUs < endUs) {
+        while (messagesLeft && clock.getChangeUs(nextSeconds) + clock.latencyUs <= nowUs) {
+            if (nextSeconds >= clock.silentBelowSeconds) {
+                uint8_t time[6];
+                clock.fillTime(nextSeconds, time);
+                model.onTimeMessage(time, clock.getChangeUs(nextSeconds) + clock.latencyUs);
+            }
+            messagesLeft = nextSeconds-- > 0;
+        }
+
+        Side side;
+        int64_t flagUs;
+        bool fromClock;
+        if (model.checkFlagFall(nowUs, side, flagUs, fromClock)) {
+            if (result.flags++ == 0) {
+                result.side = side;
+                result.flagUs = flagUs;
+                result.detectedUs = nowUs;
+                result.fromClock = fromClock;
+            }
+        }
+
+        int64_t sleepUs = TASK_PERIOD_US;
+        int64_t untilFlagUs = model.getTimeUntilFlagUs(nowUs);
+        if (untilFlagUs / 1000 * 1000 < sleepUs) sleepUs = untilFlagUs / 1000 * 1000;
+        nowUs += TASK_CYCLE_US + sleepUs;
+    }
+    return result;
+}
+
+// =============================================================================
+// TESTS
+// =============================================================================
+
+void setUp() {}
+void tearDown() {}
+
+void test_flag_falls_at_the_zero_instant() {
+    ClockModel model;
+    SimulatedClock clock = { Side::LEFT, 5, 1000000, 0, 2000, 0 };
+    clock.start(model);
+
+    FlagResult result = runDown(model, clock, clock.getFlagUs() + 2000000);
+
+    // The model is anchored when the messages arrive, so it is late by their latency at most.
+    TEST_ASSERT_EQUAL(1, result.flags);
+    TEST_ASSERT_TRUE(result.side == Side::LEFT);
+    TEST_ASSERT_GREATER_OR_EQUAL_INT64(clock.getFlagUs(), result.flagUs);
+    TEST_ASSERT_LESS_OR_EQUAL_INT64(clock.getFlagUs() + clock.latencyUs, result.flagUs);
+    // The task wakes up for the flag instead of finding it at its next period.
+    TEST_ASSERT_GREATER_OR_EQUAL_INT64(result.flagUs, result.detectedUs);
+    TEST_ASSERT_LESS_OR_EQUAL_INT64(result.flagUs + 1000, result.detectedUs);
+}
+
+void test_flag_fall_follows_a_drifting_clock() {
+    ClockModel model;
+    SimulatedClock clock = { Side::RIGHT, 600, 0, 1000, 1000, 30 };
+    clock.start(model);
+
+    FlagResult result = runDown(model, clock, clock.getFlagUs() + 2000000);
+
+    // The last 30 s are extrapolated: without the drift the flag would fall 30 ms early.
+    TEST_ASSERT_EQUAL(1, result.flags);
+    TEST_ASSERT_TRUE(result.side == Side::RIGHT);
+    TEST_ASSERT_FALSE(result.fromClock);
+    TEST_ASSERT_INT64_WITHIN(clock.latencyUs + 1000, clock.getFlagUs(), result.flagUs);
+    TEST_ASSERT_INT32_WITHIN(50, clock.driftPpm, model.getDriftPpm());
+}
+
+void test_clock_message_reports_an_earlier_flag() {
+    ClockModel model;
+    SimulatedClock clock = { Side::LEFT, 3, 0, 0, 0, 0 };
+    clock.start(model);
+
+    // The clock shows 0:00:00 before the model expected it (its run started
+    // earlier than the write the gateway knows about).
+    uint8_t zero[6] = { 0, 0, 0, 0, 0, 0 };
+    int64_t arrivalUs = 2500000;
+    model.onTimeMessage(zero, arrivalUs);
+
+    Side side;
+    int64_t flagUs;
+    bool fromClock;
+    TEST_ASSERT_TRUE(model.checkFlagFall(arrivalUs, side, flagUs, fromClock));
+    TEST_ASSERT_TRUE(side == Side::LEFT);
+    TEST_ASSERT_TRUE(fromClock);
+    TEST_ASSERT_EQUAL_INT64(arrivalUs, flagUs);
+}
+
+void test_flag_is_reported_once_until_the_side_is_set() {
+    ClockModel model;
+    SimulatedClock clock = { Side::LEFT, 2, 0, 0, 1000, 0 };
+    clock.start(model);
+
+    FlagResult result = runDown(model, clock, 10000000);
+    TEST_ASSERT_EQUAL(1, result.flags);
+    TEST_ASSERT_EQUAL_INT64(INT64_MAX, model.getTimeUntilFlagUs(10000000));
+
+    // Setting a time again arms the side for a new flag fall.
+    SimulatedClock again = { Side::LEFT, 3, 20000000, 0, 1000, 0 };
+    again.start(model);
+    result = runDown(model, again, again.getFlagUs() + 1000000);
+    TEST_ASSERT_EQUAL(1, result.flags);
+    TEST_ASSERT_INT64_WITHIN(again.latencyUs, again.getFlagUs(), result.flagUs);
+}
+
+void test_stopped_and_counting_up_sides_never_flag() {
+    ClockModel model;
+    uint8_t time[6] = { 0, 0, 0, 0, 0, 0 };
+    model.onClockSet(DGT_MODE_STOP, DGT_MODE_COUNT_UP, time, 0);
+
+    Side side;
+    int64_t flagUs;
+    bool fromClock;
+    TEST_ASSERT_EQUAL_INT64(INT64_MAX, model.getTimeUntilFlagUs(0));
+    TEST_ASSERT_FALSE(model.checkFlagFall(60000000, side, flagUs, fromClock));
+    TEST_ASSERT_EQUAL_UINT32(60000, model.getTimeMs(Side::RIGHT, 60000000));
+}
+
+void test_time_until_flag() {
+    ClockModel model;
+    SimulatedClock clock = { Side::RIGHT, 2, 1000000, 0, 0, 0 };
+    clock.start(model);
+
+    TEST_ASSERT_EQUAL_INT64(1500000, model.getTimeUntilFlagUs(1500000));
+    TEST_ASSERT_EQUAL_INT64(0, model.getTimeUntilFlagUs(4000000));
+}
+
+void test_game_with_time_control_ends_on_flag_fall() {
+    // 10 s + 1 s Fischer: left plays every move in 2 s, right in 4 s, so
+    // right runs out of time first.
+    TimeControlEngine engine;
+    TimeControlEngine::Period period = { 0, 10, 1 };
+    TimeControlEngine::ClockSetting setting;
+    const char* err = nullptr;
+    TEST_ASSERT_TRUE(engine.configure(TimeControlEngine::Mode::FISCHER, &period, 1, setting, err));
+
+    ClockModel model;
+    int64_t nowUs = 0;
+    Side side;
+    int64_t flagUs;
+    bool fromClock;
+    bool flagged = false;
+
+    // Right presses the lever to start the game: left is on move.
+    Side lever = Side::RIGHT;
+    uint32_t left = setting.leftSeconds;
+    uint32_t right = setting.rightSeconds;
+    for (int move = 0; move < 20 && !flagged; move++) {
+        TEST_ASSERT_TRUE(engine.onMove(lever, left, right, (uint32_t)(nowUs / 1000), setting));
+        uint8_t time[6] = { 0, 0, (uint8_t)setting.leftSeconds, 0, 0, (uint8_t)setting.rightSeconds };
+        model.onClockSet(setting.running == Side::LEFT ? DGT_MODE_COUNT_DOWN : DGT_MODE_STOP,
+                         setting.running == Side::RIGHT ? DGT_MODE_COUNT_DOWN : DGT_MODE_STOP, time, nowUs);
+
+        // The side on move thinks, then presses its lever.
+        int64_t thinkUs = (setting.running == Side::LEFT) ? 2000000 : 4000000;
+        int64_t moveEndUs = nowUs + thinkUs;
+        while (nowUs < moveEndUs) {
+            nowUs += TASK_PERIOD_US;
+            if (model.checkFlagFall(nowUs, side, flagUs, fromClock)) {
+                flagged = true;
+                break;
+            }
+        }
+        left = model.getTimeMs(Side::LEFT, nowUs) / 1000;
+        right = model.getTimeMs(Side::RIGHT, nowUs) / 1000;
+        lever = setting.running;
+    }
+
+    TEST_ASSERT_TRUE(flagged);
+    TEST_ASSERT_TRUE(side == Side::RIGHT);
+    TEST_ASSERT_FALSE(fromClock);
+    TEST_ASSERT_EQUAL_UINT32(0, model.getTimeMs(Side::RIGHT, nowUs));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_flag_falls_at_the_zero_instant);
+    RUN_TEST(test_flag_fall_follows_a_drifting_clock);
+    RUN_TEST(test_clock_message_reports_an_earlier_flag);
+    RUN_TEST(test_flag_is_reported_once_until_the_side_is_set);
+    RUN_TEST(test_stopped_and_counting_up_sides_never_flag);
+    RUN_TEST(test_time_until_flag);
+    RUN_TEST(test_game_with_time_control_ends_on_flag_fall);
+    return UNITY_END();
+}
@@ -0,0 +1,201 @@
+/*
+ * SPSC Ring Tests for DGT3000 Gateway
+ *
+ * These host tests check the order, bounds and waits of the lock-free ring
+ * used between the I2C task and the BLE side, and benchmark it with two
+ * threads against the FreeRTOS queue of pointers it replaced.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <unity.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <freertos/queue.h>
+#include "SpscRing.h"
+
+// A message with its send time, the size of a ring entry.
+struct Message {
+    uint32_t sequence;
+    int64_t sentNs;
+};
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// =============================================================================
+// QUEUES UNDER TEST
+// =============================================================================
+
+// The messages travel inline in the ring.
+struct RingChannel {
+    SpscRing<Message, QUEUE_RESPONSE_SIZE> ring;
+
+    bool send(Message& message) { return ring.push(message, QUEUE_OPERATION_TIMEOUT_MS); }
+    bool receive(Message& message) { return ring.pop(message, QUEUE_OPERATION_TIMEOUT_MS); }
+};
+
+// The queues the rings replaced: a FreeRTOS queue of pointers to messages
+// allocated by the producer and freed by the consumer.
+struct FreeRTOSChannel {
+    QueueHandle_t queue = xQueueCreate(QUEUE_RESPONSE_SIZE, sizeof(Message*));
+    ~FreeRTOSChannel() { vQueueDelete(queue); }
+
+    bool send(Message& message) {
+        Message* copy = new Message(message);
+        if (xQueueSend(queue, &copy, pdMS_TO_TICKS(QUEUE_OPERATION_TIMEOUT_MS)) != pdTRUE) {
+            delete copy;
+            return false;
+        }
+        return true;
+    }
+
+    bool receive(Message& message) {
+        Message* copy = nullptr;
+        if (xQueueReceive(queue, &copy, pdMS_TO_TICKS(QUEUE_OPERATION_TIMEOUT_MS)) != pdTRUE) return false;
+        message = *copy;
+        delete copy;
+        return true;
+    }
+};
+
+struct BenchmarkResult {
+    double opsPerSecond;
+    double p99Us;
+    double maxUs;
+    bool inOrder;
+};
+
+/**
+ * Sends count messages from a producer thread to a consumer thread, with
+ * pauseNs between two sends (0 for back-to-back), and measures the throughput
+ * and the time each message spent in the channel.
+ */
+template <typename Channel>
+static BenchmarkResult runBenchmark(uint32_t count, int64_t pauseNs) {
+    Channel channel;
+    std::vector<int64_t> latenciesNs(count);
+    bool inOrder = true;
+
+    int64_t startNs = nowNs();
+    std::thread consumer([&] {
+        for (uint32_t i = 0; i < count; i++) {
+            Message message;
+            if (!channel.receive(message) || message.sequence != i) {
+                inOrder = false;
+                return;
+            }
+            latenciesNs[i] = nowNs() - message.sentNs;
+        }
+    });
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < count; i++) {
+            if (pauseNs > 0) {
+                int64_t resumeNs = nowNs() + pauseNs;
+                while (nowNs() < resumeNs) std::this_thread::yield();
+            }
+            Message message = { i, nowNs() };
+            if (!channel.send(message)) return;
+        }
+    });
+    producer.join();
+    consumer.join();
+    int64_t elapsedNs = nowNs() - startNs;
+
+    std::sort(latenciesNs.begin(), latenciesNs.end());
+    return { count * 1e9 / elapsedNs, latenciesNs[count * 99 / 100] / 1000.0, latenciesNs.back() / 1000.0, inOrder };
+}
+
+static void printResult(const char* name, const char* load, const BenchmarkResult& result) {
+    printf("%-14s %-10s %10.0f ops/s, p99 %8.1f us, max %8.1f us\n",
+           name, load, result.opsPerSecond, result.p99Us, result.maxUs);
+}
+
+// =============================================================================
+// TESTS
+// =============================================================================
+
+void setUp() {}
+void tearDown() {}
+
+void test_ring_keeps_fifo_order_across_the_wrap() {
+    SpscRing<int, 3> ring;
+    int value;
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_TRUE(ring.push(i));
+        TEST_ASSERT_EQUAL_UINT32(1, ring.size());
+        TEST_ASSERT_TRUE(ring.pop(value));
+        TEST_ASSERT_EQUAL_INT(i, value);
+    }
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+void test_full_ring_refuses_and_empty_ring_returns_nothing() {
+    SpscRing<int, 3> ring;
+    int value = 0;
+    TEST_ASSERT_FALSE(ring.pop(value));
+    for (int i = 0; i < 3; i++) TEST_ASSERT_TRUE(ring.push(i));
+    TEST_ASSERT_EQUAL_UINT32(0, ring.freeSpace());
+    value = 3;
+    TEST_ASSERT_FALSE(ring.push(value));
+    TEST_ASSERT_EQUAL_INT(3, value);  // A refused item stays with the caller.
+}
+
+void test_wait_times_out_on_an_empty_ring() {
+    SpscRing<int, 3> ring;
+    int value;
+    uint32_t start = millis();
+    TEST_ASSERT_FALSE(ring.pop(value, 20));
+    uint32_t elapsed = millis() - start;
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(19, elapsed);
+    TEST_ASSERT_LESS_THAN_UINT32(500, elapsed);
+}
+
+void test_blocked_consumer_is_woken_by_a_push() {
+    SpscRing<int, 3> ring;
+    int received = -1;
+    std::thread consumer([&] { ring.pop(received, 2000); });
+    delay(20);
+    int value = 42;
+    TEST_ASSERT_TRUE(ring.push(value));
+    consumer.join();
+    TEST_ASSERT_EQUAL_INT(42, received);
+}
+
+void test_ring_against_freertos_queue() {
+    const uint32_t count = 200000;
+    BenchmarkResult ringBurst = runBenchmark<RingChannel>(count, 0);
+    BenchmarkResult queueBurst = runBenchmark<FreeRTOSChannel>(count, 0);
+    BenchmarkResult ringPaced = runBenchmark<RingChannel>(count / 10, 20000);
+    BenchmarkResult queuePaced = runBenchmark<FreeRTOSChannel>(count / 10, 20000);
+
+    printf("%u hardware thread(s)\n", std::thread::hardware_concurrency());
+    printResult("SpscRing", "burst", ringBurst);
+    printResult("FreeRTOS queue", "burst", queueBurst);
+    printResult("SpscRing", "paced", ringPaced);
+    printResult("FreeRTOS queue", "paced", queuePaced);
+
+    TEST_ASSERT_TRUE(ringBurst.inOrder);
+    TEST_ASSERT_TRUE(queueBurst.inOrder);
+    TEST_ASSERT_TRUE(ringPaced.inOrder);
+    TEST_ASSERT_TRUE(queuePaced.inOrder);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_keeps_fifo_order_across_the_wrap);
+    RUN_TEST(test_full_ring_refuses_and_empty_ring_returns_nothing);
+    RUN_TEST(test_wait_times_out_on_an_empty_ring);
+    RUN_TEST(test_blocked_consumer_is_woken_by_a_push);
+    RUN_TEST(test_ring_against_freertos_queue);
+    return UNITY_END();
+}
@@ -0,0 +1,231 @@
+/*
+ * Time Control Tests for DGT3000 Gateway
+ *
+ * These host tests check the arithmetic of the time control engine (Fischer,
+ * Bronstein, US delay, multiple periods) and measure the latency from a lever
+ * move to the new clock setting.
+ *
+ * Copyright (C) 2025 Tortue - d*g*t*3*0*0*0*(at)*t*e*d*n*e*t*.*f*r (remove all "*" to contact me)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <unity.h>
+#include "TimeControlEngine.h"
+
+using Mode = TimeControlEngine::Mode;
+using Side = TimeControlEngine::Side;
+using Period = TimeControlEngine::Period;
+using ClockSetting = TimeControlEngine::ClockSetting;
+
+static TimeControlEngine engine;
+static ClockSetting setting;
+
+static void configure(Mode mode, const Period* periods, uint8_t count) {
+    const char* err = nullptr;
+    TEST_ASSERT_TRUE(engine.configure(mode, periods, count, setting, err));
+}
+
+// Presses the lever of `side` with the given clock times, at `now` milliseconds.
+static bool move(Side side, uint32_t left, uint32_t right, uint32_t now = 0) {
+    return engine.onMove(side, left, right, now, setting);
+}
+
+static void assertSetting(uint32_t left, uint32_t right, Side running) {
+    TEST_ASSERT_EQUAL_UINT32(left, setting.leftSeconds);
+    TEST_ASSERT_EQUAL_UINT32(right, setting.rightSeconds);
+    TEST_ASSERT_TRUE(setting.running == running);
+}
+
+// =============================================================================
+// TESTS
+// =============================================================================
+
+void setUp() {
+    engine.disable();
+}
+
+void tearDown() {}
+
+void test_configuration_is_validated() {
+    const char* err = nullptr;
+    Period noTime = { 0, 0, 0 };
+    Period openFirst[] = { { 0, 600, 0 }, { 0, 300, 0 } };
+    Period tooLong = { 0, TIME_CONTROL_MAX_SECONDS + 1, 0 };
+    Period tooMuchIncrement = { 0, 60, TIME_CONTROL_MAX_INCREMENT_SECONDS + 1 };
+
+    TEST_ASSERT_FALSE(engine.configure(Mode::FISCHER, &noTime, 1, setting, err));
+    TEST_ASSERT_FALSE(engine.configure(Mode::FISCHER, openFirst, 2, setting, err));
+    TEST_ASSERT_FALSE(engine.configure(Mode::FISCHER, &tooLong, 1, setting, err));
+    TEST_ASSERT_FALSE(engine.configure(Mode::FISCHER, &tooMuchIncrement, 1, setting, err));
+    TEST_ASSERT_FALSE(engine.configure(Mode::FISCHER, openFirst, 0, setting, err));
+    TEST_ASSERT_NOT_NULL(err);
+    TEST_ASSERT_FALSE(engine.isEnabled());
+
+    Period game = { 0, 300, 3 };
+    configure(Mode::FISCHER, &game, 1);
+    assertSetting(300, 300, Side::NONE);
+}
+
+void test_fischer_adds_the_increment_after_each_move() {
+    Period game = { 0, 300, 3 };
+    configure(Mode::FISCHER, &game, 1);
+
+    // Right starts the game: left is on move, no increment yet.
+    TEST_ASSERT_TRUE(move(Side::RIGHT, 300, 300));
+    assertSetting(300, 300, Side::LEFT);
+    TEST_ASSERT_TRUE(move(Side::LEFT, 290, 300));
+    assertSetting(293, 300, Side::RIGHT);
+    TEST_ASSERT_TRUE(move(Side::RIGHT, 293, 280));
+    assertSetting(293, 283, Side::LEFT);
+    TEST_ASSERT_EQUAL_UINT16(1, engine.getMoves(Side::LEFT));
+    TEST_ASSERT_EQUAL_UINT16(1, engine.getMoves(Side::RIGHT));
+}
+
+void test_lever_of_the_side_not_on_move_is_ignored() {
+    Period game = { 0, 300, 3 };
+    configure(Mode::FISCHER, &game, 1);
+    TEST_ASSERT_TRUE(move(Side::RIGHT, 300, 300));
+
+    TEST_ASSERT_FALSE(move(Side::RIGHT, 299, 300));
+    TEST_ASSERT_TRUE(engine.getRunning() == Side::LEFT);
+    TEST_ASSERT_EQUAL_UINT16(0, engine.getMoves(Side::RIGHT));
+}
+
+void test_bronstein_gives_back_the_time_used_up_to_the_increment() {
+    Period game = { 0, 300, 5 };
+    configure(Mode::BRONSTEIN, &game, 1);
+    TEST_ASSERT_TRUE(move(Side::RIGHT, 300, 300));
+
+    // 3 s used: all given back.
+    TEST_ASSERT_TRUE(move(Side::LEFT, 297, 300));
+    assertSetting(300, 300, Side::RIGHT);
+    // 20 s used: only the increment is given back.
+    TEST_ASSERT_TRUE(move(Side::RIGHT, 300, 280));
+    assertSetting(300, 285, Side::LEFT);
+}
+
+void test_us_delay_holds_the_clock_then_runs_it() {
+    Period game = { 0, 300, 5 };
+    configure(Mode::DELAY, &game, 1);
+
+    // The side on move only starts counting down after the delay.
+    TEST_ASSERT_TRUE(move(Side::RIGHT, 300, 300, 1000));
+    assertSetting(300, 300, Side::NONE);
+    TEST_ASSERT_TRUE(engine.isDelayPending());
+    TEST_ASSERT_FALSE(engine.update(5999, setting));
+    TEST_ASSERT_TRUE(engine.update(6000, setting));
+    assertSetting(300, 300, Side::LEFT);
+    TEST_ASSERT_FALSE(engine.update(7000, setting));
+
+    // A move within the delay costs nothing and adds nothing.
+    TEST_ASSERT_TRUE(move(Side::LEFT, 300, 300, 6500));
+    assertSetting(300, 300, Side::NONE);
+    TEST_ASSERT_TRUE(engine.update(11500, setting));
+    assertSetting(300, 300, Side::RIGHT);
+}
+
+void test_periods_add_their_time_after_their_moves() {
+    // 2 moves in 60 s, then 1 move in 30 s, then 10 s for the rest, with a 1 s increment.
+    Period periods[] = { { 2, 60, 1 }, { 1, 30, 1 }, { 0, 10, 1 } };
+    configure(Mode::FISCHER, periods, 3);
+    TEST_ASSERT_TRUE(move(Side::RIGHT, 60, 60));
+
+    TEST_ASSERT_TRUE(move(Side::LEFT, 50, 60));  // Left move 1.
+    assertSetting(51, 60, Side::RIGHT);
+    TEST_ASSERT_TRUE(move(Side::RIGHT, 51, 55)); // Right move 1.
+    TEST_ASSERT_TRUE(move(Side::LEFT, 40, 56));  // Left move 2 ends period 1.
+    assertSetting(40 + 1 + 30, 56, Side::RIGHT);
+    TEST_ASSERT_EQUAL_UINT8(1, engine.getPeriod(Side::LEFT));
+    TEST_ASSERT_EQUAL_UINT8(0, engine.getPeriod(Side::RIGHT));
+
+    TEST_ASSERT_TRUE(move(Side::RIGHT, 71, 50)); // Right move 2 ends period 1.
+    assertSetting(71, 50 + 1 + 30, Side::LEFT);
+    TEST_ASSERT_TRUE(move(Side::LEFT, 60, 81));  // Left move 3 ends period 2.
+    assertSetting(60 + 1 + 10, 81, Side::RIGHT);
+    TEST_ASSERT_EQUAL_UINT8(2, engine.getPeriod(Side::LEFT));
+
+    // The last period lasts until the end of the game.
+    TEST_ASSERT_TRUE(move(Side::RIGHT, 71, 80));
+    TEST_ASSERT_TRUE(move(Side::LEFT, 65, 81));
+    assertSetting(66, 81, Side::RIGHT);
+    TEST_ASSERT_EQUAL_UINT8(2, engine.getPeriod(Side::LEFT));
+}
+
+void test_times_are_clamped_to_the_clock_range() {
+    Period game = { 0, TIME_CONTROL_MAX_SECONDS, 30 };
+    configure(Mode::FISCHER, &game, 1);
+    TEST_ASSERT_TRUE(move(Side::RIGHT, TIME_CONTROL_MAX_SECONDS, TIME_CONTROL_MAX_SECONDS));
+    TEST_ASSERT_TRUE(move(Side::LEFT, TIME_CONTROL_MAX_SECONDS - 10, TIME_CONTROL_MAX_SECONDS));
+    assertSetting(TIME_CONTROL_MAX_SECONDS, TIME_CONTROL_MAX_SECONDS, Side::RIGHT);
+}
+
+void test_pause_waits_for_the_next_lever() {
+    Period game = { 0, 300, 3 };
+    configure(Mode::FISCHER, &game, 1);
+    TEST_ASSERT_TRUE(move(Side::RIGHT, 300, 300));
+    engine.pause();
+
+    // The next lever restarts the game without crediting a move.
+    TEST_ASSERT_TRUE(move(Side::LEFT, 280, 300));
+    assertSetting(280, 300, Side::RIGHT);
+    TEST_ASSERT_EQUAL_UINT16(0, engine.getMoves(Side::LEFT));
+}
+
+// The driver buffers the lever event until the next I2C task cycle, at most
+// I2C_TASK_UPDATE_INTERVAL_MS later; the task then runs onMove() and writes
+// the setting with one setAndRun transaction.
+static constexpr int64_t SET_AND_RUN_US = 2000;
+
+void test_lever_to_clock_latency() {
+    Period game = { 0, 3600, 2 };
+    configure(Mode::FISCHER, &game, 1);
+
+    // Cost of onMove(), measured on the host.
+    const int moves = 100000;
+    uint32_t left = 3600;
+    uint32_t right = 3600;
+    Side lever = Side::RIGHT;
+    int64_t startUs = esp_timer_get_time();
+    for (int i = 0; i < moves; i++) {
+        TEST_ASSERT_TRUE(move(lever, left, right));
+        left = setting.leftSeconds > 2 ? setting.leftSeconds - 2 : 0;
+        right = setting.rightSeconds > 2 ? setting.rightSeconds - 2 : 0;
+        lever = setting.running;
+    }
+    double computeUs = (double)(esp_timer_get_time() - startUs) / moves;
+
+    // A lever pressed at any phase of the task period.
+    const int64_t periodUs = I2C_TASK_UPDATE_INTERVAL_MS * 1000;
+    int64_t maxUs = 0;
+    int64_t sumUs = 0;
+    int samples = 0;
+    for (int64_t phaseUs = 0; phaseUs < periodUs; phaseUs += 100) {
+        int64_t latencyUs = (periodUs - phaseUs) + (int64_t)computeUs + SET_AND_RUN_US;
+        maxUs = std::max(maxUs, latencyUs);
+        sumUs += latencyUs;
+        samples++;
+    }
+    printf("Lever to clock: onMove %.3f us, latency mean %lld us, max %lld us (phone round trip: 30-150 ms)\n",
+           computeUs, (long long)(sumUs / samples), (long long)maxUs);
+
+    TEST_ASSERT_LESS_THAN_INT64(100, (int64_t)computeUs);
+    TEST_ASSERT_LESS_THAN_INT64(30000, maxUs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_configuration_is_validated);
+    RUN_TEST(test_fischer_adds_the_increment_after_each_move);
+    RUN_TEST(test_lever_of_the_side_not_on_move_is_ignored);
+    RUN_TEST(test_bronstein_gives_back_the_time_used_up_to_the_increment);
+    RUN_TEST(test_us_delay_holds_the_clock_then_runs_it);
+    RUN_TEST(test_periods_add_their_time_after_their_moves);
+    RUN_TEST(test_times_are_clamped_to_the_clock_range);
+    RUN_TEST(test_pause_waits_for_the_next_lever);
+    RUN_TEST(test_lever_to_clock_latency);
+    return UNITY_END();
+}
@@ -59,6 +59,7 @@ class DGT3000BLEClient:
             'events_received': 0,
             'connection_time': None
         }
+        self._rx_buffer = bytearray()  # Notifications form a newline-delimited JSON stream
     
     async def scan_devices(self, timeout: float = 15.0) -> list:
         """Scan for DGT3000 Gateway devices."""
@@ -100,14 +101,15 @@ class DGT3000BLEClient:
             console.print("[blue]Check protocol version...[/blue]")
             try:
                 protocol_version = await self.get_protocol_version()
-                if protocol_version == "1.1":
-                    console.print(f"[green]✅ Protocol version (v{protocol_version}) is 1.1. Client is compatible.[/green]")
+                if protocol_version == "1.2":
+                    console.print(f"[green]✅ Protocol version (v{protocol_version}) is 1.2. Client is compatible.[/green]")
                 else:
-                    console.print(f"[red]❌ Protocol version (v{protocol_version}) is not 1.1. Client might be incompatible.[/red]")
+                    console.print(f"[red]❌ Protocol version (v{protocol_version}) is not 1.2. Client might be incompatible.[/red]")
             except Exception as e:
                 console.print(f"[red]Error verifying protocol version: {e}[/red]")
 
             # Subscribe to event notifications
+            self._rx_buffer.clear()
             await self.client.start_notify(EVENT_CHAR_UUID, self._event_notification_handler)
             
             console.print(f"[green]✅ Connected to DGT3000 Gateway at {address}. Ready for commands.[/green]")
@@ -133,7 +135,16 @@ class DGT3000BLEClient:
         self.device_address = None
     
     def _event_notification_handler(self, sender, data: bytearray):
-        """Handle incoming event notifications."""
+        """Reassemble the JSON messages packed into (or split over) notifications."""
+        self._rx_buffer.extend(data)
+        while b'\n' in self._rx_buffer:
+            line, _, rest = self._rx_buffer.partition(b'\n')
+            self._rx_buffer = bytearray(rest)
+            if line:
+                self._handle_message(bytes(line))
+
+    def _handle_message(self, data: bytes):
+        """Handle one incoming event or response."""
         try:
             event_json = data.decode('utf-8')
             console.print(f"[blue]📥 Received event JSON:[/blue]\n[yellow]{event_json}[/yellow]")